@@ -0,0 +1,270 @@
+/*
+  ==============================================================================
+
+    AnalyzerProcessor.cpp
+    Middle
+
+  ==============================================================================
+*/
+
+#include "../JuceLibraryCode/JuceHeader.h"
+#include "AnalyzerProcessor.h"
+
+
+//==============================================================================
+const float AnalyzerProcessor::minFrequency = 20.0f;
+const float AnalyzerProcessor::floorDb = -100.0f;
+
+static const float decayDbPerSecond = 40.0f;
+static const int fifoSize = AnalyzerProcessor::fftSize * 4;
+
+//==============================================================================
+class AnalyzerEditor   : public AudioProcessorEditor,
+                         private Timer
+{
+public:
+    AnalyzerEditor (AnalyzerProcessor& p)
+        : AudioProcessorEditor (p),
+          analyzer (p),
+          lastVersion (0)
+    {
+        for (int i = 0; i < AnalyzerProcessor::numDisplayBins; ++i)
+            levels[i] = AnalyzerProcessor::floorDb;
+
+        setOpaque (true);
+        setSize (520, 260);
+        startTimerHz (30);
+    }
+
+    void paint (Graphics& g) override
+    {
+        g.fillAll (Colours::black);
+
+        const Rectangle<float> area (getLocalBounds().toFloat().reduced (4.0f));
+        const float nyquist = (float) analyzer.getAnalysisSampleRate() * 0.5f;
+
+        g.setColour (Colours::white.withAlpha (0.15f));
+
+        for (float f = 100.0f; f < nyquist; f *= 10.0f)
+        {
+            const float x = area.getX() + area.getWidth() * std::log (f / AnalyzerProcessor::minFrequency)
+                                                          / std::log (nyquist / AnalyzerProcessor::minFrequency);
+            g.drawVerticalLine (roundToInt (x), area.getY(), area.getBottom());
+        }
+
+        for (float db = -20.0f; db > AnalyzerProcessor::floorDb; db -= 20.0f)
+            g.drawHorizontalLine (roundToInt (dbToY (db, area)), area.getX(), area.getRight());
+
+        Path spectrum;
+        const float binWidth = area.getWidth() / (AnalyzerProcessor::numDisplayBins - 1);
+
+        spectrum.startNewSubPath (area.getX(), dbToY (levels[0], area));
+
+        for (int i = 1; i < AnalyzerProcessor::numDisplayBins; ++i)
+            spectrum.lineTo (area.getX() + i * binWidth, dbToY (levels[i], area));
+
+        g.setColour (Colours::lightskyblue);
+        g.strokePath (spectrum, PathStrokeType (1.5f));
+    }
+
+private:
+    AnalyzerProcessor& analyzer;
+    float levels[AnalyzerProcessor::numDisplayBins];
+    uint32 lastVersion;
+
+    static float dbToY (float db, const Rectangle<float>& area) noexcept
+    {
+        return jmap (jlimit (AnalyzerProcessor::floorDb, 0.0f, db), AnalyzerProcessor::floorDb, 0.0f,
+                     area.getBottom(), area.getY());
+    }
+
+    void timerCallback() override
+    {
+        const uint32 version = analyzer.getSpectrumVersion();
+
+        if (version != lastVersion)
+        {
+            lastVersion = version;
+
+            for (int i = 0; i < AnalyzerProcessor::numDisplayBins; ++i)
+                levels[i] = analyzer.getDisplayBinLevel (i);
+
+            repaint();
+        }
+    }
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (AnalyzerEditor)
+};
+
+//==============================================================================
+const char* const AnalyzerProcessor::analyzerName = "Analyzer";
+
+AnalyzerProcessor::AnalyzerProcessor()
+    : InternalPlugin (analyzerName, BusesProperties().withInput  ("Input",  AudioChannelSet::stereo())
+                                                     .withOutput ("Output", AudioChannelSet::stereo())),
+      Thread ("Analyzer FFT"),
+      fifo (fifoSize),
+      fifoData ((size_t) fifoSize, true),
+      currentSampleRate (44100.0),
+      fft (fftOrder, false),
+      window ((size_t) fftSize),
+      frame ((size_t) fftSize, true),
+      fftData ((size_t) fftSize * 2, true),
+      smoothedBins ((size_t) numDisplayBins),
+      spectrumVersion (0)
+{
+    for (int i = 0; i < fftSize; ++i)
+        window[i] = 0.5f - 0.5f * std::cos (2.0f * float_Pi * i / (float) fftSize);
+
+    for (int i = 0; i < numDisplayBins; ++i)
+    {
+        smoothedBins[i] = floorDb;
+        displayBins[i] = floorDb;
+    }
+
+    for (int i = 0; i <= numDisplayBins; ++i)
+        binRangeStarts[i] = 1;
+}
+
+AnalyzerProcessor::~AnalyzerProcessor()
+{
+    stopThread (2000);
+}
+
+bool AnalyzerProcessor::isBusesLayoutSupported (const BusesLayout& layouts) const
+{
+    const AudioChannelSet& in = layouts.getMainInputChannelSet();
+
+    return layouts.inputBuses.size() == 1 && layouts.outputBuses.size() == 1
+            && ! in.isDisabled() && in == layouts.getMainOutputChannelSet();
+}
+
+AudioProcessorEditor* AnalyzerProcessor::createEditor()
+{
+    return new AnalyzerEditor (*this);
+}
+
+//==============================================================================
+void AnalyzerProcessor::prepareToPlay (double sampleRate, int)
+{
+    stopThread (2000);
+
+    currentSampleRate = sampleRate;
+
+    // Display bins are spaced logarithmically; each one takes the loudest FFT bin in its range.
+    const double nyquist = sampleRate * 0.5;
+
+    for (int i = 0; i <= numDisplayBins; ++i)
+    {
+        const double frequency = minFrequency * std::pow (nyquist / minFrequency, i / (double) numDisplayBins);
+        binRangeStarts[i] = jlimit (1, fftSize / 2, (int) (frequency * fftSize / sampleRate));
+    }
+
+    fifo.reset();
+    FloatVectorOperations::clear (frame, fftSize);
+
+    startThread (3);
+}
+
+void AnalyzerProcessor::releaseResources()
+{
+    stopThread (2000);
+}
+
+void AnalyzerProcessor::renderBlock (AudioBuffer<float>& buffer, MidiBuffer&)
+{
+    // The audio passes through untouched; a mono sum of it goes to the analysis thread.
+    const int numChannels = jmin (getTotalNumInputChannels(), buffer.getNumChannels());
+    const int numSamples = buffer.getNumSamples();
+
+    if (numChannels == 0)
+        return;
+
+    const float gain = 1.0f / numChannels;
+
+    int start1, size1, start2, size2;
+    fifo.prepareToWrite (numSamples, start1, size1, start2, size2);
+
+    const int starts[] = { start1, start2 };
+    const int sizes[]  = { size1,  size2 };
+    int offset = 0;
+
+    for (int part = 0; part < 2; ++part)
+    {
+        if (sizes[part] > 0)
+        {
+            float* const dest = fifoData + starts[part];
+
+            FloatVectorOperations::copyWithMultiply (dest, buffer.getReadPointer (0, offset), gain, sizes[part]);
+
+            for (int ch = 1; ch < numChannels; ++ch)
+                FloatVectorOperations::addWithMultiply (dest, buffer.getReadPointer (ch, offset), gain, sizes[part]);
+
+            offset += sizes[part];
+        }
+    }
+
+    fifo.finishedWrite (size1 + size2);
+}
+
+//==============================================================================
+void AnalyzerProcessor::run()
+{
+    while (! threadShouldExit())
+    {
+        // If we've fallen a long way behind, skip ahead rather than showing stale frames.
+        if (fifo.getNumReady() > fftSize)
+            fifo.finishedRead (fifo.getNumReady() - fftSize);
+
+        if (fifo.getNumReady() < hopSize)
+        {
+            wait (5);
+            continue;
+        }
+
+        memmove (frame, frame + hopSize, sizeof (float) * (size_t) (fftSize - hopSize));
+
+        int start1, size1, start2, size2;
+        fifo.prepareToRead (hopSize, start1, size1, start2, size2);
+
+        float* const dest = frame + (fftSize - hopSize);
+        FloatVectorOperations::copy (dest, fifoData + start1, size1);
+
+        if (size2 > 0)
+            FloatVectorOperations::copy (dest + size1, fifoData + start2, size2);
+
+        fifo.finishedRead (size1 + size2);
+
+        analyseFrame();
+    }
+}
+
+void AnalyzerProcessor::analyseFrame()
+{
+    FloatVectorOperations::multiply (fftData, frame, window, fftSize);
+    FloatVectorOperations::clear (fftData + fftSize, fftSize);
+
+    fft.performFrequencyOnlyForwardTransform (fftData);
+
+    // Scaled so that a full-scale sine reads 0 dB through the Hann window.
+    const float scale = 4.0f / fftSize;
+    const float decay = decayDbPerSecond * hopSize / (float) currentSampleRate;
+
+    for (int i = 0; i < numDisplayBins; ++i)
+    {
+        const int start = binRangeStarts[i];
+        const int end = jmax (start + 1, binRangeStarts[i + 1]);
+
+        float magnitude = 0.0f;
+
+        for (int k = start; k < end; ++k)
+            magnitude = jmax (magnitude, fftData[k]);
+
+        const float db = Decibels::gainToDecibels (magnitude * scale, floorDb);
+
+        smoothedBins[i] = jmax (db, smoothedBins[i] - decay);
+        displayBins[i] = smoothedBins[i];
+    }
+
+    ++spectrumVersion;
+}
@@ -0,0 +1,89 @@
+/*
+  ==============================================================================
+
+    AnalyzerProcessor.h
+    Middle
+
+  ==============================================================================
+*/
+
+#ifndef __ANALYZERPROCESSOR_JUCEHEADER__
+#define __ANALYZERPROCESSOR_JUCEHEADER__
+
+#include <atomic>
+#include "InternalProcessors.h"
+
+
+//==============================================================================
+/**
+    A pass-through spectrum analyser.
+
+    The audio thread only sums its input to mono and pushes it into an
+    AbstractFifo. A dedicated analysis thread pulls overlapping Hann-windowed
+    frames from there, runs the FFT, and reduces the result to a small set of
+    log-spaced display bins, which it publishes as atomics along with a
+    version counter. The editor just polls that counter at display rate and
+    draws whatever is there, so the message thread never does any FFT work.
+*/
+class AnalyzerProcessor   : public InternalPlugin,
+                            private Thread
+{
+public:
+    AnalyzerProcessor();
+
+    static const char* const analyzerName;
+    ~AnalyzerProcessor();
+
+    enum
+    {
+        fftOrder = 12,
+        fftSize = 1 << fftOrder,
+        hopSize = fftSize / 4,
+        numDisplayBins = 256
+    };
+
+    void prepareToPlay (double sampleRate, int maximumExpectedSamplesPerBlock) override;
+    void releaseResources() override;
+    void renderBlock (AudioBuffer<float>&, MidiBuffer&) override;
+
+    bool isBusesLayoutSupported (const BusesLayout&) const override;
+
+    AudioProcessorEditor* createEditor() override;
+
+    //==============================================================================
+    /** Bumped each time a new spectrum has been published. */
+    uint32 getSpectrumVersion() const noexcept                           { return spectrumVersion.load(); }
+
+    /** Level of a display bin in dB. The bins are spaced logarithmically from
+        minFrequency up to Nyquist.
+    */
+    float getDisplayBinLevel (int bin) const noexcept                    { return displayBins[bin].load(); }
+
+    /** The rate the bins were last worked out at. Not named getSampleRate(), which
+        would hide AudioProcessor's own.
+    */
+    double getAnalysisSampleRate() const noexcept                        { return currentSampleRate; }
+
+    static const float minFrequency, floorDb;
+
+private:
+    //==============================================================================
+    AbstractFifo fifo;
+    HeapBlock<float> fifoData;
+    double currentSampleRate;
+
+    FFT fft;
+    HeapBlock<float> window, frame, fftData, smoothedBins;
+    int binRangeStarts[numDisplayBins + 1];
+
+    std::atomic<float> displayBins[numDisplayBins];
+    std::atomic<uint32> spectrumVersion;
+
+    void run() override;
+    void analyseFrame();
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (AnalyzerProcessor)
+};
+
+
+#endif   // __ANALYZERPROCESSOR_JUCEHEADER__
@@ -0,0 +1,676 @@
+/*
+  ==============================================================================
+
+    ConvolutionProcessor.cpp
+    Middle
+
+  ==============================================================================
+*/
+
+#include <atomic>
+#include "../JuceLibraryCode/JuceHeader.h"
+#include "ConvolutionProcessor.h"
+
+
+//==============================================================================
+static const double maxImpulseSeconds = 20.0;
+static const double mixRampSeconds = 0.05;
+
+static int getOrderForSize (const int size) noexcept
+{
+    int order = 0;
+
+    while ((1 << order) < size)
+        ++order;
+
+    return order;
+}
+
+/** acc += a * b, for interleaved complex bins. */
+static void multiplyAccumulate (float* acc, const float* a, const float* b, const int numBins) noexcept
+{
+    for (int k = 0; k < numBins * 2; k += 2)
+    {
+        acc[k]     += a[k] * b[k]     - a[k + 1] * b[k + 1];
+        acc[k + 1] += a[k] * b[k + 1] + a[k + 1] * b[k];
+    }
+}
+
+//==============================================================================
+/**
+    Uniformly-partitioned overlap-save convolution of one channel with one
+    impulse response, in blocks of exactly partitionSize samples.
+*/
+class PartitionedConvolver
+{
+public:
+    PartitionedConvolver (const int partitionSize, const float* ir, const int irLength)
+        : blockSize (partitionSize),
+          fftSize (partitionSize * 2),
+          numBins (partitionSize + 1),
+          numPartitions (jmax (1, (irLength + partitionSize - 1) / partitionSize)),
+          forwardFFT (getOrderForSize (fftSize), false),
+          inverseFFT (getOrderForSize (fftSize), true),
+          irSpectra ((size_t) (numPartitions * numBins * 2), true),
+          delayLine ((size_t) (numPartitions * numBins * 2), true),
+          overlap ((size_t) fftSize, true),
+          fftBuffer ((size_t) fftSize * 2, true),
+          accumulator ((size_t) numBins * 2, true),
+          delayLineIndex (0),
+          inverseScale (1.0f)
+    {
+        // Measure how the inverse transform is scaled, so the output comes back at unity gain.
+        fftBuffer[0] = 1.0f;
+        forwardFFT.performRealOnlyForwardTransform (fftBuffer);
+        inverseFFT.performRealOnlyInverseTransform (fftBuffer);
+        inverseScale = 1.0f / fftBuffer[0];
+
+        for (int p = 0; p < numPartitions; ++p)
+        {
+            FloatVectorOperations::clear (fftBuffer, fftSize * 2);
+
+            const int start = p * blockSize;
+            const int num = jmin (blockSize, irLength - start);
+
+            if (num > 0)
+                FloatVectorOperations::copy (fftBuffer, ir + start, num);
+
+            forwardFFT.performRealOnlyForwardTransform (fftBuffer);
+            FloatVectorOperations::copy (irSpectra + p * numBins * 2, fftBuffer, numBins * 2);
+        }
+    }
+
+    /** Reads blockSize samples of input and writes blockSize samples of output. */
+    void process (const float* input, float* output) noexcept
+    {
+        const int stride = numBins * 2;
+
+        FloatVectorOperations::copy (overlap, overlap + blockSize, blockSize);
+        FloatVectorOperations::copy (overlap + blockSize, input, blockSize);
+
+        FloatVectorOperations::copy (fftBuffer, overlap, fftSize);
+        forwardFFT.performRealOnlyForwardTransform (fftBuffer);
+        FloatVectorOperations::copy (delayLine + delayLineIndex * stride, fftBuffer, stride);
+
+        FloatVectorOperations::clear (accumulator, stride);
+
+        for (int p = 0; p < numPartitions; ++p)
+        {
+            const int slot = (delayLineIndex - p + numPartitions) % numPartitions;
+            multiplyAccumulate (accumulator, delayLine + slot * stride, irSpectra + p * stride, numBins);
+        }
+
+        delayLineIndex = (delayLineIndex + 1) % numPartitions;
+
+        // Only the non-negative bins were accumulated; the rest are their conjugates.
+        FloatVectorOperations::copy (fftBuffer, accumulator, stride);
+
+        for (int k = 1; k < blockSize; ++k)
+        {
+            fftBuffer[2 * (fftSize - k)]     =  accumulator[2 * k];
+            fftBuffer[2 * (fftSize - k) + 1] = -accumulator[2 * k + 1];
+        }
+
+        inverseFFT.performRealOnlyInverseTransform (fftBuffer);
+        FloatVectorOperations::multiply (output, fftBuffer + blockSize, inverseScale, blockSize);
+    }
+
+private:
+    const int blockSize, fftSize, numBins, numPartitions;
+    FFT forwardFFT, inverseFFT;
+    HeapBlock<float> irSpectra, delayLine, overlap, fftBuffer, accumulator;
+    int delayLineIndex;
+    float inverseScale;
+
+    JUCE_DECLARE_NON_COPYABLE (PartitionedConvolver)
+};
+
+//==============================================================================
+/**
+    Runs a short-partition head convolver on the audio thread and a
+    long-partition tail convolver on a worker, for every channel.
+
+    Head blocks are headBlockSize samples, so the output is that much late.
+    The tail starts headLength samples into the impulse response and works in
+    tailBlockSize blocks. Each tail block handed to the worker is not needed
+    until tailBlockSize samples after it was queued, so the worker has that
+    long to finish it. Blocks pass between the two threads through a small
+    ring of slots, guarded only by a pair of atomic counters.
+*/
+class ConvolutionEngine
+{
+public:
+    enum
+    {
+        headBlockSize = 256,
+        tailBlockSize = 4096,
+        headLength = tailBlockSize * 2,
+        numTailSlots = 4,
+        headBlocksPerTailBlock = tailBlockSize / headBlockSize
+    };
+
+    ConvolutionEngine (const AudioBuffer<float>& ir, const int numChannels)
+        : inBlock (numChannels, headBlockSize),
+          outBlock (numChannels, headBlockSize),
+          dryBlock (numChannels, headBlockSize),
+          blockPos (0),
+          headBlocksDone (0),
+          tailBlocksQueued (0),
+          tailBlocksDone (0),
+          firstValidTailBlock (0),
+          missedTailBlocks (0)
+    {
+        const int length = ir.getNumSamples();
+
+        for (int ch = 0; ch < numChannels; ++ch)
+        {
+            const float* const channelIr = ir.getReadPointer (jmin (ch, ir.getNumChannels() - 1));
+
+            heads.add (new PartitionedConvolver (headBlockSize, channelIr, jmin (length, (int) headLength)));
+
+            if (length > headLength)
+                tails.add (new PartitionedConvolver (tailBlockSize, channelIr + headLength, length - headLength));
+        }
+
+        if (hasTail())
+        {
+            tailInput.setSize (numChannels, tailBlockSize * numTailSlots);
+            tailOutput.setSize (numChannels, tailBlockSize * numTailSlots);
+            tailInput.clear();
+            tailOutput.clear();
+        }
+
+        inBlock.clear();
+        outBlock.clear();
+        dryBlock.clear();
+    }
+
+    bool hasTail() const noexcept               { return tails.size() > 0; }
+    int getNumMissedTailBlocks() const noexcept { return missedTailBlocks.load(); }
+
+    /** Called on the audio thread. The wet and dry arrays hold per-sample gains. */
+    void process (AudioBuffer<float>& buffer, const int startSample, const int numSamples,
+                  const float* wet, const float* dry) noexcept
+    {
+        const int numChannels = jmin (buffer.getNumChannels(), inBlock.getNumChannels());
+
+        for (int pos = 0; pos < numSamples;)
+        {
+            const int num = jmin (numSamples - pos, (int) headBlockSize - blockPos);
+
+            for (int ch = 0; ch < numChannels; ++ch)
+            {
+                float* const data = buffer.getWritePointer (ch, startSample + pos);
+
+                FloatVectorOperations::copy (inBlock.getWritePointer (ch, blockPos), data, num);
+                FloatVectorOperations::multiply (data, outBlock.getReadPointer (ch, blockPos), wet + pos, num);
+                FloatVectorOperations::addWithMultiply (data, dryBlock.getReadPointer (ch, blockPos), dry + pos, num);
+            }
+
+            blockPos += num;
+            pos += num;
+
+            if (blockPos == headBlockSize)
+            {
+                processHeadBlock (numChannels);
+                blockPos = 0;
+            }
+        }
+    }
+
+    /** Called on the worker thread. Returns false if there was nothing to do. */
+    bool processPendingTailBlocks() noexcept
+    {
+        const int64 queued = tailBlocksQueued.load();
+        int64 done = tailBlocksDone.load();
+
+        if (done >= queued)
+            return false;
+
+        // If we've been lapped, the older slots have already been overwritten. Those
+        // blocks are skipped, and their slots' stale output must not be used.
+        if (queued - done >= numTailSlots)
+        {
+            done = queued - 1;
+            firstValidTailBlock = done;
+        }
+
+        for (; done < queued; ++done)
+        {
+            const int offset = (int) (done % numTailSlots) * tailBlockSize;
+
+            for (int ch = 0; ch < tails.size(); ++ch)
+                tails.getUnchecked (ch)->process (tailInput.getReadPointer (ch, offset),
+                                                  tailOutput.getWritePointer (ch, offset));
+
+            tailBlocksDone = done + 1;
+        }
+
+        return true;
+    }
+
+private:
+    OwnedArray<PartitionedConvolver> heads, tails;
+    AudioBuffer<float> inBlock, outBlock, dryBlock, tailInput, tailOutput;
+    int blockPos;
+    int64 headBlocksDone;
+    std::atomic<int64> tailBlocksQueued, tailBlocksDone, firstValidTailBlock;
+    std::atomic<int> missedTailBlocks;
+
+    void processHeadBlock (const int numChannels) noexcept
+    {
+        const int64 tailBlock = headBlocksDone / headBlocksPerTailBlock;
+        const int posInTailBlock = (int) (headBlocksDone % headBlocksPerTailBlock) * headBlockSize;
+
+        if (hasTail())
+        {
+            const int offset = (int) (tailBlock % numTailSlots) * tailBlockSize + posInTailBlock;
+
+            for (int ch = 0; ch < numChannels; ++ch)
+                tailInput.copyFrom (ch, offset, inBlock, ch, 0, headBlockSize);
+
+            if (posInTailBlock + headBlockSize == tailBlockSize)
+                tailBlocksQueued = tailBlock + 1;
+        }
+
+        for (int ch = 0; ch < numChannels; ++ch)
+        {
+            heads.getUnchecked (ch)->process (inBlock.getReadPointer (ch), outBlock.getWritePointer (ch));
+            dryBlock.copyFrom (ch, 0, inBlock, ch, 0, headBlockSize);
+        }
+
+        // The tail block whose output lines up with this head block was queued two tail blocks ago.
+        const int64 neededTailBlock = tailBlock - 2;
+
+        if (hasTail() && neededTailBlock >= 0)
+        {
+            // firstValidTailBlock is set before tailBlocksDone moves past it, so it's read second.
+            if (tailBlocksDone.load() > neededTailBlock && neededTailBlock >= firstValidTailBlock.load())
+            {
+                const int offset = (int) (neededTailBlock % numTailSlots) * tailBlockSize + posInTailBlock;
+
+                for (int ch = 0; ch < numChannels; ++ch)
+                    outBlock.addFrom (ch, 0, tailOutput, ch, offset, headBlockSize);
+            }
+            else if (posInTailBlock == 0)
+            {
+                ++missedTailBlocks;
+            }
+        }
+
+        ++headBlocksDone;
+    }
+
+    JUCE_DECLARE_NON_COPYABLE (ConvolutionEngine)
+};
+
+//==============================================================================
+static AudioBuffer<float> resampleImpulse (const AudioBuffer<float>& source, const double sourceRate, const double targetRate)
+{
+    if (source.getNumSamples() == 0)
+    {
+        AudioBuffer<float> silence (1, 1);
+        silence.clear();
+        return silence;
+    }
+
+    if (sourceRate == targetRate)
+        return source;
+
+    const double ratio = sourceRate / targetRate;
+    const int numChannels = source.getNumChannels();
+    const int numOut = jmax (1, (int) (source.getNumSamples() / ratio));
+
+    // A little zero padding so the interpolator can't read off the end.
+    AudioBuffer<float> padded (numChannels, source.getNumSamples() + 8);
+    padded.clear();
+
+    AudioBuffer<float> result (numChannels, numOut);
+
+    for (int ch = 0; ch < numChannels; ++ch)
+    {
+        padded.copyFrom (ch, 0, source, ch, 0, source.getNumSamples());
+
+        LagrangeInterpolator interpolator;
+        interpolator.process (ratio, padded.getReadPointer (ch), result.getWritePointer (ch), numOut);
+    }
+
+    return result;
+}
+
+/** Scales an impulse response to unit energy, so swapping IRs doesn't make big jumps in level. */
+static void normaliseImpulse (AudioBuffer<float>& ir)
+{
+    double maxEnergy = 0.0;
+
+    for (int ch = 0; ch < ir.getNumChannels(); ++ch)
+    {
+        const float* const data = ir.getReadPointer (ch);
+        double energy = 0.0;
+
+        for (int i = 0; i < ir.getNumSamples(); ++i)
+            energy += data[i] * data[i];
+
+        maxEnergy = jmax (maxEnergy, energy);
+    }
+
+    if (maxEnergy > 0.0)
+        ir.applyGain ((float) (1.0 / std::sqrt (maxEnergy)));
+}
+
+//==============================================================================
+class ConvolutionEditor   : public AudioProcessorEditor,
+                            private Button::Listener,
+                            private Slider::Listener,
+                            private Timer
+{
+public:
+    ConvolutionEditor (ConvolutionProcessor& p)
+        : AudioProcessorEditor (p),
+          convolution (p),
+          loadButton ("Load IR...")
+    {
+        addAndMakeVisible (loadButton);
+        addAndMakeVisible (infoLabel);
+        addAndMakeVisible (mixLabel);
+        addAndMakeVisible (mixSlider);
+
+        loadButton.addListener (this);
+
+        mixLabel.setText ("Mix", dontSendNotification);
+        mixSlider.setRange (0.0, 1.0);
+        mixSlider.setValue (convolution.getMixParameter()->get(), dontSendNotification);
+        mixSlider.addListener (this);
+
+        setSize (380, 84);
+        timerCallback();
+        startTimerHz (4);
+    }
+
+    void paint (Graphics& g) override
+    {
+        g.fillAll (getLookAndFeel().findColour (ResizableWindow::backgroundColourId));
+    }
+
+    void resized() override
+    {
+        Rectangle<int> r (getLocalBounds().reduced (8));
+
+        Rectangle<int> top (r.removeFromTop (24));
+        loadButton.setBounds (top.removeFromLeft (80));
+        top.removeFromLeft (8);
+        infoLabel.setBounds (top);
+
+        r.removeFromTop (12);
+        mixLabel.setBounds (r.removeFromLeft (40));
+        mixSlider.setBounds (r);
+    }
+
+private:
+    ConvolutionProcessor& convolution;
+    TextButton loadButton;
+    Label infoLabel, mixLabel;
+    Slider mixSlider;
+
+    void buttonClicked (Button*) override
+    {
+        FileChooser chooser ("Load an impulse response...",
+                             convolution.getImpulseResponseFile().existsAsFile() ? convolution.getImpulseResponseFile()
+                                                                                 : File::getSpecialLocation (File::userDocumentsDirectory),
+                             "*.wav;*.ogg;*.aif;*.aiff");
+
+        if (chooser.browseForFileToOpen())
+            if (! convolution.loadImpulseResponse (chooser.getResult()))
+                AlertWindow::showMessageBoxAsync (AlertWindow::WarningIcon, "Convolution",
+                                                  "Couldn't load " + chooser.getResult().getFileName());
+
+        timerCallback();
+    }
+
+    void sliderValueChanged (Slider*) override
+    {
+        convolution.getMixParameter()->setValueNotifyingHost ((float) mixSlider.getValue());
+    }
+
+    void timerCallback() override
+    {
+        String info (convolution.getImpulseResponseFile().getFileName());
+
+        if (info.isNotEmpty())
+            info << "  (" << String (convolution.getImpulseResponseSeconds(), 2) << "s)";
+
+        if (convolution.getNumMissedTailBlocks() > 0)
+            info << "  " << String (convolution.getNumMissedTailBlocks()) << " late tail blocks";
+
+        infoLabel.setText (info, dontSendNotification);
+
+        if (! mixSlider.isMouseButtonDown())
+            mixSlider.setValue (convolution.getMixParameter()->get(), dontSendNotification);
+    }
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (ConvolutionEditor)
+};
+
+//==============================================================================
+const char* const ConvolutionProcessor::convolutionName = "Convolution";
+
+ConvolutionProcessor::ConvolutionProcessor()
+    : InternalPlugin (convolutionName, BusesProperties().withInput  ("Input",  AudioChannelSet::stereo())
+                                                        .withOutput ("Output", AudioChannelSet::stereo())),
+      Thread ("Convolution Tail"),
+      irSampleRate (44100.0),
+      currentSampleRate (44100.0),
+      isPrepared (false)
+{
+    formatManager.registerBasicFormats();
+
+    addParameter (mix = new AudioParameterFloat ("mix", "Mix", NormalisableRange<float> (0.0f, 1.0f), 1.0f));
+
+    setLatencySamples (ConvolutionEngine::headBlockSize);
+}
+
+ConvolutionProcessor::~ConvolutionProcessor()
+{
+    stopThread (2000);
+}
+
+bool ConvolutionProcessor::isBusesLayoutSupported (const BusesLayout& layouts) const
+{
+    const AudioChannelSet& in = layouts.getMainInputChannelSet();
+
+    return layouts.inputBuses.size() == 1 && layouts.outputBuses.size() == 1
+            && (in == AudioChannelSet::mono() || in == AudioChannelSet::stereo())
+            && in == layouts.getMainOutputChannelSet();
+}
+
+double ConvolutionProcessor::getTailLengthSeconds() const
+{
+    return getImpulseResponseSeconds();
+}
+
+AudioProcessorEditor* ConvolutionProcessor::createEditor()
+{
+    return new ConvolutionEditor (*this);
+}
+
+//==============================================================================
+bool ConvolutionProcessor::loadImpulseResponse (const File& file)
+{
+    ScopedPointer<AudioFormatReader> reader (formatManager.createReaderFor (file));
+
+    if (reader == nullptr || reader->lengthInSamples <= 0)
+        return false;
+
+    const int length = (int) jmin (reader->lengthInSamples, (int64) (reader->sampleRate * maxImpulseSeconds));
+
+    AudioBuffer<float> ir ((int) jmin (2u, reader->numChannels), length);
+    reader->read (&ir, 0, length, 0, true, true);
+
+    originalIr = ir;
+    irSampleRate = reader->sampleRate;
+    irFile = file;
+
+    rebuildEngine();
+    return true;
+}
+
+double ConvolutionProcessor::getImpulseResponseSeconds() const noexcept
+{
+    return originalIr.getNumSamples() / irSampleRate;
+}
+
+int ConvolutionProcessor::getNumMissedTailBlocks() const noexcept
+{
+    return engine != nullptr ? engine->getNumMissedTailBlocks() : 0;
+}
+
+void ConvolutionProcessor::rebuildEngine()
+{
+    if (! isPrepared)
+        return;
+
+    // All the expensive work happens here, before the audio thread sees anything.
+    AudioBuffer<float> ir (resampleImpulse (originalIr, irSampleRate, currentSampleRate));
+    normaliseImpulse (ir);
+
+    ScopedPointer<ConvolutionEngine> newEngine (new ConvolutionEngine (ir, jmax (1, getTotalNumInputChannels())));
+
+    stopThread (2000);
+
+    suspendProcessing (true);
+    engine.swapWith (newEngine);
+    suspendProcessing (false);
+
+    if (engine->hasTail())
+        startThread (8);
+}
+
+//==============================================================================
+void ConvolutionProcessor::prepareToPlay (double sampleRate, int maximumExpectedSamplesPerBlock)
+{
+    currentSampleRate = sampleRate;
+    isPrepared = true;
+
+    wetGain.prepare (sampleRate, mixRampSeconds);
+    dryGain.prepare (sampleRate, mixRampSeconds);
+    wetGain.setImmediately (mix->get());
+    dryGain.setImmediately (1.0f - mix->get());
+
+    ensureRampBuffer (maximumExpectedSamplesPerBlock);
+    dryRamp.allocate ((size_t) rampBufferSize, false);
+
+    rebuildEngine();
+}
+
+void ConvolutionProcessor::releaseResources()
+{
+    stopThread (2000);
+
+    isPrepared = false;
+    engine = nullptr;
+}
+
+void ConvolutionProcessor::renderBlock (AudioBuffer<float>& buffer, MidiBuffer&)
+{
+    if (engine == nullptr || rampBufferSize == 0)
+        return;
+
+    wetGain.setTarget (mix->get());
+    dryGain.setTarget (1.0f - mix->get());
+
+    const int numSamples = buffer.getNumSamples();
+
+    for (int pos = 0; pos < numSamples;)
+    {
+        const int num = jmin (numSamples - pos, rampBufferSize);
+
+        wetGain.fillRamp (rampBuffer, num);
+        dryGain.fillRamp (dryRamp, num);
+        engine->process (buffer, pos, num, rampBuffer, dryRamp);
+
+        pos += num;
+    }
+}
+
+void ConvolutionProcessor::run()
+{
+    while (! threadShouldExit())
+        if (! engine->processPendingTailBlocks())
+            wait (1);
+}
+
+//==============================================================================
+void ConvolutionProcessor::writeExtraState (XmlElement& xml) const
+{
+    xml.setAttribute ("impulse", irFile.getFullPathName());
+}
+
+void ConvolutionProcessor::readExtraState (const XmlElement& xml)
+{
+    const File file (xml.getStringAttribute ("impulse"));
+
+    if (file.existsAsFile())
+        loadImpulseResponse (file);
+}
+
+//==============================================================================
+String ConvolutionProcessor::runBenchmark()
+{
+    const double sampleRate = 48000.0;
+    const int blockSize = 256;
+    const int numChannels = 2;
+    const double secondsToProcess = 10.0;
+    const int numBlocks = (int) (secondsToProcess * sampleRate / blockSize);
+    const double irLengths[] = { 0.1, 0.25, 0.5, 1.0, 2.0, 4.0, 8.0, 16.0 };
+
+    Random random;
+    AudioBuffer<float> buffer (numChannels, blockSize);
+    HeapBlock<float> wet ((size_t) blockSize), dry ((size_t) blockSize);
+    FloatVectorOperations::fill (wet, 1.0f, blockSize);
+    FloatVectorOperations::fill (dry, 0.0f, blockSize);
+
+    String report;
+    report << "Convolution benchmark: " << numChannels << " channels, " << (int) sampleRate << " Hz, "
+           << blockSize << " sample blocks, " << secondsToProcess << "s of audio per IR\n"
+           << "IR length (s)   audio thread %   tail worker %   total %\n";
+
+    for (int n = 0; n < numElementsInArray (irLengths); ++n)
+    {
+        const int irLength = (int) (irLengths[n] * sampleRate);
+        AudioBuffer<float> ir (numChannels, irLength);
+
+        for (int ch = 0; ch < numChannels; ++ch)
+            for (int i = 0; i < irLength; ++i)
+                ir.setSample (ch, i, (random.nextFloat() * 2.0f - 1.0f) * std::exp (-6.0f * i / (float) irLength));
+
+        normaliseImpulse (ir);
+
+        ConvolutionEngine bench (ir, numChannels);
+        double headMs = 0.0, tailMs = 0.0;
+
+        for (int block = 0; block < numBlocks; ++block)
+        {
+            for (int ch = 0; ch < numChannels; ++ch)
+                for (int i = 0; i < blockSize; ++i)
+                    buffer.setSample (ch, i, random.nextFloat() * 2.0f - 1.0f);
+
+            const double start = Time::getMillisecondCounterHiRes();
+            bench.process (buffer, 0, blockSize, wet, dry);
+            const double afterHead = Time::getMillisecondCounterHiRes();
+            bench.processPendingTailBlocks();
+            const double afterTail = Time::getMillisecondCounterHiRes();
+
+            headMs += afterHead - start;
+            tailMs += afterTail - afterHead;
+        }
+
+        const double realTimeMs = numBlocks * blockSize * 1000.0 / sampleRate;
+
+        report << String (irLengths[n], 2).paddedLeft (' ', 13)
+               << String (100.0 * headMs / realTimeMs, 2).paddedLeft (' ', 17)
+               << String (100.0 * tailMs / realTimeMs, 2).paddedLeft (' ', 16)
+               << String (100.0 * (headMs + tailMs) / realTimeMs, 2).paddedLeft (' ', 10) << "\n";
+    }
+
+    return report;
+}
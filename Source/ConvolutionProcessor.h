@@ -0,0 +1,90 @@
+/*
+  ==============================================================================
+
+    ConvolutionProcessor.h
+    Middle
+
+  ==============================================================================
+*/
+
+#ifndef __CONVOLUTIONPROCESSOR_JUCEHEADER__
+#define __CONVOLUTIONPROCESSOR_JUCEHEADER__
+
+#include "InternalProcessors.h"
+
+class ConvolutionEngine;
+
+
+//==============================================================================
+/**
+    A convolution node for reverbs and cabinet impulse responses.
+
+    The impulse response is split in two. The head is handled on the audio
+    thread by a uniformly-partitioned FFT convolver with short partitions, which
+    keeps the latency down to one head block. The tail is handled in much larger
+    partitions on a worker thread. Its output isn't needed until two tail blocks
+    later, so the worker has a whole tail block's worth of time to compute it.
+
+    Impulse responses are loaded, resampled to the graph's rate and transformed
+    on the calling thread. The audio thread only sees the finished engine,
+    which is swapped in while processing is suspended.
+*/
+class ConvolutionProcessor   : public InternalPlugin,
+                               private Thread
+{
+public:
+    ConvolutionProcessor();
+
+    static const char* const convolutionName;
+    ~ConvolutionProcessor();
+
+    //==============================================================================
+    void prepareToPlay (double sampleRate, int maximumExpectedSamplesPerBlock) override;
+    void releaseResources() override;
+    void renderBlock (AudioBuffer<float>&, MidiBuffer&) override;
+
+    bool isBusesLayoutSupported (const BusesLayout&) const override;
+    double getTailLengthSeconds() const override;
+
+    AudioProcessorEditor* createEditor() override;
+
+    //==============================================================================
+    /** Loads a new impulse response. Call on the message thread. */
+    bool loadImpulseResponse (const File&);
+    const File& getImpulseResponseFile() const noexcept                  { return irFile; }
+    double getImpulseResponseSeconds() const noexcept;
+
+    /** How many times the tail worker hasn't finished in time since the last prepareToPlay(). */
+    int getNumMissedTailBlocks() const noexcept;
+
+    AudioParameterFloat* getMixParameter() const noexcept               { return mix; }
+
+    /** Runs the convolution engine over noise for a range of impulse response
+        lengths, and returns a table of how much of one core it needs.
+    */
+    static String runBenchmark();
+
+private:
+    //==============================================================================
+    AudioFormatManager formatManager;
+    ScopedPointer<ConvolutionEngine> engine;
+    AudioBuffer<float> originalIr;
+    double irSampleRate, currentSampleRate;
+    File irFile;
+    bool isPrepared;
+
+    AudioParameterFloat* mix;
+    SmoothedGain wetGain, dryGain;
+    HeapBlock<float> dryRamp;
+
+    void rebuildEngine();
+    void run() override;
+
+    void writeExtraState (XmlElement&) const override;
+    void readExtraState (const XmlElement&) override;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (ConvolutionProcessor)
+};
+
+
+#endif   // __CONVOLUTIONPROCESSOR_JUCEHEADER__
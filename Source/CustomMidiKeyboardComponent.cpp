@@ -23,6 +23,7 @@ available: visit www.juce.com for more information.
 */
 
 #include "CustomMidiKeyboardComponent.h"
+#include "EmbeddedResources.h"
 
 class CustomMidiKeyboardUpDownButton : public Button
 {
@@ -77,7 +78,7 @@ CustomMidiKeyboardComponent::CustomMidiKeyboardComponent(MidiKeyboardState& s, O
 	velocity(1.0f),
 	lowVelocity(50),
 	highVelocity(90),
-	shouldCheckState(false),
+	cachedImageScale(1.0f),
 	rangeStart(0),
 	rangeEnd(127),
 	firstKey(12 * 4.0f),
@@ -137,17 +138,20 @@ CustomMidiKeyboardComponent::CustomMidiKeyboardComponent(MidiKeyboardState& s, O
 	mouseOverNotes.insertMultiple(0, -1, 32);
 	mouseDownNotes.insertMultiple(0, -1, 32);
 
+	for (int i = 0; i < numElementsInArray(pendingNoteChanges); ++i)
+		pendingNoteChanges[i].store(0);
+
 	colourChanged();
 	setWantsKeyboardFocus(true);
 
 	state.addListener(this);
-
-	startTimerHz(20);
+	markAllNotesChanged();
 }
 
 CustomMidiKeyboardComponent::~CustomMidiKeyboardComponent()
 {
 	state.removeListener(this);
+	cancelPendingUpdate();
 }
 
 //==============================================================================
@@ -220,6 +224,7 @@ void CustomMidiKeyboardComponent::setScrollButtonsVisible(const bool newCanScrol
 void CustomMidiKeyboardComponent::colourChanged()
 {
 	setOpaque(findColour(whiteNoteColourId).isOpaque());
+	invalidateKeyImageCache();
 	repaint();
 }
 
@@ -238,7 +243,7 @@ void CustomMidiKeyboardComponent::setMidiChannel(const int midiChannelNumber)
 void CustomMidiKeyboardComponent::setMidiChannelsToDisplay(const int midiChannelMask)
 {
 	midiInChannelMask = midiChannelMask;
-	shouldCheckState = true;
+	markAllNotesChanged();
 }
 
 void CustomMidiKeyboardComponent::setVelocity(const float v, const bool useMousePosition)
@@ -417,6 +422,69 @@ void CustomMidiKeyboardComponent::repaintNote(const int noteNum)
 }
 
 void CustomMidiKeyboardComponent::paint(Graphics& g)
+{
+	const float scale = g.getInternalContext().getPhysicalPixelScaleFactor();
+
+	if (scale != cachedImageScale)
+	{
+		invalidateKeyImageCache();
+		cachedImageScale = scale;
+	}
+
+	if (keyboardImage.isNull())
+	{
+		keyboardImage = Image(isOpaque() ? Image::RGB : Image::ARGB,
+			jmax(1, roundToInt(getWidth() * scale)),
+			jmax(1, roundToInt(getHeight() * scale)), true);
+
+		Graphics ig(keyboardImage);
+		ig.addTransform(AffineTransform::scale(scale));
+		paintKeyboard(ig);
+	}
+
+	g.drawImageTransformed(keyboardImage, AffineTransform::scale(1.0f / scale));
+
+	// The cached image shows every key up, so only pressed or hovered keys need
+	// anything drawn over it. A white key image covers the black keys beside it,
+	// so those get re-blitted afterwards.
+	const Rectangle<int> clip(g.getClipBounds());
+	RectangleList<int> whiteKeysDrawn;
+
+	for (int noteNum = rangeStart; noteNum <= rangeEnd; ++noteNum)
+	{
+		if (MidiMessage::isMidiNoteBlack(noteNum))
+			continue;
+
+		const bool isDown = keysCurrentlyDrawnDown[noteNum];
+		const bool isOver = mouseOverNotes.contains(noteNum);
+
+		if (isDown || isOver)
+		{
+			const Rectangle<int> area(getRectangleForKey(noteNum));
+
+			if (area.intersects(clip))
+			{
+				drawCachedKey(g, noteNum, area, isDown, isOver);
+				whiteKeysDrawn.add(area);
+			}
+		}
+	}
+
+	for (int noteNum = rangeStart; noteNum <= rangeEnd; ++noteNum)
+	{
+		if (!MidiMessage::isMidiNoteBlack(noteNum))
+			continue;
+
+		const bool isDown = keysCurrentlyDrawnDown[noteNum];
+		const bool isOver = mouseOverNotes.contains(noteNum);
+		const Rectangle<int> area(getRectangleForKey(noteNum));
+
+		if ((isDown || isOver || whiteKeysDrawn.intersectsRectangle(area)) && area.intersects(clip))
+			drawCachedKey(g, noteNum, area, isDown, isOver);
+	}
+}
+
+void CustomMidiKeyboardComponent::paintKeyboard(Graphics& g)
 {
 	g.fillAll(findColour(whiteNoteColourId));
 
@@ -434,25 +502,36 @@ void CustomMidiKeyboardComponent::paint(Graphics& g)
 				Rectangle<int> pos = getRectangleForKey(noteNum);
 
 				drawWhiteNote(noteNum, g, pos.getX(), pos.getY(), pos.getWidth(), pos.getHeight(),
-					state.isNoteOnForChannels(midiInChannelMask, noteNum),
-					mouseOverNotes.contains(noteNum), lineColour, textColour);
+					false, false, lineColour, textColour);
 			}
 		}
 	}
 
-	float x1 = 0.0f, y1 = 0.0f, x2 = 0.0f, y2 = 0.0f;
-	const int width = getWidth();
-	const int height = getHeight();
+	drawKeyboardEdges(g);
+
+	const Colour blackNoteColour(findColour(blackNoteColourId));
 
-	if (orientation == verticalKeyboardFacingLeft)
+	for (int octave = 0; octave < 128; octave += 12)
 	{
-		x1 = width - 1.0f;
-		x2 = width - 5.0f;
+		for (int black = 0; black < 5; ++black)
+		{
+			const int noteNum = octave + blackNotes[black];
+
+			if (noteNum >= rangeStart && noteNum <= rangeEnd)
+			{
+				Rectangle<int> pos = getRectangleForKey(noteNum);
+
+				drawBlackNote(noteNum, g, pos.getX(), pos.getY(), pos.getWidth(), pos.getHeight(),
+					false, false, blackNoteColour);
+			}
+		}
 	}
-	else if (orientation == verticalKeyboardFacingRight)
-		x2 = 5.0f;
-	else
-		y2 = 5.0f;
+}
+
+void CustomMidiKeyboardComponent::drawKeyboardEdges(Graphics& g)
+{
+	const int width = getWidth();
+	const int height = getHeight();
 
 	int x, w;
 	getKeyPos(rangeEnd, x, w);
@@ -473,6 +552,8 @@ void CustomMidiKeyboardComponent::paint(Graphics& g)
 		}
 	}
 
+	const Colour lineColour(findColour(keySeparatorLineColourId));
+
 	if (!lineColour.isTransparent())
 	{
 		g.setColour(lineColour);
@@ -485,25 +566,51 @@ void CustomMidiKeyboardComponent::paint(Graphics& g)
 		default: break;
 		}
 	}
+}
 
-	const Colour blackNoteColour(findColour(blackNoteColourId));
+void CustomMidiKeyboardComponent::drawCachedKey(Graphics& g, const int noteNum, Rectangle<int> area,
+	const bool isDown, const bool isOver)
+{
+	const int cacheKey = noteNum * 4 + (isDown ? 1 : 0) + (isOver ? 2 : 0);
+	Image image(keyImageCache[cacheKey]);
 
-	for (int octave = 0; octave < 128; octave += 12)
+	if (image.isNull())
 	{
-		for (int black = 0; black < 5; ++black)
+		image = Image(Image::ARGB,
+			jmax(1, roundToInt(area.getWidth() * cachedImageScale)),
+			jmax(1, roundToInt(area.getHeight() * cachedImageScale)), true);
+
+		Graphics ig(image);
+		ig.addTransform(AffineTransform::scale(cachedImageScale));
+		ig.setOrigin(-area.getX(), -area.getY());
+
+		if (MidiMessage::isMidiNoteBlack(noteNum))
 		{
-			const int noteNum = octave + blackNotes[black];
+			drawBlackNote(noteNum, ig, area.getX(), area.getY(), area.getWidth(), area.getHeight(),
+				isDown, isOver, findColour(blackNoteColourId));
+		}
+		else
+		{
+			ig.setColour(findColour(whiteNoteColourId));
+			ig.fillRect(area);
 
-			if (noteNum >= rangeStart && noteNum <= rangeEnd)
-			{
-				Rectangle<int> pos = getRectangleForKey(noteNum);
+			drawWhiteNote(noteNum, ig, area.getX(), area.getY(), area.getWidth(), area.getHeight(),
+				isDown, isOver, findColour(keySeparatorLineColourId), findColour(textLabelColourId));
 
-				drawBlackNote(noteNum, g, pos.getX(), pos.getY(), pos.getWidth(), pos.getHeight(),
-					state.isNoteOnForChannels(midiInChannelMask, noteNum),
-					mouseOverNotes.contains(noteNum), blackNoteColour);
-			}
+			drawKeyboardEdges(ig);
 		}
+
+		keyImageCache.set(cacheKey, image);
 	}
+
+	g.drawImageTransformed(image, AffineTransform::scale(1.0f / cachedImageScale)
+		.translated((float)area.getX(), (float)area.getY()));
+}
+
+void CustomMidiKeyboardComponent::invalidateKeyImageCache()
+{
+	keyboardImage = Image();
+	keyImageCache.clear();
 }
 
 void CustomMidiKeyboardComponent::drawWhiteNote(int midiNoteNumber,
@@ -528,11 +635,7 @@ void CustomMidiKeyboardComponent::drawWhiteNote(int midiNoteNumber,
 
 		g.setColour(textColour);
         
-        ReferenceCountedObjectPtr<Typeface> typeface;
-        typeface = Typeface::createSystemTypefaceFor(BinaryData::quicksand_regular_ttf, BinaryData::quicksand_regular_ttf_Size);
-        Font font(typeface);
-        font.setHeight(fontHeight);
-		g.setFont(font.withHorizontalScale(0.8f));
+		g.setFont(EmbeddedResources::getUIFont(fontHeight).withHorizontalScale(0.8f));
 
 		switch (orientation)
 		{
@@ -604,6 +707,7 @@ void CustomMidiKeyboardComponent::drawBlackNote(int /*midiNoteNumber*/,
 void CustomMidiKeyboardComponent::setOctaveForMiddleC(const int octaveNum)
 {
 	octaveNumForMiddleC = octaveNum;
+	invalidateKeyImageCache();
 	repaint();
 }
 
@@ -669,6 +773,8 @@ int CustomMidiKeyboardComponent::getBlackNoteLength() const noexcept
 
 void CustomMidiKeyboardComponent::resized()
 {
+	invalidateKeyImageCache();
+
 	int w = getWidth();
 	int h = getHeight();
 
@@ -750,14 +856,56 @@ void CustomMidiKeyboardComponent::resized()
 }
 
 //==============================================================================
-void CustomMidiKeyboardComponent::handleNoteOn(MidiKeyboardState*, int /*midiChannel*/, int /*midiNoteNumber*/, float /*velocity*/)
+void CustomMidiKeyboardComponent::handleNoteOn(MidiKeyboardState*, int /*midiChannel*/, int midiNoteNumber, float /*velocity*/)
 {
-	shouldCheckState = true; // (probably being called from the audio thread, so avoid blocking in here)
+	markNoteChanged(midiNoteNumber); // (probably being called from the audio thread, so avoid blocking in here)
 }
 
-void CustomMidiKeyboardComponent::handleNoteOff(MidiKeyboardState*, int /*midiChannel*/, int /*midiNoteNumber*/, float /*velocity*/)
+void CustomMidiKeyboardComponent::handleNoteOff(MidiKeyboardState*, int /*midiChannel*/, int midiNoteNumber, float /*velocity*/)
 {
-	shouldCheckState = true; // (probably being called from the audio thread, so avoid blocking in here)
+	markNoteChanged(midiNoteNumber); // (probably being called from the audio thread, so avoid blocking in here)
+}
+
+void CustomMidiKeyboardComponent::markNoteChanged(const int midiNoteNumber) noexcept
+{
+	if (isPositiveAndBelow(midiNoteNumber, 128))
+	{
+		pendingNoteChanges[midiNoteNumber >> 5].fetch_or((uint32)1 << (midiNoteNumber & 31));
+		triggerAsyncUpdate();
+	}
+}
+
+void CustomMidiKeyboardComponent::markAllNotesChanged() noexcept
+{
+	for (int i = 0; i < numElementsInArray(pendingNoteChanges); ++i)
+		pendingNoteChanges[i].store(0xffffffff);
+
+	triggerAsyncUpdate();
+}
+
+void CustomMidiKeyboardComponent::handleAsyncUpdate()
+{
+	// Any number of note events arriving before this runs collapse into a single pass,
+	// and only keys whose drawn state actually differs get their rectangles invalidated.
+	for (int word = 0; word < numElementsInArray(pendingNoteChanges); ++word)
+	{
+		uint32 bits = pendingNoteChanges[word].exchange(0);
+
+		for (int bit = 0; bits != 0; ++bit, bits >>= 1)
+		{
+			if ((bits & 1) == 0)
+				continue;
+
+			const int note = word * 32 + bit;
+			const bool isOn = state.isNoteOnForChannels(midiInChannelMask, note);
+
+			if (keysCurrentlyDrawnDown[note] != isOn)
+			{
+				keysCurrentlyDrawnDown.setBit(note, isOn);
+				repaintNote(note);
+			}
+		}
+	}
 }
 
 //==============================================================================
@@ -838,6 +986,7 @@ void CustomMidiKeyboardComponent::mouseMove(const MouseEvent& e)
 {
 	updateNoteUnderMouse(e, false);
 	shouldCheckMousePos = false;
+	stopTimer();
 }
 
 void CustomMidiKeyboardComponent::mouseDrag(const MouseEvent& e)
@@ -864,6 +1013,7 @@ void CustomMidiKeyboardComponent::mouseDown(const MouseEvent& e)
 	{
 		updateNoteUnderMouse(e, true);
 		shouldCheckMousePos = true;
+		startTimerHz(20);
 	}
 }
 
@@ -871,6 +1021,7 @@ void CustomMidiKeyboardComponent::mouseUp(const MouseEvent& e)
 {
 	updateNoteUnderMouse(e, false);
 	shouldCheckMousePos = false;
+	stopTimer();
 
 	float mousePositionVelocity;
 	const int note = xyToNote(e.getPosition(), mousePositionVelocity);
@@ -899,28 +1050,19 @@ void CustomMidiKeyboardComponent::mouseWheelMove(const MouseEvent&, const MouseW
 
 void CustomMidiKeyboardComponent::timerCallback()
 {
-	if (shouldCheckState)
+	// The timer only runs while a mouse button is held on the keyboard; note display
+	// is driven by handleAsyncUpdate().
+	if (!shouldCheckMousePos)
 	{
-		shouldCheckState = false;
-
-		for (int i = rangeStart; i <= rangeEnd; ++i)
-		{
-			if (keysCurrentlyDrawnDown[i] != state.isNoteOnForChannels(midiInChannelMask, i))
-			{
-				keysCurrentlyDrawnDown.setBit(i, state.isNoteOnForChannels(midiInChannelMask, i));
-				repaintNote(i);
-			}
-		}
+		stopTimer();
+		return;
 	}
 
-	if (shouldCheckMousePos)
-	{
-		const Array<MouseInputSource>& mouseSources = Desktop::getInstance().getMouseSources();
+	const Array<MouseInputSource>& mouseSources = Desktop::getInstance().getMouseSources();
 
-		for (MouseInputSource* mi = mouseSources.begin(), *const e = mouseSources.end(); mi != e; ++mi)
-			if (mi->getComponentUnderMouse() == this || isParentOf(mi->getComponentUnderMouse()))
-				updateNoteUnderMouse(getLocalPoint(nullptr, mi->getScreenPosition()).roundToInt(), mi->isDragging(), mi->getIndex());
-	}
+	for (MouseInputSource* mi = mouseSources.begin(), *const e = mouseSources.end(); mi != e; ++mi)
+		if (mi->getComponentUnderMouse() == this || isParentOf(mi->getComponentUnderMouse()))
+			updateNoteUnderMouse(getLocalPoint(nullptr, mi->getScreenPosition()).roundToInt(), mi->isDragging(), mi->getIndex());
 }
 
 //==============================================================================
@@ -25,6 +25,7 @@ available: visit www.juce.com for more information.
 #ifndef CUSTOMMIDIKEYBOARDCOMPONENT_H_INCLUDED
 #define CUSTOMMIDIKEYBOARDCOMPONENT_H_INCLUDED
 #include "../JuceLibraryCode/JuceHeader.h"
+#include <atomic>
 
 //==============================================================================
 /**
@@ -49,7 +50,8 @@ keyboard is scrolled, you can register a ChangeListener for callbacks.
 class  CustomMidiKeyboardComponent : public Component,
 	public MidiKeyboardStateListener,
 	public ChangeBroadcaster,
-	private Timer
+	private Timer,
+	private AsyncUpdater
 {
 public:
 	//==============================================================================
@@ -302,6 +304,8 @@ public:
 	/** @internal */
 	void timerCallback() override;
 	/** @internal */
+	void handleAsyncUpdate() override;
+	/** @internal */
 	bool keyStateChanged(bool isKeyDown) override;
 	/** @internal */
 	bool keyPressed(const KeyPress&) override;
@@ -411,7 +415,17 @@ private:
 
 	Array<int> mouseOverNotes, mouseDownNotes;
 	BigInteger keysPressed, keysCurrentlyDrawnDown;
-	bool shouldCheckState;
+
+	// One bit per midi note, set by the MidiKeyboardState callbacks (possibly on the
+	// audio thread) and drained on the message thread by handleAsyncUpdate().
+	std::atomic<uint32> pendingNoteChanges[4];
+
+	// Rasterised keyboard with every key up, plus lazily-rendered images of individual
+	// keys in their down/hovered states. Both are dropped whenever the size, colours
+	// or display scale change.
+	Image keyboardImage;
+	HashMap<int, Image> keyImageCache;
+	float cachedImageScale;
 
 	int rangeStart, rangeEnd;
 	float firstKey;
@@ -432,6 +446,12 @@ private:
 	void updateNoteUnderMouse(Point<int>, bool isDown, int fingerNum);
 	void updateNoteUnderMouse(const MouseEvent&, bool isDown);
 	void repaintNote(int midiNoteNumber);
+	void markNoteChanged(int midiNoteNumber) noexcept;
+	void markAllNotesChanged() noexcept;
+	void paintKeyboard(Graphics&);
+	void drawKeyboardEdges(Graphics&);
+	void drawCachedKey(Graphics&, int midiNoteNumber, Rectangle<int> area, bool isDown, bool isOver);
+	void invalidateKeyImageCache();
 	void setLowestVisibleKeyFloat(float noteNumber);
 
 	JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(CustomMidiKeyboardComponent)
@@ -0,0 +1,64 @@
+/*
+  ==============================================================================
+
+    EmbeddedResources.cpp
+    Middle
+
+  ==============================================================================
+*/
+
+#include "../JuceLibraryCode/JuceHeader.h"
+#include "EmbeddedResources.h"
+
+
+//==============================================================================
+juce_ImplementSingleton_SingleThreaded (EmbeddedResources)
+
+EmbeddedResources::EmbeddedResources()
+{
+}
+
+EmbeddedResources::~EmbeddedResources()
+{
+    clearSingletonInstance();
+}
+
+//==============================================================================
+Typeface::Ptr EmbeddedResources::getUITypeface()
+{
+    EmbeddedResources& r = *getInstance();
+
+    if (r.uiTypeface == nullptr)
+        r.uiTypeface = Typeface::createSystemTypefaceFor (BinaryData::quicksand_regular_ttf,
+                                                          BinaryData::quicksand_regular_ttf_Size);
+
+    return r.uiTypeface;
+}
+
+Font EmbeddedResources::getUIFont (const float height)
+{
+    Font font (getUITypeface());
+    font.setHeight (height);
+    return font;
+}
+
+const Drawable* EmbeddedResources::getDrawable (const char* const svgData)
+{
+    EmbeddedResources& r = *getInstance();
+
+    // There are only a handful of these, so a linear search is fine.
+    for (int i = 0; i < r.svgs.size(); ++i)
+        if (r.svgs.getUnchecked (i)->data == svgData)
+            return r.svgs.getUnchecked (i)->drawable;
+
+    ParsedSvg* const svg = r.svgs.add (new ParsedSvg());
+    svg->data = svgData;
+
+    ScopedPointer<XmlElement> xml (XmlDocument::parse (svgData));
+
+    if (xml != nullptr)
+        svg->drawable = Drawable::createFromSVG (*xml);
+
+    jassert (svg->drawable != nullptr);
+    return svg->drawable;
+}
@@ -0,0 +1,61 @@
+/*
+  ==============================================================================
+
+    EmbeddedResources.h
+    Middle
+
+  ==============================================================================
+*/
+
+#ifndef __EMBEDDEDRESOURCES_JUCEHEADER__
+#define __EMBEDDEDRESOURCES_JUCEHEADER__
+
+
+//==============================================================================
+/**
+    Loads the fonts and SVGs that are compiled into BinaryData the first time
+    they're asked for, and hands out the same instance from then on, so nothing
+    has to be created or parsed again when a component is built or repainted.
+
+    Everything it returns is shared, so treat it as read-only: take a copy of a
+    drawable with createCopy() before recolouring or moving it. Only use this on
+    the message thread.
+*/
+class EmbeddedResources   : public DeletedAtShutdown
+{
+public:
+    //==============================================================================
+    /** The Quicksand typeface that the UI uses for all its text. */
+    static Typeface::Ptr getUITypeface();
+
+    /** A Font using the UI typeface at the given height. */
+    static Font getUIFont (float height);
+
+    /** Returns the drawable parsed from one of the BinaryData SVGs, identified by
+        its data pointer, e.g. getDrawable (BinaryData::middle_highlight_svg).
+        Returns nullptr if the data isn't a valid SVG.
+    */
+    static const Drawable* getDrawable (const char* svgData);
+
+    //==============================================================================
+    juce_DeclareSingleton_SingleThreaded_Minimal (EmbeddedResources)
+
+private:
+    //==============================================================================
+    struct ParsedSvg
+    {
+        const char* data;
+        ScopedPointer<Drawable> drawable;
+    };
+
+    Typeface::Ptr uiTypeface;
+    OwnedArray<ParsedSvg> svgs;
+
+    EmbeddedResources();
+    ~EmbeddedResources();
+
+    JUCE_DECLARE_NON_COPYABLE (EmbeddedResources)
+};
+
+
+#endif   // __EMBEDDEDRESOURCES_JUCEHEADER__
@@ -0,0 +1,448 @@
+/*
+  ==============================================================================
+
+    FilePlayerProcessor.cpp
+    Middle
+
+  ==============================================================================
+*/
+
+#include "../JuceLibraryCode/JuceHeader.h"
+#include "FilePlayerProcessor.h"
+
+
+//==============================================================================
+static const double fifoSeconds = 2.0;
+
+static String formatTime (double seconds)
+{
+    const int totalSeconds = (int) seconds;
+    return String (totalSeconds / 60) + ":" + String (totalSeconds % 60).paddedLeft ('0', 2);
+}
+
+//==============================================================================
+class FilePlayerEditor   : public AudioProcessorEditor,
+                           private Button::Listener,
+                           private Timer
+{
+public:
+    FilePlayerEditor (FilePlayerProcessor& p)
+        : AudioProcessorEditor (p),
+          player (p),
+          openButton ("Open..."),
+          playButton ("Play"),
+          rewindButton ("Rewind"),
+          loopButton ("Loop")
+    {
+        addAndMakeVisible (openButton);
+        addAndMakeVisible (playButton);
+        addAndMakeVisible (rewindButton);
+        addAndMakeVisible (loopButton);
+        addAndMakeVisible (fileLabel);
+        addAndMakeVisible (positionLabel);
+
+        openButton.addListener (this);
+        playButton.addListener (this);
+        rewindButton.addListener (this);
+        loopButton.addListener (this);
+
+        positionLabel.setJustificationType (Justification::centredRight);
+
+        setSize (380, 76);
+        timerCallback();
+        startTimerHz (10);
+    }
+
+    void paint (Graphics& g) override
+    {
+        g.fillAll (getLookAndFeel().findColour (ResizableWindow::backgroundColourId));
+    }
+
+    void resized() override
+    {
+        Rectangle<int> r (getLocalBounds().reduced (8));
+
+        Rectangle<int> top (r.removeFromTop (24));
+        openButton.setBounds (top.removeFromLeft (80));
+        top.removeFromLeft (8);
+        positionLabel.setBounds (top.removeFromRight (100));
+        fileLabel.setBounds (top);
+
+        r.removeFromTop (12);
+        playButton.setBounds (r.removeFromLeft (80));
+        r.removeFromLeft (8);
+        rewindButton.setBounds (r.removeFromLeft (80));
+        r.removeFromLeft (8);
+        loopButton.setBounds (r.removeFromLeft (80));
+    }
+
+private:
+    FilePlayerProcessor& player;
+    TextButton openButton, playButton, rewindButton;
+    ToggleButton loopButton;
+    Label fileLabel, positionLabel;
+
+    void buttonClicked (Button* b) override
+    {
+        if (b == &openButton)
+        {
+            FileChooser chooser ("Open an audio file...",
+                                 player.getFile().existsAsFile() ? player.getFile() : File::getSpecialLocation (File::userMusicDirectory),
+                                 "*.wav;*.ogg");
+
+            if (chooser.browseForFileToOpen())
+                if (! player.loadFile (chooser.getResult()))
+                    AlertWindow::showMessageBoxAsync (AlertWindow::WarningIcon, "File Player",
+                                                      "Couldn't open " + chooser.getResult().getFileName());
+        }
+        else if (b == &playButton)
+        {
+            player.setPlaying (! player.isPlaying());
+        }
+        else if (b == &rewindButton)
+        {
+            player.seekTo (0.0);
+        }
+        else if (b == &loopButton)
+        {
+            player.setLooping (loopButton.getToggleState());
+        }
+
+        timerCallback();
+    }
+
+    void timerCallback() override
+    {
+        fileLabel.setText (player.getFile().getFileName(), dontSendNotification);
+        positionLabel.setText (formatTime (player.getPositionSeconds()) + " / " + formatTime (player.getLengthSeconds()),
+                               dontSendNotification);
+        playButton.setButtonText (player.isPlaying() ? "Pause" : "Play");
+        loopButton.setToggleState (player.isLooping(), dontSendNotification);
+    }
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (FilePlayerEditor)
+};
+
+//==============================================================================
+const char* const FilePlayerProcessor::filePlayerName = "File Player";
+
+FilePlayerProcessor::FilePlayerProcessor()
+    : InternalPlugin (filePlayerName, BusesProperties().withOutput ("Output", AudioChannelSet::stereo())),
+      Thread ("File Player Reader"),
+      fileSampleRate (44100.0),
+      lengthSeconds (0.0),
+      fifo (readChunkSize * 4),
+      currentSampleRate (44100.0),
+      isPrepared (false),
+      requestedGeneration (0),
+      servedGeneration (0),
+      acknowledgedGeneration (0),
+      pendingSeekFrames (-1),
+      seekTargetFrames (0),
+      framesPlayed (0),
+      reachedEnd (false)
+{
+    formatManager.registerBasicFormats();
+
+    addParameter (playing = new AudioParameterBool ("playing", "Playing", false));
+    addParameter (looping = new AudioParameterBool ("loop", "Loop", false));
+}
+
+FilePlayerProcessor::~FilePlayerProcessor()
+{
+    stopStreaming();
+}
+
+bool FilePlayerProcessor::isBusesLayoutSupported (const BusesLayout& layouts) const
+{
+    const AudioChannelSet& out = layouts.getMainOutputChannelSet();
+
+    return layouts.inputBuses.size() == 0 && layouts.outputBuses.size() == 1
+            && (out == AudioChannelSet::mono() || out == AudioChannelSet::stereo());
+}
+
+AudioProcessorEditor* FilePlayerProcessor::createEditor()
+{
+    return new FilePlayerEditor (*this);
+}
+
+//==============================================================================
+bool FilePlayerProcessor::loadFile (const File& file)
+{
+    AudioFormatReader* reader = nullptr;
+
+    if (file.hasFileExtension ("wav"))
+    {
+        // Mapping can fail for very large files in a 32-bit address space,
+        // in which case the normal buffered reader is used instead.
+        WavAudioFormat wavFormat;
+        ScopedPointer<MemoryMappedAudioFormatReader> mappedReader (wavFormat.createMemoryMappedReader (file));
+
+        if (mappedReader != nullptr && mappedReader->mapEntireFile())
+            reader = mappedReader.release();
+    }
+
+    if (reader == nullptr)
+        reader = formatManager.createReaderFor (file);
+
+    if (reader == nullptr)
+        return false;
+
+    suspendProcessing (true);
+    stopStreaming();
+
+    resamplingSource = nullptr;
+    readerSource = new AudioFormatReaderSource (reader, true);
+    resamplingSource = new ResamplingAudioSource (readerSource, false, numFifoChannels);
+
+    currentFile = file;
+    fileSampleRate = reader->sampleRate;
+    lengthSeconds = reader->lengthInSamples / reader->sampleRate;
+
+    seekTo (0.0);
+
+    if (isPrepared)
+        startStreaming();
+
+    suspendProcessing (false);
+    return true;
+}
+
+void FilePlayerProcessor::setPlaying (const bool shouldPlay)
+{
+    *playing = shouldPlay;
+}
+
+bool FilePlayerProcessor::isPlaying() const
+{
+    return playing->get();
+}
+
+void FilePlayerProcessor::setLooping (const bool shouldLoop)
+{
+    *looping = shouldLoop;
+}
+
+bool FilePlayerProcessor::isLooping() const
+{
+    return looping->get();
+}
+
+void FilePlayerProcessor::seekTo (const double seconds)
+{
+    pendingSeekFrames = (int64) (jmax (0.0, seconds) * currentSampleRate);
+}
+
+double FilePlayerProcessor::getPositionSeconds() const
+{
+    if (lengthSeconds <= 0.0)
+        return 0.0;
+
+    const double position = framesPlayed.load() / currentSampleRate;
+
+    return isLooping() ? std::fmod (position, lengthSeconds)
+                       : jmin (position, lengthSeconds);
+}
+
+//==============================================================================
+void FilePlayerProcessor::prepareToPlay (double sampleRate, int)
+{
+    const double position = getPositionSeconds();
+
+    stopStreaming();
+
+    currentSampleRate = sampleRate;
+    fifo.setTotalSize (jmax ((int) readChunkSize * 4, roundToInt (sampleRate * fifoSeconds)));
+    fifoBuffer.setSize (numFifoChannels, fifo.getTotalSize());
+    readBuffer.setSize (numFifoChannels, readChunkSize);
+    isPrepared = true;
+
+    seekTo (position);
+    startStreaming();
+}
+
+void FilePlayerProcessor::releaseResources()
+{
+    stopStreaming();
+    isPrepared = false;
+
+    fifoBuffer.setSize (0, 0);
+    readBuffer.setSize (0, 0);
+}
+
+void FilePlayerProcessor::startStreaming()
+{
+    if (resamplingSource == nullptr)
+        return;
+
+    resamplingSource->setResamplingRatio (fileSampleRate / currentSampleRate);
+    resamplingSource->prepareToPlay (readChunkSize, currentSampleRate);
+
+    fifo.reset();
+    reachedEnd = false;
+
+    startThread (6);
+}
+
+void FilePlayerProcessor::stopStreaming()
+{
+    stopThread (2000);
+}
+
+void FilePlayerProcessor::run()
+{
+    while (! threadShouldExit())
+    {
+        const int generation = requestedGeneration.load();
+
+        if (generation != servedGeneration.load())
+        {
+            readerSource->setNextReadPosition ((int64) (seekTargetFrames.load() * fileSampleRate / currentSampleRate));
+            resamplingSource->flushBuffers();
+            reachedEnd = false;
+            servedGeneration = generation;
+        }
+
+        readerSource->setLooping (looping->get());
+
+        // Looping may have been switched on after the end was reached, in which case the reader wraps round.
+        if (readerSource->isLooping())
+            reachedEnd = false;
+
+        if (acknowledgedGeneration.load() != generation
+             || reachedEnd.load()
+             || fifo.getFreeSpace() < readChunkSize)
+        {
+            wait (5);
+            continue;
+        }
+
+        AudioSourceChannelInfo info (&readBuffer, 0, readChunkSize);
+        resamplingSource->getNextAudioBlock (info);
+
+        int start1, size1, start2, size2;
+        fifo.prepareToWrite (readChunkSize, start1, size1, start2, size2);
+
+        for (int ch = 0; ch < numFifoChannels; ++ch)
+        {
+            fifoBuffer.copyFrom (ch, start1, readBuffer, ch, 0, size1);
+
+            if (size2 > 0)
+                fifoBuffer.copyFrom (ch, start2, readBuffer, ch, size1, size2);
+        }
+
+        fifo.finishedWrite (size1 + size2);
+
+        if (! readerSource->isLooping() && readerSource->getNextReadPosition() >= readerSource->getTotalLength())
+            reachedEnd = true;
+    }
+}
+
+//==============================================================================
+void FilePlayerProcessor::discardFifo()
+{
+    fifo.finishedRead (fifo.getNumReady());
+}
+
+void FilePlayerProcessor::startSeek (const int64 frames)
+{
+    // Only ever called on the audio thread, so the target and its generation can't get crossed.
+    seekTargetFrames = frames;
+    ++requestedGeneration;
+}
+
+void FilePlayerProcessor::handleMidiTransport (const MidiBuffer& midiMessages)
+{
+    MidiBuffer::Iterator i (midiMessages);
+    MidiMessage message;
+    int time;
+
+    while (i.getNextEvent (message, time))
+    {
+        if (message.isMidiStart() || message.isNoteOn())
+        {
+            startSeek (0);
+            setPlaying (true);
+        }
+        else if (message.isMidiContinue())
+        {
+            setPlaying (true);
+        }
+        else if (message.isMidiStop())
+        {
+            setPlaying (false);
+        }
+    }
+}
+
+void FilePlayerProcessor::renderBlock (AudioBuffer<float>& buffer, MidiBuffer& midiMessages)
+{
+    const int64 pendingSeek = pendingSeekFrames.exchange (-1);
+
+    if (pendingSeek >= 0)
+        startSeek (pendingSeek);
+
+    handleMidiTransport (midiMessages);
+    buffer.clear();
+
+    // While a seek is in flight the fifo may still hold audio from the old
+    // position, so drain it and output silence until the reader has moved.
+    const int generation = requestedGeneration.load();
+
+    if (servedGeneration.load() != generation)
+    {
+        discardFifo();
+        return;
+    }
+
+    if (acknowledgedGeneration.load() != generation)
+    {
+        discardFifo();
+        framesPlayed = seekTargetFrames.load();
+        acknowledgedGeneration = generation;
+        return;
+    }
+
+    if (! playing->get())
+        return;
+
+    const int numSamples = buffer.getNumSamples();
+    const int numChannels = jmin (getTotalNumOutputChannels(), (int) numFifoChannels);
+
+    int start1, size1, start2, size2;
+    fifo.prepareToRead (numSamples, start1, size1, start2, size2);
+
+    for (int ch = 0; ch < numChannels; ++ch)
+    {
+        buffer.copyFrom (ch, 0, fifoBuffer, ch, start1, size1);
+
+        if (size2 > 0)
+            buffer.copyFrom (ch, size1, fifoBuffer, ch, start2, size2);
+    }
+
+    fifo.finishedRead (size1 + size2);
+    framesPlayed += size1 + size2;
+
+    if (size1 + size2 < numSamples && reachedEnd.load())
+    {
+        setPlaying (false);
+        startSeek (0);
+    }
+}
+
+//==============================================================================
+void FilePlayerProcessor::writeExtraState (XmlElement& xml) const
+{
+    xml.setAttribute ("file", currentFile.getFullPathName());
+}
+
+void FilePlayerProcessor::readExtraState (const XmlElement& xml)
+{
+    const File file (xml.getStringAttribute ("file"));
+
+    if (file.existsAsFile())
+        loadFile (file);
+
+    // Don't start playing by surprise when a project is reopened.
+    setPlaying (false);
+}
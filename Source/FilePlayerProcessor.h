@@ -0,0 +1,109 @@
+/*
+  ==============================================================================
+
+    FilePlayerProcessor.h
+    Middle
+
+  ==============================================================================
+*/
+
+#ifndef __FILEPLAYERPROCESSOR_JUCEHEADER__
+#define __FILEPLAYERPROCESSOR_JUCEHEADER__
+
+#include <atomic>
+#include "InternalProcessors.h"
+
+
+//==============================================================================
+/**
+    An internal node that streams an audio file from disk.
+
+    A background thread reads (and resamples) the file into a fixed-size
+    AbstractFifo, so arbitrarily long files play with bounded memory and the
+    audio thread never touches the disk. WAV files are memory-mapped when the
+    address space allows it.
+
+    Seeking uses a small generation handshake instead of a lock. Only the audio
+    thread starts a seek: the message thread just posts its target in
+    pendingSeekFrames, which the next block picks up. The audio thread sets the
+    target and bumps requestedGeneration, the reader thread repositions and sets
+    servedGeneration, and the audio thread throws away whatever stale audio is
+    still in the fifo before setting acknowledgedGeneration, after which the
+    reader starts writing again.
+
+    Transport is driven by the "Playing" and "Loop" parameters, the editor's
+    buttons, or MIDI: Start and note-ons play from the top, Continue resumes
+    and Stop pauses.
+*/
+class FilePlayerProcessor   : public InternalPlugin,
+                              private Thread
+{
+public:
+    FilePlayerProcessor();
+
+    static const char* const filePlayerName;
+    ~FilePlayerProcessor();
+
+    //==============================================================================
+    void prepareToPlay (double sampleRate, int maximumExpectedSamplesPerBlock) override;
+    void releaseResources() override;
+    void renderBlock (AudioBuffer<float>&, MidiBuffer&) override;
+
+    bool isBusesLayoutSupported (const BusesLayout&) const override;
+    bool acceptsMidi() const override                                   { return true; }
+
+    AudioProcessorEditor* createEditor() override;
+
+    //==============================================================================
+    /** Opens a file for playback, replacing the current one. Call on the message thread. */
+    bool loadFile (const File& file);
+    const File& getFile() const noexcept                                 { return currentFile; }
+
+    void setPlaying (bool shouldPlay);
+    bool isPlaying() const;
+    void setLooping (bool shouldLoop);
+    bool isLooping() const;
+
+    /** Asks for the play position to move; the audio thread does it at its next block. */
+    void seekTo (double seconds);
+
+    double getPositionSeconds() const;
+    double getLengthSeconds() const noexcept                             { return lengthSeconds; }
+
+private:
+    //==============================================================================
+    AudioFormatManager formatManager;
+    ScopedPointer<AudioFormatReaderSource> readerSource;
+    ScopedPointer<ResamplingAudioSource> resamplingSource;
+    File currentFile;
+    double fileSampleRate, lengthSeconds;
+
+    AudioParameterBool* playing;
+    AudioParameterBool* looping;
+
+    AbstractFifo fifo;
+    AudioBuffer<float> fifoBuffer, readBuffer;
+    double currentSampleRate;
+    bool isPrepared;
+
+    std::atomic<int> requestedGeneration, servedGeneration, acknowledgedGeneration;
+    std::atomic<int64> pendingSeekFrames, seekTargetFrames, framesPlayed;
+    std::atomic<bool> reachedEnd;
+
+    enum { numFifoChannels = 2, readChunkSize = 4096 };
+
+    void run() override;
+    void startStreaming();
+    void stopStreaming();
+    void discardFifo();
+    void startSeek (int64 frames);
+    void handleMidiTransport (const MidiBuffer&);
+
+    void writeExtraState (XmlElement&) const override;
+    void readExtraState (const XmlElement&) override;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (FilePlayerProcessor)
+};
+
+
+#endif   // __FILEPLAYERPROCESSOR_JUCEHEADER__
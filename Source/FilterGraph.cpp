@@ -27,11 +27,201 @@
 #include "FilterGraph.h"
 #include "InternalFilters.h"
 #include "GraphEditorPanel.h"
+#include "RackProcessor.h"
+#include "StallMonitor.h"
+#include "TappedPluginInstance.h"
 
 
 //==============================================================================
 const int FilterGraph::midiChannelNumber = 0x1000;
 
+//==============================================================================
+/**
+    Does the work for loadFromAsync(): parses the file on its own thread, then
+    creates one plugin per timer callback on the message thread, because most
+    plugin formats have to be created there. The instances are kept to one side
+    until they're all ready, so the graph that's playing is untouched until the
+    moment it's swapped for the new one.
+
+    A loader that's no longer wanted is abandon()ed rather than deleted, as
+    parsing can't be interrupted and the message thread mustn't wait for it.
+*/
+class FilterGraph::AsyncLoader   : private Thread,
+                                   private AsyncUpdater,
+                                   private Timer
+{
+public:
+    AsyncLoader (FilterGraph& o, const File& f, bool showMessage)
+        : Thread ("Project Loader"),
+          owner (o), file (f), showMessageOnFailure (showMessage),
+          numCreated (0), active (true), hasParsed (false), abandoned (false),
+          status ("Reading " + f.getFileNameWithoutExtension())
+    {
+        startThread (4);
+    }
+
+    ~AsyncLoader()
+    {
+        stopThread (10000);
+        cancelPendingUpdate();
+        stopTimer();
+    }
+
+    /** Drops the load and deletes the loader, straight away if the file has been
+        parsed, or else as soon as the parsing thread has finished. The loader
+        won't touch its owner again, so the owner may be deleted first.
+    */
+    void abandon()
+    {
+        if (hasParsed)
+        {
+            delete this;
+            return;
+        }
+
+        abandoned = true;
+        active = false;
+        signalThreadShouldExit();
+    }
+
+    bool isActive() const noexcept                      { return active; }
+    const String& getStatus() const noexcept            { return status; }
+
+    double getProgress() const noexcept
+    {
+        // Parsing counts as the first step, and connecting up as the last.
+        return filterXmls.size() > 0 ? (numCreated + 1) / (double) (filterXmls.size() + 2) : 0.0;
+    }
+
+private:
+    FilterGraph& owner;
+    const File file;
+    const bool showMessageOnFailure;
+
+    ScopedPointer<XmlElement> xml;
+    String parseError;
+
+    Array<XmlElement*> filterXmls;
+    OwnedArray<AudioPluginInstance> instances;
+    int numCreated;
+    bool active, hasParsed, abandoned;
+    String status;
+
+    void run() override
+    {
+        XmlDocument doc (file);
+        ScopedPointer<XmlElement> parsed (doc.getDocumentElement());
+
+        if (parsed == nullptr || ! parsed->hasTagName ("FILTERGRAPH"))
+            parseError = "Not a valid filter graph file";
+
+        xml = parsed.release();
+
+        // This goes out even if the load has been abandoned, as that's when it deletes itself.
+        triggerAsyncUpdate();
+    }
+
+    void handleAsyncUpdate() override
+    {
+        if (abandoned)
+        {
+            delete this;
+            return;
+        }
+
+        hasParsed = true;
+
+        if (parseError.isNotEmpty())
+        {
+            finish (Result::fail (parseError));
+            return;
+        }
+
+        forEachXmlChildElementWithTagName (*xml, e, "FILTER")
+        {
+            owner.resolvePluginFile (*e);
+            filterXmls.add (e);
+        }
+
+        updateStatus();
+        owner.sendLoadProgress();
+        startTimer (1);
+    }
+
+    void timerCallback() override
+    {
+        if (numCreated < filterXmls.size())
+        {
+            // Some plugins can't be created, and are just left out, as they are by loadFrom().
+            instances.add (owner.createInstanceFromXml (*filterXmls.getUnchecked (numCreated)));
+            ++numCreated;
+
+            updateStatus();
+            owner.sendLoadProgress();
+            return;
+        }
+
+        stopTimer();
+
+        const StallMonitor::ScopedActivity activity ("Replacing the graph with " + file.getFileName());
+        owner.clear();
+
+        for (int i = 0; i < filterXmls.size(); ++i)
+        {
+            if (AudioPluginInstance* const instance = instances.getUnchecked (i))
+            {
+                instances.set (i, nullptr, false);
+                owner.addNodeFromXml (instance, *filterXmls.getUnchecked (i));
+            }
+        }
+
+        owner.restoreConnectionsFromXml (*xml);
+        owner.changed();
+
+        finish (Result::ok());
+    }
+
+    void updateStatus()
+    {
+        if (numCreated < filterXmls.size())
+        {
+            const XmlElement* const plugin = filterXmls.getUnchecked (numCreated)->getChildByName ("PLUGIN");
+
+            status = "Loading " + (plugin != nullptr ? plugin->getStringAttribute ("name") : String ("plugin"))
+                       + " (" + String (numCreated + 1) + " of " + String (filterXmls.size()) + ")";
+        }
+        else
+        {
+            status = "Connecting";
+        }
+    }
+
+    void finish (const Result& result)
+    {
+        active = false;
+        instances.clear();
+
+        if (result.wasOk())
+        {
+            owner.setFile (file);
+            owner.setChangedFlag (false);
+            owner.setLastDocumentOpened (file);
+        }
+        else if (showMessageOnFailure)
+        {
+            AlertWindow::showMessageBoxAsync (AlertWindow::WarningIcon,
+                                              "Failed to open file...",
+                                              "There was an error while trying to load the file: "
+                                                + file.getFullPathName() + "\n\n" + result.getErrorMessage());
+        }
+
+        owner.sendLoadProgress();
+    }
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (AsyncLoader)
+};
+
+//==============================================================================
 FilterGraph::FilterGraph (AudioPluginFormatManager& formatManager_)
     : FileBasedDocument (filenameSuffix,
                          filenameWildcard,
@@ -52,6 +242,9 @@ FilterGraph::FilterGraph (AudioPluginFormatManager& formatManager_)
 
 FilterGraph::~FilterGraph()
 {
+    PluginWindow::closeCurrentlyOpenWindowsFor (graph);
+    abandonLoader();
+
     graph.removeListener (this);
     graph.clear();
 }
@@ -111,8 +304,9 @@ void FilterGraph::addFilterCallback (AudioPluginInstance* instance, const String
     }
     else
     {
+        const StallMonitor::ScopedActivity activity ("Adding " + instance->getName() + " to the graph");
         instance->enableAllBuses();
-        AudioProcessorGraph::Node* node = graph.addNode (instance);
+        AudioProcessorGraph::Node* node = graph.addNode (wrapForTapping (instance));
 
         if (node != nullptr)
         {
@@ -125,9 +319,15 @@ void FilterGraph::addFilterCallback (AudioPluginInstance* instance, const String
 
 void FilterGraph::removeFilter (const uint32 id)
 {
-    
-    PluginEditor::closePluginEditorsFor(id);
-    PluginWindow::closeCurrentlyOpenWindowsFor (id);
+    String name ("a plugin");
+
+    if (const AudioProcessorGraph::Node::Ptr node = graph.getNodeForId (id))
+        name = node->getProcessor()->getName();
+
+    const StallMonitor::ScopedActivity activity ("Removing " + name);
+
+    PluginEditor::closePluginEditorsFor (graph, id);
+    PluginWindow::closeCurrentlyOpenWindowsFor (graph, id);
 
     if (graph.removeNode (id))
         changed();
@@ -149,20 +349,42 @@ void FilterGraph::setNodePosition (const uint32 nodeId, double x, double y)
 {
     if (AudioProcessorGraph::Node::Ptr n = graph.getNodeForId (nodeId))
     {
-        n->properties.set ("x", jlimit (0.0, 1.0, x));
-        n->properties.set ("y", jlimit (0.0, 1.0, y));
+        n->properties.set ("x", x);
+        n->properties.set ("y", y);
     }
 }
 
 Point<double> FilterGraph::getNodePosition (const uint32 nodeId) const
 {
     if (AudioProcessorGraph::Node::Ptr n = graph.getNodeForId (nodeId))
-        return Point<double> (static_cast<double> (n->properties ["x"]),
-                              static_cast<double> (n->properties ["y"]));
+        return getNodePosition (*n);
 
     return Point<double>();
 }
 
+Point<double> FilterGraph::getNodePosition (const AudioProcessorGraph::Node& node)
+{
+    return Point<double> (static_cast<double> (node.properties ["x"]),
+                          static_cast<double> (node.properties ["y"]));
+}
+
+const SignalTap* FilterGraph::getOutputTapFor (const AudioProcessorGraph::Node& node) const noexcept
+{
+    AudioProcessor* const processor = node.getProcessor();
+
+    if (const InternalPlugin* const plugin = dynamic_cast<InternalPlugin*> (processor))
+        return &plugin->getOutputTap();
+
+    if (const TappedPluginInstance* const hosted = dynamic_cast<TappedPluginInstance*> (processor))
+        return &hosted->getOutputTap();
+
+    if (const AudioProcessorGraph::AudioGraphIOProcessor* const io = dynamic_cast<AudioProcessorGraph::AudioGraphIOProcessor*> (processor))
+        if (io->isInput())
+            return &inputTap;
+
+    return nullptr;
+}
+
 //==============================================================================
 int FilterGraph::getNumConnections() const noexcept
 {
@@ -216,8 +438,8 @@ void FilterGraph::removeConnection (uint32 sourceFilterUID, int sourceFilterChan
 
 void FilterGraph::clear()
 {
-    PluginEditor::closeAllPluginEditors();
-    PluginWindow::closeAllCurrentlyOpenWindows();
+    PluginEditor::closePluginEditorsFor (graph);
+    PluginWindow::closeCurrentlyOpenWindowsFor (graph);
 
     graph.clear();
     changed();
@@ -265,6 +487,7 @@ Result FilterGraph::saveDocument (const File& file)
 	{
 		return Result::fail("This is a template project. To save your own copy of this project, choose 'Save As'. Any recording will be saved as well.");
 	}
+    const StallMonitor::ScopedActivity activity ("Saving " + file.getFileName());
     ScopedPointer<XmlElement> xml (createXml());
 
 	if (!xml->writeToFile(file, String()))
@@ -391,9 +614,18 @@ static XmlElement* createNodeXml (AudioProcessorGraph::Node* const node) noexcep
 
     XmlElement* state = new XmlElement ("STATE");
 
-    MemoryBlock m;
-    node->getProcessor()->getStateInformation (m);
-    state->addTextElement (m.toBase64Encoding());
+    if (InternalPlugin* const internal = dynamic_cast<InternalPlugin*> (plugin))
+    {
+        // Internal nodes are written out as xml, so a rack's graph nests like the outer one does.
+        state->addChildElement (internal->createStateXml());
+    }
+    else
+    {
+        MemoryBlock m;
+        node->getProcessor()->getStateInformation (m);
+        state->addTextElement (m.toBase64Encoding());
+    }
+
     e->addChildElement (state);
 
     XmlElement* layouts = new XmlElement ("LAYOUT");
@@ -408,6 +640,12 @@ static XmlElement* createNodeXml (AudioProcessorGraph::Node* const node) noexcep
 }
 
 void FilterGraph::createNodeFromXml (const XmlElement& xml)
+{
+    if (AudioPluginInstance* const instance = createInstanceFromXml (xml))
+        addNodeFromXml (instance, xml);
+}
+
+AudioPluginInstance* FilterGraph::createInstanceFromXml (const XmlElement& xml)
 {
     PluginDescription pd;
 
@@ -419,10 +657,11 @@ void FilterGraph::createNodeFromXml (const XmlElement& xml)
 
     String errorMessage;
 
+    const StallMonitor::ScopedActivity activity ("Creating " + pd.name);
     AudioPluginInstance* instance = formatManager.createPluginInstance (pd, graph.getSampleRate(), graph.getBlockSize(), errorMessage);
 
     if (instance == nullptr)
-        return;
+        return nullptr;
 
     if (const XmlElement* const layoutEntity = xml.getChildByName ("LAYOUT"))
     {
@@ -434,16 +673,45 @@ void FilterGraph::createNodeFromXml (const XmlElement& xml)
         instance->setBusesLayout (layout);
     }
 
-    AudioProcessorGraph::Node::Ptr node (graph.addNode (instance, (uint32) xml.getIntAttribute ("uid")));
-
     if (const XmlElement* const state = xml.getChildByName ("STATE"))
     {
-        MemoryBlock m;
-        m.fromBase64Encoding (state->getAllSubText());
+        if (const XmlElement* const internalState = state->getChildByName ("INTERNALSTATE"))
+        {
+            if (InternalPlugin* const internal = dynamic_cast<InternalPlugin*> (instance))
+                internal->restoreStateFromXml (*internalState);
+        }
+        else if (const XmlElement* const graphXml = state->getChildByName ("FILTERGRAPH"))
+        {
+            // Older projects saved a rack as its bare graph.
+            if (RackProcessor* const rack = dynamic_cast<RackProcessor*> (instance))
+                rack->restoreGraphFromXml (*graphXml);
+        }
+        else
+        {
+            MemoryBlock m;
+            m.fromBase64Encoding (state->getAllSubText());
 
-        node->getProcessor()->setStateInformation (m.getData(), (int) m.getSize());
+            instance->setStateInformation (m.getData(), (int) m.getSize());
+        }
     }
 
+    return wrapForTapping (instance);
+}
+
+AudioPluginInstance* FilterGraph::wrapForTapping (AudioPluginInstance* const instance)
+{
+    // Internal types measure themselves, and the graph needs to see its I/O nodes as they are.
+    if (dynamic_cast<InternalPlugin*> (instance) != nullptr
+         || dynamic_cast<AudioProcessorGraph::AudioGraphIOProcessor*> (instance) != nullptr)
+        return instance;
+
+    return new TappedPluginInstance (instance);
+}
+
+void FilterGraph::addNodeFromXml (AudioPluginInstance* const instance, const XmlElement& xml)
+{
+    AudioProcessorGraph::Node::Ptr node (graph.addNode (instance, (uint32) xml.getIntAttribute ("uid")));
+
     node->properties.set ("x", xml.getDoubleAttribute ("x"));
     node->properties.set ("y", xml.getDoubleAttribute ("y"));
 
@@ -509,22 +777,32 @@ void FilterGraph::restoreFromXml (const XmlElement& xml)
 
     forEachXmlChildElementWithTagName (xml, e, "FILTER")
     {
-		if (auto* plugin = e->getChildByName("PLUGIN")) {
-			String finalPath = plugin->getStringAttribute("file");
-			if (plugin->getStringAttribute("manufacturer") == "SongWish Inc.") {
-				String documentsFolder = File::getSpecialLocation(File::userDocumentsDirectory).getFullPathName();
-				String folder = documentsFolder + "/Middle/Plugins/SongWish/";
-				String fileNameWithoutExtension = finalPath;
-				String winExtension = ".dll";
-				String macExtension = ".vst";
-				finalPath = pluginPropertyStringToFilePath(folder, fileNameWithoutExtension, winExtension, macExtension);
-			}
-			plugin->setAttribute("file", finalPath);
-		}
+        resolvePluginFile (*e);
         createNodeFromXml (*e);
         changed();
     }
 
+    restoreConnectionsFromXml (xml);
+}
+
+void FilterGraph::resolvePluginFile (XmlElement& filterXml)
+{
+	if (auto* plugin = filterXml.getChildByName("PLUGIN")) {
+		String finalPath = plugin->getStringAttribute("file");
+		if (plugin->getStringAttribute("manufacturer") == "SongWish Inc.") {
+			String documentsFolder = File::getSpecialLocation(File::userDocumentsDirectory).getFullPathName();
+			String folder = documentsFolder + "/Middle/Plugins/SongWish/";
+			String fileNameWithoutExtension = finalPath;
+			String winExtension = ".dll";
+			String macExtension = ".vst";
+			finalPath = pluginPropertyStringToFilePath(folder, fileNameWithoutExtension, winExtension, macExtension);
+		}
+		plugin->setAttribute("file", finalPath);
+	}
+}
+
+void FilterGraph::restoreConnectionsFromXml (const XmlElement& xml)
+{
     forEachXmlChildElementWithTagName (xml, e, "CONNECTION")
     {
         addConnection ((uint32) e->getIntAttribute ("srcFilter"),
@@ -536,6 +814,59 @@ void FilterGraph::restoreFromXml (const XmlElement& xml)
     graph.removeIllegalConnections();
 }
 
+//==============================================================================
+void FilterGraph::addLoadListener (LoadListener* const listener)
+{
+    loadListeners.add (listener);
+}
+
+void FilterGraph::removeLoadListener (LoadListener* const listener)
+{
+    loadListeners.remove (listener);
+}
+
+void FilterGraph::loadFromAsync (const File& file, const bool showMessageOnFailure)
+{
+    abandonLoader();
+    loader = new AsyncLoader (*this, file, showMessageOnFailure);
+    sendLoadProgress();
+}
+
+void FilterGraph::cancelLoading()
+{
+    if (isLoading())
+    {
+        abandonLoader();
+        sendLoadProgress();
+    }
+}
+
+void FilterGraph::abandonLoader()
+{
+    if (loader != nullptr)
+        loader.release()->abandon();
+}
+
+bool FilterGraph::isLoading() const noexcept
+{
+    return loader != nullptr && loader->isActive();
+}
+
+double FilterGraph::getLoadProgress() const noexcept
+{
+    return isLoading() ? loader->getProgress() : 0.0;
+}
+
+String FilterGraph::getLoadStatus() const
+{
+    return isLoading() ? loader->getStatus() : String();
+}
+
+void FilterGraph::sendLoadProgress()
+{
+    loadListeners.call (&LoadListener::loadProgressChanged, *this);
+}
+
 String FilterGraph::filePathToPluginPropertyString(String filePath) const
 {
 	File file(filePath);
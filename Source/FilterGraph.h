@@ -25,6 +25,7 @@
 #ifndef __FILTERGRAPH_JUCEHEADER__
 #define __FILTERGRAPH_JUCEHEADER__
 
+#include "SignalTap.h"
 
 class FilterInGraph;
 class FilterGraph;
@@ -59,9 +60,15 @@ public:
 
     void removeIllegalConnections();
 
+    /** Node positions are unbounded: (0, 0) to (1, 1) is just the area that the
+        editor shows by default, and a graph can spread as far as it needs beyond it.
+    */
     void setNodePosition (uint32 nodeId, double x, double y);
     Point<double> getNodePosition (uint32 nodeId) const;
 
+    /** Reads the position straight from a node, without looking it up by id. */
+    static Point<double> getNodePosition (const AudioProcessorGraph::Node&);
+
     //==============================================================================
     int getNumConnections() const noexcept;
     const AudioProcessorGraph::Connection* getConnection (const int index) const noexcept;
@@ -83,6 +90,18 @@ public:
     void clear();
 
 
+    //==============================================================================
+    /** What arrives at the graph's audio and midi input nodes. Whatever plays the
+        graph measures its input into this, since the input nodes can't.
+    */
+    SignalTap& getInputTap() noexcept                                    { return inputTap; }
+
+    /** The tap measuring what leaves a node, or nullptr for the output nodes,
+        which send nothing on. Hosted plugins are measured by the
+        TappedPluginInstance that each one is wrapped in.
+    */
+    const SignalTap* getOutputTapFor (const AudioProcessorGraph::Node&) const noexcept;
+
     //==============================================================================
     void audioProcessorParameterChanged (AudioProcessor*, int, float) override {}
     void audioProcessorChanged (AudioProcessor*) override { changed(); }
@@ -91,6 +110,40 @@ public:
     XmlElement* createXml() const;
     void restoreFromXml (const XmlElement& xml);
 
+    //==============================================================================
+    /** Receives progress reports from loadFromAsync(). */
+    class LoadListener
+    {
+    public:
+        virtual ~LoadListener() {}
+
+        /** Called on the message thread each time the load moves on, and once
+            more when it has finished or been cancelled.
+        */
+        virtual void loadProgressChanged (FilterGraph&) = 0;
+    };
+
+    void addLoadListener (LoadListener*);
+    void removeLoadListener (LoadListener*);
+
+    /** Starts loading a project and returns straight away.
+
+        The file is parsed on a background thread, then its plugins are created
+        one per turn of the message loop, while the current graph carries on
+        playing. The graph is only replaced once everything is ready, so
+        cancelLoading() leaves it just as it was, and returns straight away even
+        if the file is still being parsed. Starting a new load cancels any
+        that's still going.
+    */
+    void loadFromAsync (const File& file, bool showMessageOnFailure);
+    void cancelLoading();
+
+    bool isLoading() const noexcept;
+    /** How far the current load has got, from 0 to 1. */
+    double getLoadProgress() const noexcept;
+    /** A description of what the current load is doing. */
+    String getLoadStatus() const;
+
     //==============================================================================
     void newDocument();
     String getDocumentTitle() override;
@@ -112,11 +165,23 @@ private:
     //==============================================================================
     AudioPluginFormatManager& formatManager;
     AudioProcessorGraph graph;
+    SignalTap inputTap;
 
     uint32 lastUID;
     uint32 getNextUID() noexcept;
 
+    class AsyncLoader;
+    ScopedPointer<AsyncLoader> loader;
+    ListenerList<LoadListener> loadListeners;
+
     void createNodeFromXml (const XmlElement& xml);
+    AudioPluginInstance* createInstanceFromXml (const XmlElement& xml);
+    static AudioPluginInstance* wrapForTapping (AudioPluginInstance*);
+    void addNodeFromXml (AudioPluginInstance* instance, const XmlElement& xml);
+    void resolvePluginFile (XmlElement& filterXml);
+    void restoreConnectionsFromXml (const XmlElement& xml);
+    void sendLoadProgress();
+    void abandonLoader();
 
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (FilterGraph)
 };
@@ -0,0 +1,277 @@
+/*
+  ==============================================================================
+
+    GeneratorProcessor.cpp
+    Middle
+
+  ==============================================================================
+*/
+
+#include "../JuceLibraryCode/JuceHeader.h"
+#include "GeneratorProcessor.h"
+
+
+//==============================================================================
+static const double levelRampSeconds = 0.05;
+static const int64 noiseSeed = 0x4d69646c65;
+
+static const double sweepStartHz = 20.0;
+static const double sweepEndHz = 20000.0;
+
+static const char* const waveformNames[] = { "Sine", "Sweep", "White Noise", "Pink Noise", "Impulse Train" };
+static const char* const patternNames[]  = { "Off", "Repeated Note", "Arpeggio", "Chords" };
+
+static const int midiChannel = 1;
+static const uint8 noteVelocity = 100;
+
+// Each pattern step is a list of notes, terminated by -1.
+static const int repeatedNoteSteps[][4] = { { 60, -1 } };
+static const int arpeggioSteps[][4]     = { { 60, -1 }, { 64, -1 }, { 67, -1 }, { 72, -1 }, { 67, -1 }, { 64, -1 } };
+static const int chordSteps[][4]        = { { 60, 64, 67, -1 }, { 65, 69, 72, -1 }, { 67, 71, 74, -1 }, { 60, 64, 67, -1 } };
+
+//==============================================================================
+const char* const GeneratorProcessor::generatorName = "Signal Generator";
+
+GeneratorProcessor::GeneratorProcessor()
+    : InternalPlugin (generatorName, BusesProperties().withOutput ("Output", AudioChannelSet::stereo())),
+      currentSampleRate (44100.0),
+      phase (0.0),
+      sweepPosition (0.0),
+      samplesToNextImpulse (0.0),
+      samplesToNextNote (0.0),
+      random (noiseSeed),
+      currentPattern (noNotes),
+      patternStep (0)
+{
+    addParameter (waveform = new AudioParameterChoice ("waveform", "Waveform",
+                                                       StringArray (waveformNames, numElementsInArray (waveformNames)),
+                                                       sineWave));
+    addParameter (frequency = new AudioParameterFloat ("frequency", "Frequency (Hz)",
+                                                       NormalisableRange<float> (20.0f, 20000.0f, 0.0f, 0.25f), 1000.0f));
+    addParameter (levelDb = new AudioParameterFloat ("level", "Level (dB)",
+                                                     NormalisableRange<float> (-60.0f, 0.0f), -18.0f));
+    addParameter (sweepSeconds = new AudioParameterFloat ("sweepTime", "Sweep Time (s)",
+                                                          NormalisableRange<float> (0.5f, 30.0f), 5.0f));
+    addParameter (impulseRate = new AudioParameterFloat ("impulseRate", "Impulses / Second",
+                                                         NormalisableRange<float> (0.5f, 50.0f), 1.0f));
+    addParameter (notePattern = new AudioParameterChoice ("notePattern", "MIDI Pattern",
+                                                          StringArray (patternNames, numElementsInArray (patternNames)),
+                                                          noNotes));
+    addParameter (noteRate = new AudioParameterFloat ("noteRate", "Notes / Second",
+                                                      NormalisableRange<float> (0.5f, 16.0f), 4.0f));
+
+    zeromem (pinkState, sizeof (pinkState));
+    heldNotes.ensureStorageAllocated (4);
+}
+
+bool GeneratorProcessor::isBusesLayoutSupported (const BusesLayout& layouts) const
+{
+    return layouts.inputBuses.size() == 0 && layouts.outputBuses.size() == 1
+            && ! layouts.getMainOutputChannelSet().isDisabled();
+}
+
+//==============================================================================
+void GeneratorProcessor::prepareToPlay (double sampleRate, int maximumExpectedSamplesPerBlock)
+{
+    currentSampleRate = sampleRate;
+
+    level.prepare (sampleRate, levelRampSeconds);
+    level.setImmediately (Decibels::decibelsToGain (levelDb->get(), -60.0f));
+    ensureRampBuffer (maximumExpectedSamplesPerBlock);
+
+    resetGenerators();
+}
+
+void GeneratorProcessor::releaseResources()
+{
+}
+
+void GeneratorProcessor::resetGenerators()
+{
+    phase = 0.0;
+    sweepPosition = 0.0;
+    samplesToNextImpulse = 0.0;
+    samplesToNextNote = 0.0;
+    random.setSeed (noiseSeed);
+    zeromem (pinkState, sizeof (pinkState));
+
+    // Whoever receives our notes is restarting too, so nothing is left hanging.
+    heldNotes.clearQuick();
+    currentPattern = noNotes;
+    patternStep = 0;
+}
+
+void GeneratorProcessor::renderBlock (AudioBuffer<float>& buffer, MidiBuffer& midiMessages)
+{
+    const int numSamples = buffer.getNumSamples();
+    const int numChannels = buffer.getNumChannels();
+
+    midiMessages.clear();
+    renderNotes (midiMessages, numSamples);
+
+    if (numChannels == 0)
+        return;
+
+    renderSignal (buffer.getWritePointer (0), numSamples);
+
+    for (int ch = 1; ch < numChannels; ++ch)
+        buffer.copyFrom (ch, 0, buffer, 0, 0, numSamples);
+
+    level.setTarget (Decibels::decibelsToGain (levelDb->get(), -60.0f));
+    applySmoothedGain (level, buffer, 0, numChannels);
+}
+
+//==============================================================================
+void GeneratorProcessor::renderSignal (float* dest, int numSamples)
+{
+    switch (waveform->getIndex())
+    {
+        case sineWave:
+        {
+            const double delta = 2.0 * double_Pi * frequency->get() / currentSampleRate;
+
+            for (int i = 0; i < numSamples; ++i)
+            {
+                dest[i] = (float) std::sin (phase);
+                phase += delta;
+            }
+
+            phase = std::fmod (phase, 2.0 * double_Pi);
+            break;
+        }
+
+        case sweepWave:
+        {
+            // Exponential, so every octave gets the same amount of time.
+            const double sweepLength = jmax (1.0, sweepSeconds->get() * currentSampleRate);
+            const double logRatio = std::log (sweepEndHz / sweepStartHz);
+
+            for (int i = 0; i < numSamples; ++i)
+            {
+                const double hz = sweepStartHz * std::exp (logRatio * sweepPosition / sweepLength);
+
+                dest[i] = (float) std::sin (phase);
+                phase = std::fmod (phase + 2.0 * double_Pi * hz / currentSampleRate, 2.0 * double_Pi);
+
+                if (++sweepPosition >= sweepLength)
+                {
+                    sweepPosition = 0.0;
+                    phase = 0.0;
+                }
+            }
+
+            break;
+        }
+
+        case whiteNoise:
+            for (int i = 0; i < numSamples; ++i)
+                dest[i] = random.nextFloat() * 2.0f - 1.0f;
+
+            break;
+
+        case pinkNoise:
+            // Paul Kellet's filter: a sum of first-order lowpasses that's within
+            // 0.05dB of -3dB/octave across the audio band.
+            for (int i = 0; i < numSamples; ++i)
+            {
+                const float white = random.nextFloat() * 2.0f - 1.0f;
+                float* const b = pinkState;
+
+                b[0] = 0.99886f * b[0] + white * 0.0555179f;
+                b[1] = 0.99332f * b[1] + white * 0.0750759f;
+                b[2] = 0.96900f * b[2] + white * 0.1538520f;
+                b[3] = 0.86650f * b[3] + white * 0.3104856f;
+                b[4] = 0.55000f * b[4] + white * 0.5329522f;
+                b[5] = -0.7616f * b[5] - white * 0.0168980f;
+
+                dest[i] = (b[0] + b[1] + b[2] + b[3] + b[4] + b[5] + b[6] + white * 0.5362f) * 0.11f;
+                b[6] = white * 0.115926f;
+            }
+
+            break;
+
+        case impulseTrain:
+        {
+            const double interval = currentSampleRate / impulseRate->get();
+
+            FloatVectorOperations::clear (dest, numSamples);
+
+            while (samplesToNextImpulse < numSamples)
+            {
+                dest[(int) samplesToNextImpulse] = 1.0f;
+                samplesToNextImpulse += interval;
+            }
+
+            samplesToNextImpulse -= numSamples;
+            break;
+        }
+
+        default:
+            FloatVectorOperations::clear (dest, numSamples);
+            break;
+    }
+}
+
+//==============================================================================
+void GeneratorProcessor::renderNotes (MidiBuffer& midi, int numSamples)
+{
+    const int pattern = notePattern->getIndex();
+
+    if (pattern != currentPattern)
+    {
+        releaseHeldNotes (midi, 0);
+        currentPattern = pattern;
+        patternStep = 0;
+        samplesToNextNote = 0.0;
+    }
+
+    if (currentPattern == noNotes)
+        return;
+
+    const double samplesPerNote = currentSampleRate / noteRate->get();
+
+    while (samplesToNextNote < numSamples)
+    {
+        startNextStep (midi, (int) samplesToNextNote);
+        samplesToNextNote += samplesPerNote;
+    }
+
+    samplesToNextNote -= numSamples;
+}
+
+void GeneratorProcessor::releaseHeldNotes (MidiBuffer& midi, int samplePosition)
+{
+    for (int i = 0; i < heldNotes.size(); ++i)
+        midi.addEvent (MidiMessage::noteOff (midiChannel, heldNotes.getUnchecked (i)), samplePosition);
+
+    heldNotes.clearQuick();
+}
+
+void GeneratorProcessor::startNextStep (MidiBuffer& midi, int samplePosition)
+{
+    const int (*steps)[4] = repeatedNoteSteps;
+    int numSteps = numElementsInArray (repeatedNoteSteps);
+
+    if (currentPattern == arpeggio)
+    {
+        steps = arpeggioSteps;
+        numSteps = numElementsInArray (arpeggioSteps);
+    }
+    else if (currentPattern == chords)
+    {
+        steps = chordSteps;
+        numSteps = numElementsInArray (chordSteps);
+    }
+
+    releaseHeldNotes (midi, samplePosition);
+
+    const int* const notes = steps[patternStep % numSteps];
+
+    for (int i = 0; i < 4 && notes[i] >= 0; ++i)
+    {
+        midi.addEvent (MidiMessage::noteOn (midiChannel, notes[i], noteVelocity), samplePosition);
+        heldNotes.add (notes[i]);
+    }
+
+    patternStep = (patternStep + 1) % numSteps;
+}
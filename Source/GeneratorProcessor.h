@@ -0,0 +1,85 @@
+/*
+  ==============================================================================
+
+    GeneratorProcessor.h
+    Middle
+
+  ==============================================================================
+*/
+
+#ifndef __GENERATORPROCESSOR_JUCEHEADER__
+#define __GENERATORPROCESSOR_JUCEHEADER__
+
+#include "InternalProcessors.h"
+
+
+//==============================================================================
+/**
+    A test source: a sine, an exponential sweep, white or pink noise, or an
+    impulse train on every output channel, plus an optional repeating pattern of
+    MIDI notes.
+
+    Everything restarts from the same point in prepareToPlay(), and the noise
+    comes from a fixed seed, so two runs of the same graph produce identical
+    output - handy for comparing renders or checking a plugin chain by ear.
+*/
+class GeneratorProcessor   : public InternalPlugin
+{
+public:
+    GeneratorProcessor();
+
+    static const char* const generatorName;
+
+    enum Waveform
+    {
+        sineWave = 0,
+        sweepWave,
+        whiteNoise,
+        pinkNoise,
+        impulseTrain
+    };
+
+    enum NotePattern
+    {
+        noNotes = 0,
+        repeatedNote,
+        arpeggio,
+        chords
+    };
+
+    void prepareToPlay (double sampleRate, int maximumExpectedSamplesPerBlock) override;
+    void releaseResources() override;
+    void renderBlock (AudioBuffer<float>&, MidiBuffer&) override;
+
+    bool isBusesLayoutSupported (const BusesLayout&) const override;
+    bool producesMidi() const override                                  { return true; }
+
+private:
+    //==============================================================================
+    AudioParameterChoice* waveform;
+    AudioParameterFloat* frequency;
+    AudioParameterFloat* levelDb;
+    AudioParameterFloat* sweepSeconds;
+    AudioParameterFloat* impulseRate;
+    AudioParameterChoice* notePattern;
+    AudioParameterFloat* noteRate;
+
+    SmoothedGain level;
+    double currentSampleRate, phase, sweepPosition, samplesToNextImpulse, samplesToNextNote;
+    Random random;
+    float pinkState[7];
+
+    int currentPattern, patternStep;
+    Array<int> heldNotes;
+
+    void resetGenerators();
+    void renderSignal (float* dest, int numSamples);
+    void renderNotes (MidiBuffer&, int numSamples);
+    void releaseHeldNotes (MidiBuffer&, int samplePosition);
+    void startNextStep (MidiBuffer&, int samplePosition);
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (GeneratorProcessor)
+};
+
+
+#endif   // __GENERATORPROCESSOR_JUCEHEADER__
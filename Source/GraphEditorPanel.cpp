@@ -25,13 +25,62 @@
 #include "../JuceLibraryCode/JuceHeader.h"
 #include "GraphEditorPanel.h"
 #include "InternalFilters.h"
+#include "MeterProcessor.h"
+#include "RecorderProcessor.h"
 #include "MainHostWindow.h"
 #include "FilterIOConfiguration.h"
+#include "EmbeddedResources.h"
+#include "ProjectLibrary.h"
+#include "StallMonitor.h"
 
 //==============================================================================
 class PluginWindow;
 static Array <PluginWindow*> activePluginWindows;
 
+static int hiddenEditorTimeoutSeconds = 60;
+static const int hiddenEditorCheckIntervalMs = 500;
+
+/** True if some of the component can actually be seen: it's showing, its
+    window isn't minimised, and it hasn't been moved outside its parents, as
+    the tabs of a sliding panel are.
+*/
+static bool isComponentOnScreen (Component& c)
+{
+    if (! c.isShowing())
+        return false;
+
+    Rectangle<int> area (c.getLocalBounds());
+
+    for (Component* p = &c; p->getParentComponent() != nullptr; p = p->getParentComponent())
+    {
+        area = (area + p->getPosition()).getIntersection (p->getParentComponent()->getLocalBounds());
+
+        if (area.isEmpty())
+            return false;
+    }
+
+    return true;
+}
+
+/** Keeps track of how long something has been hidden, and returns true once
+    it's been hidden for longer than the timeout.
+*/
+static bool hasBeenHiddenTooLong (const bool isHidden, uint32& hiddenSince)
+{
+    if (! isHidden || hiddenEditorTimeoutSeconds <= 0)
+    {
+        hiddenSince = 0;
+        return false;
+    }
+
+    const uint32 now = Time::getMillisecondCounter();
+
+    if (hiddenSince == 0)
+        hiddenSince = now;
+
+    return now - hiddenSince >= (uint32) hiddenEditorTimeoutSeconds * 1000;
+}
+
 PluginWindow::PluginWindow (Component* const pluginEditor,
                             AudioProcessorGraph::Node* const o,
                             WindowFormatType t,
@@ -40,7 +89,9 @@ PluginWindow::PluginWindow (Component* const pluginEditor,
                       DocumentWindow::minimiseButton | DocumentWindow::closeButton),
       graph (audioGraph),
       owner (o),
-      type (t)
+      type (t),
+      suspended (false),
+      hiddenSince (0)
 {
     setSize (400, 300);
 
@@ -54,12 +105,32 @@ PluginWindow::PluginWindow (Component* const pluginEditor,
     setVisible (true);
 
     activePluginWindows.add (this);
+    startTimer (hiddenEditorCheckIntervalMs);
+}
+
+void PluginWindow::setHiddenEditorTimeout (const int seconds) noexcept
+{
+    hiddenEditorTimeoutSeconds = jmax (0, seconds);
+}
+
+int PluginWindow::getHiddenEditorTimeout() noexcept
+{
+    return hiddenEditorTimeoutSeconds;
+}
+
+void PluginWindow::closeCurrentlyOpenWindowsFor (AudioProcessorGraph& audioGraph, const uint32 nodeId)
+{
+    // Node IDs are only unique within one graph, and racks have graphs of their own.
+    for (int i = activePluginWindows.size(); --i >= 0;)
+        if (&activePluginWindows.getUnchecked(i)->graph == &audioGraph
+             && activePluginWindows.getUnchecked(i)->owner->nodeId == nodeId)
+            delete activePluginWindows.getUnchecked (i);
 }
 
-void PluginWindow::closeCurrentlyOpenWindowsFor (const uint32 nodeId)
+void PluginWindow::closeCurrentlyOpenWindowsFor (AudioProcessorGraph& audioGraph)
 {
     for (int i = activePluginWindows.size(); --i >= 0;)
-        if (activePluginWindows.getUnchecked(i)->owner->nodeId == nodeId)
+        if (&activePluginWindows.getUnchecked(i)->graph == &audioGraph)
             delete activePluginWindows.getUnchecked (i);
 }
 
@@ -87,7 +158,9 @@ PluginEditor::PluginEditor (Component* const pluginEditor,
 :
 graph (audioGraph),
 owner (o),
-type (t)
+type (t),
+suspended (false),
+hiddenSince (0)
 {
     
     setSize (getHeight(), getWidth());
@@ -97,12 +170,24 @@ type (t)
     setVisible (true);
     
     activePluginEditors.add (this);
+    startTimer (hiddenEditorCheckIntervalMs);
+}
+
+void PluginEditor::closePluginEditorsFor (AudioProcessorGraph& audioGraph, const uint32 nodeId)
+{
+    for (int i = activePluginEditors.size(); --i >= 0;)
+        if (&activePluginEditors.getUnchecked(i)->graph == &audioGraph
+             && activePluginEditors.getUnchecked(i)->owner->nodeId == nodeId)
+        {
+            auto processor = activePluginEditors.getUnchecked (i)->owner->getProcessor();
+            closeProcessor(processor);
+        }
 }
 
-void PluginEditor::closePluginEditorsFor (const uint32 nodeId)
+void PluginEditor::closePluginEditorsFor (AudioProcessorGraph& audioGraph)
 {
     for (int i = activePluginEditors.size(); --i >= 0;)
-        if (activePluginEditors.getUnchecked(i)->owner->nodeId == nodeId)
+        if (&activePluginEditors.getUnchecked(i)->graph == &audioGraph)
         {
             auto processor = activePluginEditors.getUnchecked (i)->owner->getProcessor();
             closeProcessor(processor);
@@ -170,11 +255,26 @@ PluginEditor* PluginEditor::getPluginEditorFor (AudioProcessorGraph::Node* const
     jassert (node != nullptr);
     
     for (int i = activePluginEditors.size(); --i >= 0;)
+    {
         if (activePluginEditors.getUnchecked(i)->owner == node
             && activePluginEditors.getUnchecked(i)->type == type)
+        {
+            activePluginEditors.getUnchecked(i)->resumeEditor();
             return activePluginEditors.getUnchecked(i);
+        }
+    }
     
     AudioProcessor* processor = node->getProcessor();
+    
+    if (AudioProcessorEditor* const ui = createEditor (processor, type))
+        return new PluginEditor (ui, node, type, audioGraph);
+    
+    return nullptr;
+}
+
+AudioProcessorEditor* PluginEditor::createEditor (AudioProcessor* const processor, WindowFormatType& type)
+{
+    const StallMonitor::ScopedActivity activity ("Opening the editor of " + processor->getName());
     AudioProcessorEditor* ui = nullptr;
     
     if (type == Normal)
@@ -196,14 +296,41 @@ PluginEditor* PluginEditor::getPluginEditorFor (AudioProcessorGraph::Node* const
     }
     
     if (ui != nullptr)
-    {
         if (AudioPluginInstance* const plugin = dynamic_cast<AudioPluginInstance*> (processor))
             ui->setName (plugin->getName());
-        
-        return new PluginEditor (ui, node, type, audioGraph);
+    
+    return ui;
+}
+
+void PluginEditor::resumeEditor()
+{
+    if (! suspended)
+        return;
+    
+    WindowFormatType t = type;
+    
+    if (AudioProcessorEditor* const ui = createEditor (owner->getProcessor(), t))
+    {
+        addAndMakeVisible (ui);
+        suspended = false;
     }
+}
+
+void PluginEditor::timerCallback()
+{
+    const bool isOnScreen = isComponentOnScreen (*this);
     
-    return nullptr;
+    if (suspended)
+    {
+        if (isOnScreen)
+            resumeEditor();
+    }
+    else if (hasBeenHiddenTooLong (! isOnScreen, hiddenSince))
+    {
+        clearContentComponent();
+        suspended = true;
+        hiddenSince = 0;
+    }
 }
 
 PluginEditor::~PluginEditor()
@@ -303,11 +430,29 @@ PluginWindow* PluginWindow::getWindowFor (AudioProcessorGraph::Node* const node,
     jassert (node != nullptr);
 
     for (int i = activePluginWindows.size(); --i >= 0;)
+    {
         if (activePluginWindows.getUnchecked(i)->owner == node
              && activePluginWindows.getUnchecked(i)->type == type)
+        {
+            activePluginWindows.getUnchecked(i)->resumeEditor();
             return activePluginWindows.getUnchecked(i);
+        }
+    }
 
     AudioProcessor* processor = node->getProcessor();
+
+    if (AudioProcessorEditor* const ui = createEditor (processor, type))
+    {
+		if (ui->getName() != "Recorder")
+        return new PluginWindow (ui, node, type, audioGraph);
+    }
+
+    return nullptr;
+}
+
+AudioProcessorEditor* PluginWindow::createEditor (AudioProcessor* const processor, WindowFormatType& type)
+{
+    const StallMonitor::ScopedActivity activity ("Opening the editor of " + processor->getName());
     AudioProcessorEditor* ui = nullptr;
 
     if (type == Normal)
@@ -329,14 +474,58 @@ PluginWindow* PluginWindow::getWindowFor (AudioProcessorGraph::Node* const node,
     }
 
     if (ui != nullptr)
-    {
         if (AudioPluginInstance* const plugin = dynamic_cast<AudioPluginInstance*> (processor))
             ui->setName (plugin->getName());
-		if (ui->getName() != "Recorder")
-        return new PluginWindow (ui, node, type, audioGraph);
+
+    return ui;
+}
+
+void PluginWindow::suspendEditor()
+{
+    // A bare placeholder the same size keeps the window's layout while it's minimised.
+    Component* const placeholder = new Component();
+
+    if (Component* const content = getContentComponent())
+        placeholder->setSize (content->getWidth(), content->getHeight());
+
+    setContentOwned (placeholder, false);
+    suspended = true;
+    hiddenSince = 0;
+}
+
+void PluginWindow::resumeEditor()
+{
+    if (! suspended)
+        return;
+
+    WindowFormatType t = type;
+
+    if (AudioProcessorEditor* const ui = createEditor (owner->getProcessor(), t))
+    {
+        setContentOwned (ui, true);
+        suspended = false;
     }
+}
 
-    return nullptr;
+void PluginWindow::minimisationStateChanged (const bool isNowMinimised)
+{
+    DocumentWindow::minimisationStateChanged (isNowMinimised);
+
+    if (! isNowMinimised)
+        resumeEditor();
+}
+
+void PluginWindow::timerCallback()
+{
+    if (suspended)
+    {
+        if (isComponentOnScreen (*this))
+            resumeEditor();
+    }
+    else if (hasBeenHiddenTooLong (! isComponentOnScreen (*this), hiddenSince))
+    {
+        suspendEditor();
+    }
 }
 
 PluginWindow::~PluginWindow()
@@ -462,15 +651,10 @@ public:
           filterID (filterID_),
           numInputs (0),
           numOutputs (0),
-          pinSize (16),
-          font (13.0f),
-          numIns (0),
-          numOuts (0)
+          meterDisplay (nullptr),
+          bodyImageScale (0.0f),
+          bodyImageTextBottom (0)
     {
-
-        shadow.setShadowProperties (DropShadow (Colours::lightgrey, 3, Point<int> (0, 1)));
-        setComponentEffect (&shadow);
-
         setSize (150, 60);
     }
 
@@ -481,7 +665,7 @@ public:
 
     void mouseDown (const MouseEvent& e) override
     {
-        originalPos = localPointToGlobal (Point<int>());
+        originalCentre = getBounds().getCentre();
 
         toFront (true);
 
@@ -548,16 +732,12 @@ public:
     {
         if (! e.mods.isPopupMenu())
         {
-            Point<int> pos (originalPos + Point<int> (e.getDistanceFromDragStartX(), e.getDistanceFromDragStartY()));
+            // The drag offset is in this component's own coordinates, which are the canvas's.
+            const Point<double> pos (GraphEditorPanel::canvasToPosition (originalCentre + e.getOffsetFromDragStart()));
 
-            if (getParentComponent() != nullptr)
-                pos = getParentComponent()->getLocalPoint (nullptr, pos);
+            graph.setNodePosition (filterID, pos.x, pos.y);
 
-            graph.setNodePosition (filterID,
-                                   (pos.getX() + getWidth() / 2) / (double) getParentWidth(),
-                                   (pos.getY() + getHeight() / 2) / (double) getParentHeight());
-
-            getGraphPanel()->updateComponents();
+            getGraphPanel()->updateComponentsFor (filterID);
         }
     }
 
@@ -586,24 +766,62 @@ public:
 
     void paint (Graphics& g) override
     {
-        g.setColour (findColour (mainAccentColourId).withAlpha(0.7f));
+        const float scale = g.getInternalContext().getPhysicalPixelScaleFactor();
+        const Colour accent (findColour (mainAccentColourId));
+        const int textBottom = meterDisplay != nullptr ? meterDisplay->getY() : 0;
+
+        // Moving the node just blits this; it's only redrawn when something in it changes.
+        if (bodyImage.isNull()
+             || bodyImage.getWidth()  != roundToInt (getWidth()  * scale)
+             || bodyImage.getHeight() != roundToInt (getHeight() * scale)
+             || scale != bodyImageScale
+             || accent != bodyImageColour
+             || textBottom != bodyImageTextBottom
+             || getName() != bodyImageName)
+        {
+            renderBodyImage (scale, accent, textBottom);
+        }
+
+        g.drawImageTransformed (bodyImage, AffineTransform::scale (1.0f / scale));
+    }
+
+    /** Draws the box, its shadow and its name into bodyImage, at the screen's pixel scale. */
+    void renderBodyImage (const float scale, const Colour accent, const int textBottom)
+    {
+        bodyImage = Image (Image::ARGB, jmax (1, roundToInt (getWidth() * scale)),
+                                        jmax (1, roundToInt (getHeight() * scale)), true);
+        bodyImageScale = scale;
+        bodyImageColour = accent;
+        bodyImageTextBottom = textBottom;
+        bodyImageName = getName();
+
+        Graphics g (bodyImage);
+        g.addTransform (AffineTransform::scale (scale));
 
         const int x = 4;
         const int y = pinSize;
         const int w = getWidth() - x * 2;
         const int h = getHeight() - pinSize * 2;
 
-        g.fillRoundedRectangle (x, y, w, h, 10);
+        Path outline;
+        outline.addRoundedRectangle ((float) x, (float) y, (float) w, (float) h, 10.0f);
+
+        DropShadow (Colours::lightgrey, 3, Point<int> (0, 1)).drawForPath (g, outline);
+
+        g.setColour (accent.withAlpha(0.7f));
+        g.fillPath (outline);
 
         g.setColour (Colours::white);
-        typeface = Typeface::createSystemTypefaceFor(BinaryData::quicksand_regular_ttf, BinaryData::quicksand_regular_ttf_Size);
-        Font fontCustom(typeface);
-        fontCustom.setHeight(13.0f);
-        g.setFont (fontCustom);
-        g.drawFittedText (getName(), getLocalBounds().reduced (4, 2), Justification::centred, 2);
 
-        g.setColour (findColour (mainAccentColourId));
-        g.drawRoundedRectangle (x, y, w, h, 10, 1.35f);
+        g.setFont (EmbeddedResources::getUIFont (13.0f));
+
+        if (textBottom > 0)
+            g.drawFittedText (getName(), x, y, w, textBottom - y, Justification::centred, 1);
+        else
+            g.drawFittedText (getName(), getLocalBounds().reduced (4, 2), Justification::centred, 2);
+
+        g.setColour (accent);
+        g.strokePath (outline, PathStrokeType (1.35f));
     }
 
     void resized() override
@@ -613,118 +831,149 @@ public:
             if (AudioProcessor* const processor = f->getProcessor())
             {
                 for (int i = 0; i < getNumChildComponents(); ++i)
-                {
                     if (PinComponent* const pc = dynamic_cast<PinComponent*> (getChildComponent(i)))
-                    {
-                        const bool isInput = pc->isInput;
-                        int busIdx, channelIdx;
-
-                        channelIdx =
-                            processor->getOffsetInBusBufferForAbsoluteChannelIndex (isInput, pc->index, busIdx);
-
-                        const int total = isInput ? numIns : numOuts;
-                        const int index = pc->index == FilterGraph::midiChannelNumber ? (total - 1) : pc->index;
-
-                        const float totalSpaces = static_cast<float> (total) + (static_cast<float> (jmax (0, processor->getBusCount (isInput) - 1)) * 0.5f);
-                        const float indexPos = static_cast<float> (index) + (static_cast<float> (busIdx) * 0.5f);
-
-                        pc->setBounds (proportionOfWidth ((1.0f + indexPos) / (totalSpaces + 1.0f)) - pinSize / 2,
-                                       pc->isInput ? 0 : (getHeight() - pinSize),
-                                       pinSize, pinSize);
-                    }
-                }
+                        pc->setBounds (getPinBounds (*processor, pc->index, pc->isInput, getWidth(), getHeight()));
             }
         }
+
+        if (meterDisplay != nullptr)
+            meterDisplay->setBounds (12, pinSize + 20, getWidth() - 24, getHeight() - pinSize * 2 - 26);
     }
 
-    void getPinPos (const int index, const bool isInput, float& x, float& y)
+    //==============================================================================
+    /** The number of pins on one side of a node's box, counting its midi pin. */
+    static int getNumPins (const AudioProcessor& processor, const bool isInput)
     {
-        for (int i = 0; i < getNumChildComponents(); ++i)
-        {
-            if (PinComponent* const pc = dynamic_cast<PinComponent*> (getChildComponent(i)))
-            {
-                if (pc->index == index && isInput == pc->isInput)
-                {
-                    x = getX() + pc->getX() + pc->getWidth() * 0.5f;
-                    y = getY() + pc->getY() + pc->getHeight() * 0.5f;
-                    break;
-                }
-            }
-        }
+        return isInput ? processor.getTotalNumInputChannels()  + (processor.acceptsMidi()   ? 1 : 0)
+                       : processor.getTotalNumOutputChannels() + (processor.producesMidi()  ? 1 : 0);
     }
 
-    void update()
+    /** The width of a node's name in the font its box is painted with. */
+    static int getTitleWidth (const String& name)
     {
-        const AudioProcessorGraph::Node::Ptr f (graph.getNodeForId (filterID));
-
-        if (f == nullptr)
-        {
-            delete this;
-            return;
-        }
-
-        numIns = f->getProcessor()->getTotalNumInputChannels();
-        if (f->getProcessor()->acceptsMidi())
-            ++numIns;
-
-        numOuts = f->getProcessor()->getTotalNumOutputChannels();
-        if (f->getProcessor()->producesMidi())
-            ++numOuts;
+        return EmbeddedResources::getUIFont (13.0f).getStringWidth (name);
+    }
 
+    /** Where a node's box goes on the canvas. The panel uses this to lay out the
+        nodes that have no component, so it mustn't depend on one, and it passes
+        in the title width and meter flag that it caches for each node.
+    */
+    static Rectangle<int> getBoundsFor (AudioProcessorGraph::Node& f, const int numIns, const int numOuts,
+                                        const int titleWidth, const bool isMeter)
+    {
         int w = 100;
         int h = 60;
 
         w = jmax (w, (jmax (numIns, numOuts) + 1) * 20);
 
-        const int textWidth = font.getStringWidth (f->getProcessor()->getName());
-        w = jmax (w, 16 + jmin (textWidth, 300));
-        if (textWidth > 300)
+        w = jmax (w, 16 + jmin (titleWidth, 300));
+        if (titleWidth > 300)
             h = 100;
 
-        setSize (w, h);
+        if (isMeter)
+            h = jmax (h, 110);
+
+        return Rectangle<int> (w, h).withCentre (GraphEditorPanel::positionToCanvas (FilterGraph::getNodePosition (f)));
+    }
 
-        setName (f->getProcessor()->getName());
+    /** Where a pin sits in a box of the given size. */
+    static Rectangle<int> getPinBounds (AudioProcessor& processor, const int channel, const bool isInput,
+                                        const int width, const int height)
+    {
+        int busIdx = 0;
+        processor.getOffsetInBusBufferForAbsoluteChannelIndex (isInput, channel, busIdx);
 
-        {
-            Point<double> p = graph.getNodePosition (filterID);
-            setCentreRelative ((float) p.x, (float) p.y);
-        }
+        const int total = getNumPins (processor, isInput);
+        const int index = channel == FilterGraph::midiChannelNumber ? (total - 1) : channel;
+
+        const float totalSpaces = static_cast<float> (total) + (static_cast<float> (jmax (0, processor.getBusCount (isInput) - 1)) * 0.5f);
+        const float indexPos = static_cast<float> (index) + (static_cast<float> (busIdx) * 0.5f);
+
+        return Rectangle<int> (roundToInt (width * (1.0f + indexPos) / (totalSpaces + 1.0f)) - pinSize / 2,
+                               isInput ? 0 : (height - pinSize),
+                               pinSize, pinSize);
+    }
+
+    //==============================================================================
+    /** Refreshes the box from its node, and returns true if it moved or its pins changed. */
+    bool update (AudioProcessorGraph::Node& f, const Rectangle<int>& newBounds)
+    {
+        const Rectangle<int> oldBounds (getBounds());
+        bool pinsChanged = false;
+
+        const int numIns = getNumPins (*f.getProcessor(), true);
+        const int numOuts = getNumPins (*f.getProcessor(), false);
+        MeterProcessor* const meter = dynamic_cast<MeterProcessor*> (f.getProcessor());
+
+        // The id may now belong to a different processor, whose meter (or lack of
+        // one) has to replace the old one even if the pins look just the same.
+        AudioProcessorGraph::Node* const nodeToMeter = meter != nullptr ? &f : nullptr;
+
+        setBounds (newBounds);
+        setName (f.getProcessor()->getName());
 
-        if (numIns != numInputs || numOuts != numOutputs)
+        if (numIns != numInputs || numOuts != numOutputs || meteredNode != nodeToMeter)
         {
             numInputs = numIns;
             numOutputs = numOuts;
 
             deleteAllChildren();
+            meterDisplay = nullptr;
+            meteredNode = nodeToMeter;
 
             int i;
-            for (i = 0; i < f->getProcessor()->getTotalNumInputChannels(); ++i)
+            for (i = 0; i < f.getProcessor()->getTotalNumInputChannels(); ++i)
                 addAndMakeVisible (new PinComponent (graph, filterID, i, true));
 
-            if (f->getProcessor()->acceptsMidi())
+            if (f.getProcessor()->acceptsMidi())
                 addAndMakeVisible (new PinComponent (graph, filterID, FilterGraph::midiChannelNumber, true));
 
-            for (i = 0; i < f->getProcessor()->getTotalNumOutputChannels(); ++i)
+            for (i = 0; i < f.getProcessor()->getTotalNumOutputChannels(); ++i)
                 addAndMakeVisible (new PinComponent (graph, filterID, i, false));
 
-            if (f->getProcessor()->producesMidi())
+            if (f.getProcessor()->producesMidi())
                 addAndMakeVisible (new PinComponent (graph, filterID, FilterGraph::midiChannelNumber, false));
 
+            // Meter nodes show their levels right on the box, so many channels can
+            // be watched without opening any plugin windows.
+            if (meter != nullptr)
+            {
+                addAndMakeVisible (meterDisplay = new LevelMeterComponent (*meter));
+                meterDisplay->setInterceptsMouseClicks (false, false);
+            }
+
             resized();
+            pinsChanged = true;
         }
+
+        return pinsChanged || getBounds() != oldBounds;
     }
 
     FilterGraph& graph;
     const uint32 filterID;
     int numInputs, numOutputs;
 
+    /** Where each pin was filed in the panel's pin index, so it can be taken out again. */
+    struct IndexedPin
+    {
+        PinComponent* pin;
+        Rectangle<int> bounds;
+    };
+
+    Array<IndexedPin> indexedPins;
+
+    enum { pinSize = 16 };
+
 private:
-    int pinSize;
-    Point<int> originalPos;
-    ReferenceCountedObjectPtr<Typeface> typeface;
-    Font font;
-    int numIns, numOuts;
-    DropShadowEffect shadow;
+    Point<int> originalCentre;
+    Component* meterDisplay;
+    AudioProcessorGraph::Node::Ptr meteredNode;
+
+    Image bodyImage;
+    float bodyImageScale;
+    Colour bodyImageColour;
+    String bodyImageName;
+    int bodyImageTextBottom;
 
     GraphEditorPanel* getGraphPanel() const noexcept
     {
@@ -736,42 +985,80 @@ private:
 };
 
 //==============================================================================
+/** Builds the stroked curve and arrow for a connection between two points, and
+    optionally a wider outline of it to hit-test against.
+*/
+static void createConnectorPaths (const Point<float> start, const Point<float> end,
+                                  Path& linePath, Path* const hitPath)
+{
+    Path curve;
+    curve.startNewSubPath (start);
+    curve.cubicTo (start.x, start.y + (end.y - start.y) * 0.33f,
+                   end.x,   start.y + (end.y - start.y) * 0.66f,
+                   end.x,   end.y);
+
+    if (hitPath != nullptr)
+    {
+        PathStrokeType wideStroke (8.0f);
+        wideStroke.createStrokedPath (*hitPath, curve);
+    }
+
+    PathStrokeType stroke (2.5f);
+    stroke.createStrokedPath (linePath, curve);
+
+    const float arrowW = 5.0f;
+    const float arrowL = 4.0f;
+
+    Path arrow;
+    arrow.addTriangle (-arrowL, arrowW,
+                       -arrowL, -arrowW,
+                       arrowL, 0.0f);
+
+    arrow.applyTransform (AffineTransform()
+                            .rotated (float_Pi * 0.5f - (float) atan2 (end.x - start.x, end.y - start.y))
+                            .translated ((start.x + end.x) * 0.5f,
+                                         (start.y + end.y) * 0.5f));
+
+    linePath.addPath (arrow);
+    linePath.setUsingNonZeroWinding (true);
+}
+
+//==============================================================================
+/**
+    The loose wire that follows the mouse while a connection is being dragged.
+    Connections that already exist are all drawn by the panel's ConnectorLayer.
+
+    Like the nodes, it's laid out in canvas coordinates and shown through the
+    panel's view transform.
+*/
 class ConnectorComponent   : public Component,
                              public SettableTooltipClient
 {
 public:
-    ConnectorComponent (FilterGraph& graph_)
+    ConnectorComponent()
         : sourceFilterID (0),
           destFilterID (0),
           sourceFilterChannel (0),
           destFilterChannel (0),
-          graph (graph_),
           lastInputX (0),
           lastInputY (0),
           lastOutputX (0),
           lastOutputY (0)
     {
         setAlwaysOnTop (true);
+        setInterceptsMouseClicks (false, false);
     }
 
     void setInput (const uint32 sourceFilterID_, const int sourceFilterChannel_)
     {
-        if (sourceFilterID != sourceFilterID_ || sourceFilterChannel != sourceFilterChannel_)
-        {
-            sourceFilterID = sourceFilterID_;
-            sourceFilterChannel = sourceFilterChannel_;
-            update();
-        }
+        sourceFilterID = sourceFilterID_;
+        sourceFilterChannel = sourceFilterChannel_;
     }
 
     void setOutput (const uint32 destFilterID_, const int destFilterChannel_)
     {
-        if (destFilterID != destFilterID_ || destFilterChannel != destFilterChannel_)
-        {
-            destFilterID = destFilterID_;
-            destFilterChannel = destFilterChannel_;
-            update();
-        }
+        destFilterID = destFilterID_;
+        destFilterChannel = destFilterChannel_;
     }
 
     void dragStart (int x, int y)
@@ -788,20 +1075,6 @@ public:
         resizeToFit();
     }
 
-    void update()
-    {
-        float x1, y1, x2, y2;
-        getPoints (x1, y1, x2, y2);
-
-        if (lastInputX != x1
-             || lastInputY != y1
-             || lastOutputX != x2
-             || lastOutputY != y2)
-        {
-            resizeToFit();
-        }
-    }
-
     void resizeToFit()
     {
         float x1, y1, x2, y2;
@@ -829,11 +1102,19 @@ public:
 
         if (GraphEditorPanel* const hostPanel = getGraphPanel())
         {
-            if (FilterComponent* srcFilterComp = hostPanel->getComponentForFilter (sourceFilterID))
-                srcFilterComp->getPinPos (sourceFilterChannel, false, x1, y1);
+            Point<float> pos;
+
+            if (hostPanel->getPinPosition (sourceFilterID, sourceFilterChannel, false, pos))
+            {
+                x1 = pos.x;
+                y1 = pos.y;
+            }
 
-            if (FilterComponent* dstFilterComp = hostPanel->getComponentForFilter (destFilterID))
-                dstFilterComp->getPinPos (destFilterChannel, true, x2, y2);
+            if (hostPanel->getPinPosition (destFilterID, destFilterChannel, true, pos))
+            {
+                x2 = pos.x;
+                y2 = pos.y;
+            }
         }
     }
 
@@ -852,55 +1133,6 @@ public:
         g.fillPath (linePath);
     }
 
-    bool hitTest (int x, int y) override
-    {
-        if (hitPath.contains ((float) x, (float) y))
-        {
-            double distanceFromStart, distanceFromEnd;
-            getDistancesFromEnds (x, y, distanceFromStart, distanceFromEnd);
-
-            // avoid clicking the connector when over a pin
-            return distanceFromStart > 7.0 && distanceFromEnd > 7.0;
-        }
-
-        return false;
-    }
-
-    void mouseDown (const MouseEvent&) override
-    {
-        dragging = false;
-    }
-
-    void mouseDrag (const MouseEvent& e) override
-    {
-        if (dragging)
-        {
-            getGraphPanel()->dragConnector (e);
-        }
-        else if (e.mouseWasDraggedSinceMouseDown())
-        {
-            dragging = true;
-
-            graph.removeConnection (sourceFilterID, sourceFilterChannel, destFilterID, destFilterChannel);
-
-            double distanceFromStart, distanceFromEnd;
-            getDistancesFromEnds (e.x, e.y, distanceFromStart, distanceFromEnd);
-            const bool isNearerSource = (distanceFromStart < distanceFromEnd);
-
-            getGraphPanel()->beginConnectorDrag (isNearerSource ? 0 : sourceFilterID,
-                                                 sourceFilterChannel,
-                                                 isNearerSource ? destFilterID : 0,
-                                                 destFilterChannel,
-                                                 e);
-        }
-    }
-
-    void mouseUp (const MouseEvent& e) override
-    {
-        if (dragging)
-            getGraphPanel()->endDraggingConnector (e);
-    }
-
     void resized() override
     {
         float x1, y1, x2, y2;
@@ -911,71 +1143,464 @@ public:
         lastOutputX = x2;
         lastOutputY = y2;
 
-        x1 -= getX();
-        y1 -= getY();
-        x2 -= getX();
-        y2 -= getY();
-
         linePath.clear();
-        linePath.startNewSubPath (x1, y1);
-        linePath.cubicTo (x1, y1 + (y2 - y1) * 0.33f,
-                          x2, y1 + (y2 - y1) * 0.66f,
-                          x2, y2);
-
-        PathStrokeType wideStroke (8.0f);
-        wideStroke.createStrokedPath (hitPath, linePath);
-
-        PathStrokeType stroke (2.5f);
-        stroke.createStrokedPath (linePath, linePath);
-
-        const float arrowW = 5.0f;
-        const float arrowL = 4.0f;
-
-        Path arrow;
-        arrow.addTriangle (-arrowL, arrowW,
-                           -arrowL, -arrowW,
-                           arrowL, 0.0f);
-
-        arrow.applyTransform (AffineTransform()
-                                .rotated (float_Pi * 0.5f - (float) atan2 (x2 - x1, y2 - y1))
-                                .translated ((x1 + x2) * 0.5f,
-                                             (y1 + y2) * 0.5f));
-
-        linePath.addPath (arrow);
-        linePath.setUsingNonZeroWinding (true);
+        createConnectorPaths (Point<float> (x1 - getX(), y1 - getY()),
+                              Point<float> (x2 - getX(), y2 - getY()),
+                              linePath, nullptr);
     }
 
     uint32 sourceFilterID, destFilterID;
     int sourceFilterChannel, destFilterChannel;
 
 private:
-    FilterGraph& graph;
     float lastInputX, lastInputY, lastOutputX, lastOutputY;
-    Path linePath, hitPath;
-    bool dragging;
+    Path linePath;
 
     GraphEditorPanel* getGraphPanel() const noexcept
     {
         return findParentComponentOfClass<GraphEditorPanel>();
     }
 
-    void getDistancesFromEnds (int x, int y, double& distanceFromStart, double& distanceFromEnd) const
-    {
-        float x1, y1, x2, y2;
-        getPoints (x1, y1, x2, y2);
-
-        distanceFromStart = juce_hypot (x - (x1 - getX()), y - (y1 - getY()));
-        distanceFromEnd = juce_hypot (x - (x2 - getX()), y - (y2 - getY()));
-    }
-
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (ConnectorComponent)
 };
 
-
+//==============================================================================
+/**
+    Draws every connection in the graph from one transparent component that sits
+    over the whole panel.
+
+    Each wire keeps its stroked path, and is only rebuilt when one of its ends
+    moves. The wires are also filed in a coarse grid of cells, so painting only
+    visits the ones that cross the area being redrawn, and a mouse position can
+    be hit-tested against the handful of wires that pass through its cell.
+
+    While the panel is showing, each wire is also tinted by the signal leaving
+    its source: the RMS level of its channel for audio, or how busy the midi is.
+    The levels come from the nodes' SignalTaps and are looked at 30 times a
+    second, and a wire is only repainted when its shade actually changes.
+
+    The wires are kept in canvas coordinates and drawn through the panel's view
+    transform. Below the detail zoom they're drawn as plain lines, and can't be
+    picked up, as there are no pins to drop them on.
+*/
+class GraphEditorPanel::ConnectorLayer   : public Component,
+                                           private Timer
+{
+public:
+    ConnectorLayer (GraphEditorPanel& p)
+        : panel (p), grid (cellSize), paintStamp (0), dragging (false),
+          pressedWire (0, 0, 0, 0)
+    {
+        setAlwaysOnTop (true);
+    }
+
+    //==============================================================================
+    int getNumWires() const noexcept                                     { return wires.size(); }
+    bool containsWire (const ConnectionKey& key) const                   { return wiresByKey.contains (key); }
+
+    void addWire (const ConnectionKey& key)
+    {
+        Wire* const w = wires.add (new Wire (key));
+        wiresByKey.set (key, w);
+        updateWire (*w, true);
+
+        if (! isTimerRunning())
+            startTimerHz (30);
+    }
+
+    void removeWire (const ConnectionKey& key)
+    {
+        if (Wire* const w = wiresByKey [key])
+        {
+            grid.remove (w, w->bounds);
+            repaintWire (*w);
+            wiresByKey.remove (key);
+            wires.removeObject (w);
+
+            if (wires.size() == 0)
+                stopTimer();
+        }
+    }
+
+    /** Drops the wires whose connections are no longer in the graph. */
+    void removeDeletedWires (const FilterGraph& graph)
+    {
+        Array<ConnectionKey> deadKeys;
+
+        for (int i = 0; i < wires.size(); ++i)
+        {
+            const ConnectionKey& key = wires.getUnchecked (i)->key;
+
+            if (graph.getConnectionBetween (key.sourceNodeId, key.sourceChannelIndex,
+                                            key.destNodeId, key.destChannelIndex) == nullptr)
+                deadKeys.add (key);
+        }
+
+        for (int i = 0; i < deadKeys.size(); ++i)
+            removeWire (deadKeys.getReference (i));
+    }
+
+    /** Rebuilds the wires that start or end on any of these filters. */
+    void updateWiresAttachedTo (const SortedSet<uint32>& filterIDs)
+    {
+        for (int i = 0; i < wires.size(); ++i)
+        {
+            Wire& w = *wires.getUnchecked (i);
+
+            if (filterIDs.contains (w.key.sourceNodeId) || filterIDs.contains (w.key.destNodeId))
+                updateWire (w, false);
+        }
+    }
+
+    //==============================================================================
+    void paint (Graphics& g) override
+    {
+        g.addTransform (panel.getViewTransform());
+
+        WirePainter painter (g, findColour (mainBackgroundColourId).contrasting().withAlpha (0.5f),
+                             findColour (mainAccentColourId).withAlpha (0.5f), ++paintStamp,
+                             panel.isShowingDetail() ? 0.0f : 1.0f / panel.getZoom());
+
+        grid.visitItemsIn (painter.clip, painter);
+    }
+
+    bool hitTest (int x, int y) override
+    {
+        return panel.isShowingDetail()
+                && getWireAt (panel.viewToCanvas (Point<float> ((float) x, (float) y))) != nullptr;
+    }
+
+    //==============================================================================
+    void mouseDown (const MouseEvent& e) override
+    {
+        dragging = false;
+
+        if (const Wire* const w = getWireAt (panel.viewToCanvas (e.position)))
+            pressedWire = w->key;
+    }
+
+    void mouseDrag (const MouseEvent& e) override
+    {
+        if (dragging)
+        {
+            panel.dragConnector (e);
+        }
+        else if (e.mouseWasDraggedSinceMouseDown() && wiresByKey.contains (pressedWire))
+        {
+            dragging = true;
+
+            const Wire& w = *wiresByKey [pressedWire];
+            const Point<float> pos (panel.viewToCanvas (e.position));
+            const bool isNearerSource = pos.getDistanceFrom (w.start) < pos.getDistanceFrom (w.end);
+            const ConnectionKey key (pressedWire);
+
+            removeWire (key);
+            panel.graph.removeConnection (key.sourceNodeId, key.sourceChannelIndex,
+                                          key.destNodeId, key.destChannelIndex);
+
+            panel.beginConnectorDrag (isNearerSource ? 0 : key.sourceNodeId,
+                                      key.sourceChannelIndex,
+                                      isNearerSource ? key.destNodeId : 0,
+                                      key.destChannelIndex,
+                                      e);
+        }
+    }
+
+    void mouseUp (const MouseEvent& e) override
+    {
+        if (dragging)
+            panel.endDraggingConnector (e);
+
+        dragging = false;
+    }
+
+private:
+    //==============================================================================
+    struct Wire
+    {
+        Wire (const ConnectionKey& k) noexcept
+            : key (k), paintStamp (0), tap (nullptr),
+              lastNumBlocks (0), lastCount (0), level (0.0f), clipHold (0), shade (0)
+        {}
+
+        bool isMidi() const noexcept
+        {
+            return key.sourceChannelIndex == FilterGraph::midiChannelNumber
+                    || key.destChannelIndex == FilterGraph::midiChannelNumber;
+        }
+
+        const ConnectionKey key;
+        Point<float> start, end;
+        Path linePath, hitPath;
+        Rectangle<int> bounds;
+        uint32 paintStamp;
+
+        // Only compared with the source's current tap, to notice when the id has been
+        // given to a new node; it's never read through, as it may have been deleted.
+        const SignalTap* tap;
+        uint32 lastNumBlocks, lastCount;
+        float level;
+        int clipHold, shade;
+    };
+
+    enum { numShades = 16, clippedShade = numShades + 1 };
+
+    /** Draws each wire that crosses the clip region, once. Given a line width, it
+        draws each one as a straight line of that width, rather than its curve.
+    */
+    struct WirePainter
+    {
+        WirePainter (Graphics& graphics, Colour audio, Colour midi, uint32 stamp, float simpleLineWidth)
+            : g (graphics), clip (graphics.getClipBounds()),
+              audioColour (audio), midiColour (midi), paintStamp (stamp), lineWidth (simpleLineWidth)
+        {}
+
+        Colour getColourFor (const Wire& w) const
+        {
+            if (w.shade == clippedShade)
+                return Colour (0xffe0473c);
+
+            if (w.isMidi())
+                return midiColour.interpolatedWith (midiColour.withAlpha (1.0f), w.shade / (float) numShades);
+
+            return audioColour.interpolatedWith (Colour (0xff4fc46a), w.shade / (float) numShades);
+        }
+
+        void operator() (Wire* w) const
+        {
+            // Long wires are filed in many cells, but only need drawing once.
+            if (w->paintStamp == paintStamp || ! w->bounds.intersects (clip))
+                return;
+
+            w->paintStamp = paintStamp;
+            g.setColour (getColourFor (*w));
+
+            if (lineWidth > 0.0f)
+                g.drawLine (Line<float> (w->start, w->end), lineWidth);
+            else
+                g.fillPath (w->linePath);
+        }
+
+        Graphics& g;
+        const Rectangle<int> clip;
+        const Colour audioColour, midiColour;
+        const uint32 paintStamp;
+        const float lineWidth;
+    };
+
+    enum { cellSize = 64 };
+
+    GraphEditorPanel& panel;
+    OwnedArray<Wire> wires;
+    HashMap<ConnectionKey, Wire*, KeyHashFunctions> wiresByKey;
+    SpatialGrid<Wire*> grid;
+    uint32 paintStamp;
+    bool dragging;
+    ConnectionKey pressedWire;
+
+    //==============================================================================
+    void timerCallback() override
+    {
+        if (! isShowing())
+            return;
+
+        for (int i = 0; i < wires.size(); ++i)
+        {
+            Wire& w = *wires.getUnchecked (i);
+
+            // The tap is looked up afresh each time, as loading a project or undoing
+            // can swap every node for a new one with the same id.
+            const SignalTap* const tap = panel.getOutputTapFor (w.key.sourceNodeId);
+
+            if (tap == nullptr)
+                continue;
+
+            if (tap != w.tap)
+            {
+                w.tap = tap;
+                w.lastNumBlocks = tap->getNumBlocks();
+                w.lastCount = w.isMidi() ? tap->getNumMidiEvents()
+                                         : tap->getNumClips (w.key.sourceChannelIndex);
+            }
+
+            const uint32 numBlocks = tap->getNumBlocks();
+            const bool isLive = numBlocks != w.lastNumBlocks;
+            w.lastNumBlocks = numBlocks;
+
+            float target = 0.0f;
+            bool clipped = false;
+
+            if (w.isMidi())
+            {
+                const uint32 numEvents = tap->getNumMidiEvents();
+                target = jmin (1.0f, (numEvents - w.lastCount) / 4.0f);
+                w.lastCount = numEvents;
+            }
+            else if (isLive)
+            {
+                // -60 dB and below shows as dead, 0 dB as fully lit.
+                const float db = Decibels::gainToDecibels (tap->getRmsLevel (w.key.sourceChannelIndex), -60.0f);
+                target = (db + 60.0f) / 60.0f;
+
+                const uint32 numClips = tap->getNumClips (w.key.sourceChannelIndex);
+                clipped = numClips != w.lastCount;
+                w.lastCount = numClips;
+            }
+
+            // Rise straight away, but fall over about half a second.
+            w.level = jmax (target, w.level - 0.07f);
+            w.clipHold = clipped ? 30 : jmax (0, w.clipHold - 1);
+
+            const int shade = w.clipHold > 0 ? (int) clippedShade : roundToInt (w.level * numShades);
+
+            if (shade != w.shade)
+            {
+                w.shade = shade;
+                repaintWire (w);
+            }
+        }
+    }
+
+    void repaintWire (const Wire& w)
+    {
+        repaint (panel.canvasToView (w.bounds));
+    }
+
+    void updateWire (Wire& w, const bool isNew)
+    {
+        Point<float> start (w.start), end (w.end);
+
+        panel.getPinPosition (w.key.sourceNodeId, w.key.sourceChannelIndex, false, start);
+        panel.getPinPosition (w.key.destNodeId, w.key.destChannelIndex, true, end);
+
+        if (! isNew && start == w.start && end == w.end)
+            return;
+
+        if (! isNew)
+        {
+            grid.remove (&w, w.bounds);
+            repaintWire (w);
+        }
+
+        w.start = start;
+        w.end = end;
+        w.linePath.clear();
+        w.hitPath.clear();
+        createConnectorPaths (start, end, w.linePath, &w.hitPath);
+        w.bounds = w.hitPath.getBounds().getSmallestIntegerContainer().expanded (1);
+
+        grid.add (&w, w.bounds);
+        repaintWire (w);
+    }
+
+    const Wire* getWireAt (const Point<float> pos) const
+    {
+        const Array<Wire*>* const nearby = grid.getItemsNear (Point<int> ((int) std::floor (pos.x), (int) std::floor (pos.y)));
+
+        if (nearby == nullptr)
+            return nullptr;
+
+        for (int i = nearby->size(); --i >= 0;)
+        {
+            const Wire& w = *nearby->getUnchecked (i);
+
+            // Leave the ends of each wire to the pins underneath them.
+            if (w.hitPath.contains (pos)
+                 && pos.getDistanceFrom (w.start) > 7.0f
+                 && pos.getDistanceFrom (w.end) > 7.0f)
+                return &w;
+        }
+
+        return nullptr;
+    }
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (ConnectorLayer)
+};
+
+
+//==============================================================================
+GraphEditorPanel::ConnectionKey::ConnectionKey (uint32 sourceId, int sourceChannel, uint32 destId, int destChannel) noexcept
+    : sourceNodeId (sourceId), destNodeId (destId),
+      sourceChannelIndex (sourceChannel), destChannelIndex (destChannel)
+{
+}
+
+GraphEditorPanel::ConnectionKey::ConnectionKey (const AudioProcessorGraph::Connection& c) noexcept
+    : sourceNodeId (c.sourceNodeId), destNodeId (c.destNodeId),
+      sourceChannelIndex (c.sourceChannelIndex), destChannelIndex (c.destChannelIndex)
+{
+}
+
+bool GraphEditorPanel::ConnectionKey::operator== (const ConnectionKey& other) const noexcept
+{
+    return sourceNodeId == other.sourceNodeId && destNodeId == other.destNodeId
+            && sourceChannelIndex == other.sourceChannelIndex && destChannelIndex == other.destChannelIndex;
+}
+
+int GraphEditorPanel::KeyHashFunctions::generateHash (const uint32 nodeId, const int upperLimit) noexcept
+{
+    return (int) (nodeId % (uint32) upperLimit);
+}
+
+int GraphEditorPanel::KeyHashFunctions::generateHash (const ConnectionKey& key, const int upperLimit) noexcept
+{
+    uint32 h = key.sourceNodeId;
+    h = h * 31 + (uint32) key.sourceChannelIndex;
+    h = h * 31 + key.destNodeId;
+    h = h * 31 + (uint32) key.destChannelIndex;
+
+    return (int) (h % (uint32) upperLimit);
+}
+
+//==============================================================================
+/** Where a node is on the canvas, and its component while it's in view. */
+struct GraphEditorPanel::NodeView
+{
+    NodeView (AudioProcessorGraph::Node* n) noexcept
+        : nodeId (n->nodeId), node (n), component (nullptr),
+          numIns (-1), numOuts (-1), paintStamp (0),
+          processor (nullptr), titleWidth (0), isMeter (false)
+    {}
+
+    const uint32 nodeId;
+    AudioProcessorGraph::Node::Ptr node;
+    Rectangle<int> bounds;
+    FilterComponent* component;
+    int numIns, numOuts;
+    uint32 paintStamp;
+
+    // Measuring the name is too slow to redo for every node on every change, so
+    // it's only done when the name or the processor is new.
+    AudioProcessor* processor;
+    String name;
+    int titleWidth;
+    bool isMeter;
+
+    JUCE_DECLARE_NON_COPYABLE (NodeView)
+};
+
+// Below the detail zoom, nodes are drawn as glyphs and have no components.
+static const float detailZoom = 0.5f;
+static const float minZoom = 0.02f;
+static const float maxZoom = 2.0f;
+
+// Nodes this far outside the view already have components, ready to scroll in.
+static const int visibleMargin = 100;
+
+// How far a wheel movement of 1.0 scrolls, in pixels on screen.
+static const float wheelScrollDistance = 300.0f;
+
 //==============================================================================
 GraphEditorPanel::GraphEditorPanel (FilterGraph& graph_)
-    : graph (graph_)
+    : graph (graph_),
+      nodeIndex (256),
+      pinIndex (32),
+      zoom (1.0f),
+      glyphCacheZoom (0.0f),
+      glyphStamp (0),
+      draggedGlyphID (0)
 {
+    addAndMakeVisible (connectorLayer = new ConnectorLayer (*this));
     graph.addChangeListener (this);
     setOpaque (true);
 }
@@ -984,21 +1609,121 @@ GraphEditorPanel::~GraphEditorPanel()
 {
     graph.removeChangeListener (this);
     draggingConnector = nullptr;
+    connectorLayer = nullptr;
+    filterComponents.clear();
+    pinIndex.clear();
     deleteAllChildren();
 }
 
 void GraphEditorPanel::paint (Graphics& g)
 {
     g.fillAll (findColour (mainBackgroundColourId));
+
+    if (isShowingDetail())
+        return;
+
+    /** Stamps each node that crosses the clip region, once. */
+    struct GlyphPainter
+    {
+        void operator() (NodeView* view) const
+        {
+            if (view->paintStamp == stamp || ! view->bounds.intersects (area))
+                return;
+
+            view->paintStamp = stamp;
+
+            // Rounding the size rather than the edges keeps every node of a size on one glyph.
+            const Rectangle<float> r (view->bounds.toFloat().transformedBy (transform));
+
+            g.drawImageAt (panel.getGlyph (roundToInt (r.getWidth()), roundToInt (r.getHeight())),
+                           roundToInt (r.getX()), roundToInt (r.getY()));
+        }
+
+        GraphEditorPanel& panel;
+        Graphics& g;
+        const AffineTransform transform;
+        const Rectangle<int> area;
+        const uint32 stamp;
+    };
+
+    const Rectangle<int> clip (g.getClipBounds());
+    const GlyphPainter painter = { *this, g, getViewTransform(),
+                                   Rectangle<float> (viewToCanvas (clip.getTopLeft().toFloat()),
+                                                     viewToCanvas (clip.getBottomRight().toFloat())).getSmallestIntegerContainer(),
+                                   ++glyphStamp };
+
+    nodeIndex.visitItemsIn (painter.area, painter);
 }
 
+Image GraphEditorPanel::getGlyph (const int width, const int height)
+{
+    if (zoom != glyphCacheZoom)
+    {
+        glyphCache.clear();
+        glyphCacheZoom = zoom;
+    }
+
+    const int64 key = (((int64) width) << 32) | (int64) (uint32) height;
+
+    if (! glyphCache.contains (key))
+    {
+        // A FilterComponent's box, without the pins, name or shadow that wouldn't show at this size.
+        Image glyph (Image::ARGB, jmax (1, width), jmax (1, height), true);
+        Graphics g (glyph);
+
+        const Rectangle<float> box (Rectangle<float> ((float) width, (float) height)
+                                      .reduced (4.0f * zoom, FilterComponent::pinSize * zoom));
+        const Colour accent (findColour (mainAccentColourId));
+
+        g.setColour (accent.withAlpha (0.7f));
+        g.fillRoundedRectangle (box, 10.0f * zoom);
+
+        g.setColour (accent);
+        g.drawRoundedRectangle (box, 10.0f * zoom, 1.0f);
+
+        glyphCache.set (key, glyph);
+    }
+
+    return glyphCache [key];
+}
+
+GraphEditorPanel::NodeView* GraphEditorPanel::getGlyphAt (const Point<float> canvasPos) const
+{
+    if (isShowingDetail())
+        return nullptr;
+
+    const Point<int> pos ((int) std::floor (canvasPos.x), (int) std::floor (canvasPos.y));
+
+    if (const Array<NodeView*>* const nearby = nodeIndex.getItemsNear (pos))
+        for (int i = nearby->size(); --i >= 0;)
+            if (nearby->getUnchecked (i)->bounds.contains (pos))
+                return nearby->getUnchecked (i);
+
+    return nullptr;
+}
+
+/** The tap measuring whatever currently has this id. The node's view keeps the
+    node alive, so the tap is safe to read until the graph next changes.
+*/
+const SignalTap* GraphEditorPanel::getOutputTapFor (const uint32 nodeId) const
+{
+    if (const NodeView* const view = nodeViewsById [nodeId])
+        if (view->node != nullptr)
+            return graph.getOutputTapFor (*view->node);
+
+    return nullptr;
+}
+
+//==============================================================================
 void GraphEditorPanel::mouseDown (const MouseEvent& e)
 {
+    draggedGlyphID = 0;
+
     if (e.mods.isPopupMenu())
     {
         PopupMenu m;
 
-        if (MainHostWindow* const mainWindow = findParentComponentOfClass<MainHostWindow>())
+        if (MainHostWindow* const mainWindow = MainHostWindow::findFor (*this))
         {
             mainWindow->addPluginsToMenu (m);
 
@@ -1007,57 +1732,229 @@ void GraphEditorPanel::mouseDown (const MouseEvent& e)
             createNewPlugin (mainWindow->getChosenType (r), e.x, e.y);
         }
     }
+    else if (NodeView* const view = getGlyphAt (viewToCanvas (e.position)))
+    {
+        // Zoomed out, a node can still be moved around by its glyph.
+        draggedGlyphID = view->nodeId;
+        dragStartCentre = view->bounds.getCentre();
+    }
+    else
+    {
+        dragStartOrigin = viewOrigin;
+    }
+}
+
+void GraphEditorPanel::mouseDrag (const MouseEvent& e)
+{
+    if (e.mods.isPopupMenu())
+        return;
+
+    const Point<float> offset (e.getOffsetFromDragStart().toFloat() / zoom);
+
+    if (draggedGlyphID != 0)
+    {
+        const Point<double> pos (canvasToPosition (dragStartCentre + Point<int> (roundToInt (offset.x),
+                                                                                 roundToInt (offset.y))));
+        graph.setNodePosition (draggedGlyphID, pos.x, pos.y);
+        updateComponentsFor (draggedGlyphID);
+    }
+    else
+    {
+        setView (zoom, dragStartOrigin - offset);
+    }
+}
+
+void GraphEditorPanel::mouseUp (const MouseEvent& e)
+{
+    if (draggedGlyphID != 0 && e.mouseWasDraggedSinceMouseDown())
+        graph.setChangedFlag (true);
+
+    draggedGlyphID = 0;
+}
+
+void GraphEditorPanel::mouseDoubleClick (const MouseEvent& e)
+{
+    if (e.mods.isPopupMenu())
+        return;
+
+    // A glyph zooms in to its node at full size; the background shows the whole graph.
+    if (getGlyphAt (viewToCanvas (e.position)) != nullptr)
+        zoomAround (1.0f / zoom, e.position);
+    else
+        zoomToFit();
+}
+
+void GraphEditorPanel::mouseWheelMove (const MouseEvent& e, const MouseWheelDetails& wheel)
+{
+    if (e.mods.isCommandDown() || e.mods.isCtrlDown())
+        zoomAround (std::pow (2.0f, wheel.deltaY), e.position);
+    else
+        setView (zoom, viewOrigin - Point<float> (wheel.deltaX, wheel.deltaY) * (wheelScrollDistance / zoom));
+}
+
+void GraphEditorPanel::mouseMagnify (const MouseEvent& e, const float scaleFactor)
+{
+    zoomAround (scaleFactor, e.position);
+}
+
+//==============================================================================
+Point<int> GraphEditorPanel::positionToCanvas (const Point<double> nodePosition) noexcept
+{
+    return Point<int> (roundToInt (nodePosition.x * canvasUnitWidth),
+                       roundToInt (nodePosition.y * canvasUnitHeight));
+}
+
+Point<double> GraphEditorPanel::canvasToPosition (const Point<int> canvasPos) noexcept
+{
+    return Point<double> (canvasPos.x / (double) canvasUnitWidth,
+                          canvasPos.y / (double) canvasUnitHeight);
+}
+
+AffineTransform GraphEditorPanel::getViewTransform() const noexcept
+{
+    return AffineTransform::translation (-viewOrigin.x, -viewOrigin.y).scaled (zoom);
+}
+
+Point<float> GraphEditorPanel::viewToCanvas (const Point<float> panelPos) const noexcept
+{
+    return viewOrigin + panelPos / zoom;
+}
+
+Rectangle<int> GraphEditorPanel::canvasToView (const Rectangle<int>& canvasArea) const noexcept
+{
+    return canvasArea.toFloat().transformedBy (getViewTransform()).getSmallestIntegerContainer();
+}
+
+Rectangle<int> GraphEditorPanel::getVisibleCanvasArea() const noexcept
+{
+    return Rectangle<float> (viewOrigin.x, viewOrigin.y, getWidth() / zoom, getHeight() / zoom)
+             .getSmallestIntegerContainer();
+}
+
+bool GraphEditorPanel::isShowingDetail() const noexcept
+{
+    return zoom >= detailZoom;
+}
+
+void GraphEditorPanel::zoomAround (const float factor, const Point<float> panelPos)
+{
+    const float newZoom = jlimit (minZoom, maxZoom, zoom * factor);
+    const Point<float> anchor (viewToCanvas (panelPos));
+
+    setView (newZoom, anchor - panelPos / newZoom);
+}
+
+void GraphEditorPanel::zoomToFit()
+{
+    if (nodeViews.size() == 0 || getWidth() <= 0 || getHeight() <= 0)
+        return;
+
+    Rectangle<int> area (nodeViews.getUnchecked (0)->bounds);
+
+    for (int i = 1; i < nodeViews.size(); ++i)
+        area = area.getUnion (nodeViews.getUnchecked (i)->bounds);
+
+    area = area.expanded (20);
+
+    const float newZoom = jlimit (minZoom, 1.0f, jmin (getWidth()  / (float) area.getWidth(),
+                                                       getHeight() / (float) area.getHeight()));
+
+    setView (newZoom, area.getCentre().toFloat() - Point<float> ((float) getWidth(), (float) getHeight()) / (2.0f * newZoom));
+}
+
+void GraphEditorPanel::setView (const float newZoom, const Point<float> newOrigin)
+{
+    if (newZoom == zoom && newOrigin == viewOrigin)
+        return;
+
+    zoom = newZoom;
+    viewOrigin = newOrigin;
+
+    const AffineTransform transform (getViewTransform());
+
+    for (HashMap<uint32, FilterComponent*, KeyHashFunctions>::Iterator i (filterComponents); i.next();)
+        i.getValue()->setTransform (transform);
+
+    if (draggingConnector != nullptr)
+        draggingConnector->setTransform (transform);
+
+    updateVisibleComponents();
+    repaint();
 }
 
+//==============================================================================
 void GraphEditorPanel::createNewPlugin (const PluginDescription* desc, int x, int y)
 {
-    graph.addFilter (desc, x / (double) getWidth(), y / (double) getHeight());
+    const Point<float> canvasPos (viewToCanvas (Point<float> ((float) x, (float) y)));
+    const Point<double> pos (canvasToPosition (Point<int> (roundToInt (canvasPos.x), roundToInt (canvasPos.y))));
+
+    graph.addFilter (desc, pos.x, pos.y);
 }
 
 FilterComponent* GraphEditorPanel::getComponentForFilter (const uint32 filterID) const
 {
-    for (int i = getNumChildComponents(); --i >= 0;)
+    return filterComponents [filterID];
+}
+
+PinComponent* GraphEditorPanel::findPinAt (const int x, const int y) const
+{
+    if (const Array<PinComponent*>* const nearby = pinIndex.getItemsNear (Point<int> (x, y)))
     {
-        if (FilterComponent* const fc = dynamic_cast<FilterComponent*> (getChildComponent (i)))
-            if (fc->filterID == filterID)
-                return fc;
+        for (int i = nearby->size(); --i >= 0;)
+        {
+            PinComponent* const pin = nearby->getUnchecked (i);
+
+            if ((pin->getBounds() + pin->getParentComponent()->getPosition()).contains (x, y))
+                return pin;
+        }
     }
 
     return nullptr;
 }
 
-ConnectorComponent* GraphEditorPanel::getComponentForConnection (const AudioProcessorGraph::Connection& conn) const
+bool GraphEditorPanel::getPinPosition (const uint32 filterID, const int channel, const bool isInput,
+                                       Point<float>& canvasPos) const
 {
-    for (int i = getNumChildComponents(); --i >= 0;)
+    if (const NodeView* const view = nodeViewsById [filterID])
     {
-        if (ConnectorComponent* const c = dynamic_cast<ConnectorComponent*> (getChildComponent (i)))
-            if (c->sourceFilterID == conn.sourceNodeId
-                 && c->destFilterID == conn.destNodeId
-                 && c->sourceFilterChannel == conn.sourceChannelIndex
-                 && c->destFilterChannel == conn.destChannelIndex)
-                return c;
+        const Rectangle<int>& b = view->bounds;
+
+        canvasPos = (FilterComponent::getPinBounds (*view->node->getProcessor(), channel, isInput,
+                                                    b.getWidth(), b.getHeight()) + b.getPosition()).toFloat().getCentre();
+        return true;
     }
 
-    return nullptr;
+    return false;
 }
 
-PinComponent* GraphEditorPanel::findPinAt (const int x, const int y) const
+void GraphEditorPanel::indexPinsOf (FilterComponent& fc)
 {
-    for (int i = getNumChildComponents(); --i >= 0;)
+    unindexPinsOf (fc);
+
+    for (int i = 0; i < fc.getNumChildComponents(); ++i)
     {
-        if (FilterComponent* fc = dynamic_cast<FilterComponent*> (getChildComponent (i)))
+        if (PinComponent* const pin = dynamic_cast<PinComponent*> (fc.getChildComponent (i)))
         {
-            if (PinComponent* pin = dynamic_cast<PinComponent*> (fc->getComponentAt (x - fc->getX(),
-                                                                                     y - fc->getY())))
-                return pin;
+            const FilterComponent::IndexedPin entry = { pin, pin->getBounds() + fc.getPosition() };
+
+            pinIndex.add (pin, entry.bounds);
+            fc.indexedPins.add (entry);
         }
     }
+}
 
-    return nullptr;
+void GraphEditorPanel::unindexPinsOf (FilterComponent& fc)
+{
+    // The pins themselves may already have been deleted, so only their addresses are used.
+    for (int i = 0; i < fc.indexedPins.size(); ++i)
+        pinIndex.remove (fc.indexedPins.getReference (i).pin, fc.indexedPins.getReference (i).bounds);
+
+    fc.indexedPins.clearQuick();
 }
 
 void GraphEditorPanel::resized()
 {
+    connectorLayer->setBounds (getLocalBounds());
     updateComponents();
 }
 
@@ -1068,68 +1965,210 @@ void GraphEditorPanel::changeListenerCallback (ChangeBroadcaster*)
 
 void GraphEditorPanel::updateComponents()
 {
-    for (int i = getNumChildComponents(); --i >= 0;)
+    SortedSet<uint32> changedFilters;
+
+    for (int i = graph.getNumFilters(); --i >= 0;)
     {
-        if (FilterComponent* const fc = dynamic_cast<FilterComponent*> (getChildComponent (i)))
-            fc->update();
+        const AudioProcessorGraph::Node::Ptr f (graph.getNode (i));
+        NodeView* view = nodeViewsById [f->nodeId];
+
+        if (view == nullptr)
+        {
+            view = nodeViews.add (new NodeView (f));
+            nodeViewsById.set (f->nodeId, view);
+        }
+
+        if (updateNodeView (*view, *f))
+            changedFilters.add (f->nodeId);
     }
 
-    for (int i = getNumChildComponents(); --i >= 0;)
+    // Every node now has a view, so any extras belong to deleted nodes.
+    if (nodeViews.size() > graph.getNumFilters())
+        removeDeletedFilters();
+
+    updateVisibleComponents();
+
+    for (int i = graph.getNumConnections(); --i >= 0;)
     {
-        ConnectorComponent* const cc = dynamic_cast<ConnectorComponent*> (getChildComponent (i));
+        const ConnectionKey key (*graph.getConnection (i));
+
+        if (! connectorLayer->containsWire (key))
+            connectorLayer->addWire (key);
+    }
+
+    // Likewise, any extra wires belong to connections that have been removed.
+    if (connectorLayer->getNumWires() > graph.getNumConnections())
+        connectorLayer->removeDeletedWires (graph);
 
-        if (cc != nullptr && cc != draggingConnector)
+    if (changedFilters.size() > 0)
+        connectorLayer->updateWiresAttachedTo (changedFilters);
+}
+
+void GraphEditorPanel::updateComponentsFor (const uint32 filterID)
+{
+    if (NodeView* const view = nodeViewsById [filterID])
+    {
+        if (const AudioProcessorGraph::Node::Ptr f = graph.getNodeForId (filterID))
         {
-            if (graph.getConnectionBetween (cc->sourceFilterID, cc->sourceFilterChannel,
-                                            cc->destFilterID, cc->destFilterChannel) == nullptr)
-            {
-                delete cc;
-            }
-            else
+            if (updateNodeView (*view, *f))
             {
-                cc->update();
+                SortedSet<uint32> changedFilters;
+                changedFilters.add (filterID);
+                connectorLayer->updateWiresAttachedTo (changedFilters);
             }
         }
     }
+}
+
+bool GraphEditorPanel::updateNodeView (NodeView& view, AudioProcessorGraph::Node& f)
+{
+    AudioProcessor& processor = *f.getProcessor();
+    const String name (processor.getName());
+
+    // The view's node still holds the old processor, so a new one can't be at the same address.
+    if (&processor != view.processor || name != view.name)
+    {
+        view.processor = &processor;
+        view.name = name;
+        view.titleWidth = FilterComponent::getTitleWidth (name);
+        view.isMeter = dynamic_cast<MeterProcessor*> (&processor) != nullptr;
+    }
+
+    const int numIns = FilterComponent::getNumPins (processor, true);
+    const int numOuts = FilterComponent::getNumPins (processor, false);
+    const Rectangle<int> newBounds (FilterComponent::getBoundsFor (f, numIns, numOuts, view.titleWidth, view.isMeter));
+    bool changed = false;
+
+    view.node = &f;
+
+    if (newBounds != view.bounds || numIns != view.numIns || numOuts != view.numOuts)
+    {
+        if (! view.bounds.isEmpty())
+        {
+            nodeIndex.remove (&view, view.bounds);
+
+            if (! isShowingDetail())
+                repaint (canvasToView (view.bounds));
+        }
+
+        view.bounds = newBounds;
+        view.numIns = numIns;
+        view.numOuts = numOuts;
+        nodeIndex.add (&view, newBounds);
+
+        if (! isShowingDetail())
+            repaint (canvasToView (newBounds));
+
+        changed = true;
+    }
+
+    if (view.component != nullptr && view.component->update (f, newBounds))
+    {
+        indexPinsOf (*view.component);
+        changed = true;
+    }
+
+    return changed;
+}
+
+void GraphEditorPanel::removeDeletedFilters()
+{
+    SortedSet<uint32> liveIDs;
 
     for (int i = graph.getNumFilters(); --i >= 0;)
+        liveIDs.add (graph.getNode (i)->nodeId);
+
+    for (int i = nodeViews.size(); --i >= 0;)
     {
-        const AudioProcessorGraph::Node::Ptr f (graph.getNode (i));
+        NodeView* const view = nodeViews.getUnchecked (i);
 
-        if (getComponentForFilter (f->nodeId) == 0)
+        if (! liveIDs.contains (view->nodeId))
         {
-            FilterComponent* const comp = new FilterComponent (graph, f->nodeId);
-            addAndMakeVisible (comp);
-            comp->update();
+            deleteComponentFor (*view);
+            nodeIndex.remove (view, view->bounds);
+
+            if (! isShowingDetail())
+                repaint (canvasToView (view->bounds));
+
+            nodeViewsById.remove (view->nodeId);
+            nodeViews.remove (i);
         }
     }
+}
+
+//==============================================================================
+void GraphEditorPanel::updateVisibleComponents()
+{
+    const Rectangle<int> area (getVisibleCanvasArea().expanded (visibleMargin));
+    const bool showDetail = isShowingDetail();
+
+    Array<NodeView*> hidden;
+
+    for (HashMap<uint32, FilterComponent*, KeyHashFunctions>::Iterator i (filterComponents); i.next();)
+    {
+        NodeView* const view = nodeViewsById [i.getKey()];
+
+        if (! showDetail || ! view->bounds.intersects (area))
+            hidden.add (view);
+    }
+
+    for (int i = 0; i < hidden.size(); ++i)
+        deleteComponentFor (*hidden.getUnchecked (i));
+
+    if (! showDetail)
+        return;
+
+    /** Gives each node that's come into view a component. */
+    struct ComponentCreator
+    {
+        void operator() (NodeView* view) const
+        {
+            if (view->component == nullptr && view->bounds.intersects (area))
+                panel.createComponentFor (*view);
+        }
+
+        GraphEditorPanel& panel;
+        const Rectangle<int> area;
+    };
+
+    const ComponentCreator creator = { *this, area };
+    nodeIndex.visitItemsIn (area, creator);
+}
 
-    for (int i = graph.getNumConnections(); --i >= 0;)
-    {
-        const AudioProcessorGraph::Connection* const c = graph.getConnection (i);
+void GraphEditorPanel::createComponentFor (NodeView& view)
+{
+    FilterComponent* const comp = new FilterComponent (graph, view.nodeId);
+    view.component = comp;
+    filterComponents.set (view.nodeId, comp);
 
-        if (getComponentForConnection (*c) == 0)
-        {
-            ConnectorComponent* const comp = new ConnectorComponent (graph);
-            addAndMakeVisible (comp);
+    comp->setTransform (getViewTransform());
+    addAndMakeVisible (comp);
 
-            comp->setInput (c->sourceNodeId, c->sourceChannelIndex);
-            comp->setOutput (c->destNodeId, c->destChannelIndex);
-        }
+    comp->update (*view.node, view.bounds);
+    indexPinsOf (*comp);
+}
+
+void GraphEditorPanel::deleteComponentFor (NodeView& view)
+{
+    if (FilterComponent* const comp = view.component)
+    {
+        unindexPinsOf (*comp);
+        filterComponents.remove (view.nodeId);
+        view.component = nullptr;
+        delete comp;
     }
 }
 
+//==============================================================================
 void GraphEditorPanel::beginConnectorDrag (const uint32 sourceFilterID, const int sourceFilterChannel,
                                            const uint32 destFilterID, const int destFilterChannel,
                                            const MouseEvent& e)
 {
-    draggingConnector = dynamic_cast<ConnectorComponent*> (e.originalComponent);
-
-    if (draggingConnector == nullptr)
-        draggingConnector = new ConnectorComponent (graph);
+    draggingConnector = new ConnectorComponent();
 
     draggingConnector->setInput (sourceFilterID, sourceFilterChannel);
     draggingConnector->setOutput (destFilterID, destFilterChannel);
+    draggingConnector->setTransform (getViewTransform());
 
     addAndMakeVisible (draggingConnector);
     draggingConnector->toFront (false);
@@ -1139,14 +2178,14 @@ void GraphEditorPanel::beginConnectorDrag (const uint32 sourceFilterID, const in
 
 void GraphEditorPanel::dragConnector (const MouseEvent& e)
 {
-    const MouseEvent e2 (e.getEventRelativeTo (this));
+    const Point<float> pos (viewToCanvas (e.getEventRelativeTo (this).position));
 
     if (draggingConnector != nullptr)
     {
         draggingConnector->setTooltip (String());
 
-        int x = e2.x;
-        int y = e2.y;
+        int x = roundToInt (pos.x);
+        int y = roundToInt (pos.y);
 
         if (PinComponent* const pin = findPinAt (x, y))
         {
@@ -1189,7 +2228,7 @@ void GraphEditorPanel::endDraggingConnector (const MouseEvent& e)
 
     draggingConnector->setTooltip (String());
 
-    const MouseEvent e2 (e.getEventRelativeTo (this));
+    const Point<float> pos (viewToCanvas (e.getEventRelativeTo (this).position));
 
     uint32 srcFilter = draggingConnector->sourceFilterID;
     int srcChannel   = draggingConnector->sourceFilterChannel;
@@ -1198,7 +2237,7 @@ void GraphEditorPanel::endDraggingConnector (const MouseEvent& e)
 
     draggingConnector = nullptr;
 
-    if (PinComponent* const pin = findPinAt (e2.x, e2.y))
+    if (PinComponent* const pin = findPinAt (roundToInt (pos.x), roundToInt (pos.y)))
     {
         if (srcFilter == 0)
         {
@@ -1223,36 +2262,88 @@ void GraphEditorPanel::endDraggingConnector (const MouseEvent& e)
 
 
 //==============================================================================
-class TooltipBar   : public Component,
-                     private Timer
+/**
+    The strip under the graph: the tooltip for whatever the mouse is over, and
+    the audio device's load, xruns and format, plus the recorder's headroom
+    while it's recording.
+
+    Nothing here polls the mouse. The tooltip follows mouse events, and the
+    audio figures are read from atomics and only repainted when the text that
+    shows them changes.
+*/
+class StatusBar   : public Component,
+                    private ChangeListener,
+                    private Timer
 {
 public:
-    TooltipBar()
+    StatusBar (FilterGraph& g, AudioCallbackMonitor& m)
+        : graph (g), monitor (m), tooltipWatcher (*this), recorder (nullptr)
     {
-        startTimer (100);
+        setInterceptsMouseClicks (false, false);
+
+        Desktop::getInstance().addGlobalMouseListener (&tooltipWatcher);
+        graph.addChangeListener (this);
+
+        findRecorder();
+        updateStatus();
+
+        // The audio figures and headroom change all the time, so they're sampled rather than pushed.
+        startTimer (updateIntervalMs);
+    }
+
+    ~StatusBar()
+    {
+        graph.removeChangeListener (this);
+        Desktop::getInstance().removeGlobalMouseListener (&tooltipWatcher);
     }
 
     void paint (Graphics& g) override
     {
-        ReferenceCountedObjectPtr<Typeface> typeface;
-        typeface = Typeface::createSystemTypefaceFor(BinaryData::quicksand_regular_ttf, BinaryData::quicksand_regular_ttf_Size);
-        Font font(typeface);
-        font.setHeight(getHeight() * 0.7f);
-        g.setFont(font);
-        g.setColour (findColour (mainBackgroundColourId).contrasting().withAlpha(0.7f));
-        g.drawFittedText (tip, 0, 0, getWidth(), getHeight(), Justification::centred, 1);
+        Rectangle<int> r (getLocalBounds());
+        const Colour textColour (findColour (mainBackgroundColourId).contrasting());
+
+        g.setFont (EmbeddedResources::getUIFont (getHeight() * 0.7f));
+
+        if (status.isNotEmpty())
+        {
+            g.setColour (textColour.withAlpha (0.5f));
+            g.drawFittedText (status, r.removeFromRight (statusWidth).reduced (4, 0), Justification::centredRight, 1);
+        }
+
+        g.setColour (textColour.withAlpha (0.7f));
+        g.drawFittedText (tip, r, Justification::centred, 1);
     }
 
-    void timerCallback() override
+private:
+    //==============================================================================
+    /** Follows the mouse around the whole app to find the current tooltip. */
+    struct TooltipWatcher   : public MouseListener
     {
-        Component* const underMouse = Desktop::getInstance().getMainMouseSource().getComponentUnderMouse();
-        TooltipClient* const ttc = dynamic_cast<TooltipClient*> (underMouse);
+        TooltipWatcher (StatusBar& b) noexcept  : bar (b) {}
+
+        void mouseEnter (const MouseEvent& e) override      { bar.setTipFor (e.eventComponent); }
+        void mouseMove (const MouseEvent& e) override       { bar.setTipFor (e.eventComponent); }
+        void mouseUp (const MouseEvent& e) override         { bar.setTipFor (e.eventComponent); }
+        void mouseExit (const MouseEvent&) override         { bar.setTip (String()); }
+        void mouseDown (const MouseEvent&) override         { bar.setTip (String()); }
+
+        StatusBar& bar;
+    };
 
-        String newTip;
+    enum { updateIntervalMs = 500, statusWidth = 380 };
 
-        if (ttc != nullptr && ! (underMouse->isMouseButtonDown() || underMouse->isCurrentlyBlockedByAnotherModalComponent()))
-            newTip = ttc->getTooltip();
+    FilterGraph& graph;
+    AudioCallbackMonitor& monitor;
+    TooltipWatcher tooltipWatcher;
+
+    AudioProcessorGraph::Node::Ptr recorderNode;
+    RecorderProcessor* recorder;
 
+    String tip, status;
+
+    //==============================================================================
+    void setTip (const String& newTip)
+    {
         if (newTip != tip)
         {
             tip = newTip;
@@ -1260,10 +2351,321 @@ public:
         }
     }
 
+    void setTipFor (Component* c)
+    {
+        TooltipClient* const ttc = dynamic_cast<TooltipClient*> (c);
+
+        if (ttc != nullptr && ! c->isCurrentlyBlockedByAnotherModalComponent())
+            setTip (ttc->getTooltip());
+        else
+            setTip (String());
+    }
+
+    void findRecorder()
+    {
+        recorderNode = nullptr;
+        recorder = nullptr;
+
+        for (int i = graph.getNumFilters(); --i >= 0;)
+        {
+            const AudioProcessorGraph::Node::Ptr f (graph.getNode (i));
+
+            if (RecorderProcessor* const r = dynamic_cast<RecorderProcessor*> (f->getProcessor()))
+            {
+                // Holding the node keeps the processor alive until we next look.
+                recorderNode = f;
+                recorder = r;
+                break;
+            }
+        }
+    }
+
+    void updateStatus()
+    {
+        String newStatus;
+        const double sampleRate = monitor.getSampleRate();
+
+        if (sampleRate > 0)
+        {
+            newStatus << "CPU " << roundToInt (monitor.getLoad() * 100.0f) << "%"
+                      << "   Xruns " << monitor.getNumXruns()
+                      << "   " << String (sampleRate / 1000.0, 1) << " kHz / " << monitor.getBufferSize();
+        }
+        else
+        {
+            newStatus << "Audio stopped";
+        }
+
+        if (recorder != nullptr && recorder->isRecording())
+        {
+            newStatus << "   Rec " << roundToInt (recorder->getHeadroom() * 100.0f) << "% free";
+
+            if (recorder->getNumDroppedSamples() > 0 || recorder->hasWriteFailed())
+                newStatus << " (dropping!)";
+        }
+
+        if (StallMonitor* const stallMonitor = StallMonitor::getInstanceWithoutCreating())
+            if (stallMonitor->getNumStalls() > 0)
+                newStatus << "   UI stalls " << stallMonitor->getNumStalls();
+
+        if (newStatus != status)
+        {
+            status = newStatus;
+            repaint();
+        }
+    }
+
+    void changeListenerCallback (ChangeBroadcaster*) override
+    {
+        findRecorder();
+        updateStatus();
+    }
+
+    void timerCallback() override
+    {
+        updateStatus();
+    }
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (StatusBar)
+};
+
+//==============================================================================
+FrameTimeStats::FrameTimeStats() noexcept
+    : frameStartMs (0), numFrames (0), totalMicroseconds (0), worstMicroseconds (0)
+{
+}
+
+void FrameTimeStats::frameStarted() noexcept
+{
+    frameStartMs = Time::getMillisecondCounterHiRes();
+}
+
+void FrameTimeStats::frameFinished() noexcept
+{
+    const int64 micros = (int64) ((Time::getMillisecondCounterHiRes() - frameStartMs) * 1000.0);
+
+    totalMicroseconds += micros;
+    ++numFrames;
+
+    int64 worst = worstMicroseconds.load();
+
+    while (micros > worst && ! worstMicroseconds.compare_exchange_weak (worst, micros))
+    {}
+}
+
+void FrameTimeStats::collect (int& frames, double& meanMilliseconds, double& worstMilliseconds) noexcept
+{
+    frames = numFrames.exchange (0);
+    const int64 total = totalMicroseconds.exchange (0);
+    const int64 worst = worstMicroseconds.exchange (0);
+
+    meanMilliseconds = frames > 0 ? total / (1000.0 * frames) : 0.0;
+    worstMilliseconds = worst / 1000.0;
+}
+
+//==============================================================================
+AudioCallbackMonitor::AudioCallbackMonitor (AudioIODeviceCallback& callbackToMonitor, SignalTap& tap) noexcept
+    : callback (callbackToMonitor), inputTap (tap),
+      load (0.0f), numXruns (0), bufferSize (0), sampleRate (0.0),
+      lastCallbackStart (0),
+      ticksPerSecond ((double) Time::getHighResolutionTicksPerSecond())
+{
+}
+
+void AudioCallbackMonitor::audioDeviceIOCallback (const float** inputChannelData, int numInputChannels,
+                                                  float** outputChannelData, int numOutputChannels,
+                                                  int numSamples)
+{
+    const int64 start = Time::getHighResolutionTicks();
+
+    inputTap.measure (inputChannelData, numInputChannels, numSamples);
+
+    callback.audioDeviceIOCallback (inputChannelData, numInputChannels,
+                                    outputChannelData, numOutputChannels, numSamples);
+
+    const double rate = sampleRate.load();
+
+    if (rate <= 0 || numSamples <= 0)
+        return;
+
+    const double blockTicks = numSamples * ticksPerSecond / rate;
+    const double busyTicks = (double) (Time::getHighResolutionTicks() - start);
+
+    // A block that took longer than it lasts, or one that turned up more than a
+    // block late, means the device has had to skip or repeat some audio.
+    const bool overran = busyTicks > blockTicks;
+    const bool late = lastCallbackStart != 0 && (start - lastCallbackStart) > 2.0 * blockTicks;
+    lastCallbackStart = start;
+
+    load = load.load() * 0.9f + (float) (busyTicks / blockTicks) * 0.1f;
+
+    if (overran || late)
+        ++numXruns;
+}
+
+void AudioCallbackMonitor::audioDeviceAboutToStart (AudioIODevice* device)
+{
+    callback.audioDeviceAboutToStart (device);
+
+    lastCallbackStart = 0;
+    load = 0.0f;
+    bufferSize = device->getCurrentBufferSizeSamples();
+    sampleRate = device->getCurrentSampleRate();
+}
+
+void AudioCallbackMonitor::audioDeviceStopped()
+{
+    callback.audioDeviceStopped();
+
+    sampleRate = 0.0;
+    bufferSize = 0;
+}
+
+void AudioCallbackMonitor::audioDeviceError (const String& errorMessage)
+{
+    callback.audioDeviceError (errorMessage);
+}
+
+void AudioCallbackMonitor::handleIncomingMidiMessage (MidiInput*, const MidiMessage&)
+{
+    inputTap.countMidi (1);
+}
+
+void AudioCallbackMonitor::handleNoteOn (MidiKeyboardState*, int, int, float)
+{
+    inputTap.countMidi (1);
+}
+
+void AudioCallbackMonitor::handleNoteOff (MidiKeyboardState*, int, int, float)
+{
+    inputTap.countMidi (1);
+}
+
+//==============================================================================
+/** Shows the renderer in use and how long the document has taken to paint. */
+class FrameTimeReadout   : public Component,
+                           private Timer
+{
+public:
+    FrameTimeReadout (FrameTimeStats& s, const OpenGLContext& c)
+        : stats (s), context (c)
+    {
+        setInterceptsMouseClicks (false, false);
+        startTimer (updateIntervalMs);
+    }
+
+    void paint (Graphics& g) override
+    {
+        g.setFont (Font (getHeight() * 0.6f));
+        g.setColour (findColour (mainBackgroundColourId).contrasting().withAlpha (0.5f));
+        g.drawFittedText (text, getLocalBounds().reduced (4, 0), Justification::centredRight, 1);
+    }
+
+private:
+    enum { updateIntervalMs = 500 };
+
+    FrameTimeStats& stats;
+    const OpenGLContext& context;
+    String text;
+
+    void timerCallback() override
+    {
+        int numFrames;
+        double meanMs, worstMs;
+        stats.collect (numFrames, meanMs, worstMs);
+
+        String newText (context.isAttached() ? "OpenGL: " : "Software: ");
+
+        if (numFrames > 0)
+            newText << String (meanMs, 1) << " ms avg, " << String (worstMs, 1) << " ms max, "
+                    << roundToInt (numFrames * 1000.0 / updateIntervalMs) << " fps";
+        else
+            newText << "idle";
+
+        // Repainting is itself a frame, so only do it when the text has changed.
+        if (newText != text)
+        {
+            text = newText;
+            repaint();
+        }
+    }
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (FrameTimeReadout)
+};
+
+//==============================================================================
+/**
+    Shows how far a FilterGraph::loadFromAsync() has got, with a button to
+    cancel it. It only covers a small strip, so the rest of the window can
+    still be used while the project loads.
+*/
+class LoadingOverlay   : public Component,
+                         private FilterGraph::LoadListener,
+                         private Button::Listener
+{
+public:
+    LoadingOverlay (FilterGraph& g)
+        : graph (g), progress (0.0), progressBar (progress), cancelButton ("Cancel")
+    {
+        addAndMakeVisible (progressBar);
+        addAndMakeVisible (cancelButton);
+        cancelButton.addListener (this);
+
+        graph.addLoadListener (this);
+        setVisible (graph.isLoading());
+    }
+
+    ~LoadingOverlay()
+    {
+        graph.removeLoadListener (this);
+    }
+
+    void paint (Graphics& g) override
+    {
+        const Colour background (findColour (mainBackgroundColourId));
+
+        g.setColour (background.withAlpha (0.9f));
+        g.fillRoundedRectangle (getLocalBounds().toFloat(), 6.0f);
+        g.setColour (findColour (mainAccentColourId));
+        g.drawRoundedRectangle (getLocalBounds().toFloat().reduced (0.5f), 6.0f, 1.0f);
+
+        g.setColour (background.contrasting());
+        g.setFont (EmbeddedResources::getUIFont (14.0f));
+        g.drawFittedText (status, getLocalBounds().reduced (10, 6).removeFromTop (20), Justification::centredLeft, 1);
+    }
+
+    void resized() override
+    {
+        Rectangle<int> r (getLocalBounds().reduced (10, 6));
+        r.removeFromTop (24);
+
+        cancelButton.setBounds (r.removeFromRight (80));
+        r.removeFromRight (8);
+        progressBar.setBounds (r);
+    }
+
 private:
-    String tip;
+    FilterGraph& graph;
+    double progress;
+    ProgressBar progressBar;
+    TextButton cancelButton;
+    String status;
+
+    void loadProgressChanged (FilterGraph&) override
+    {
+        progress = graph.getLoadProgress();
+        status = graph.getLoadStatus();
 
-    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (TooltipBar)
+        setVisible (graph.isLoading());
+        repaint();
+    }
+
+    void buttonClicked (Button*) override
+    {
+        graph.cancelLoading();
+    }
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (LoadingOverlay)
 };
 
 
@@ -1284,9 +2686,8 @@ public:
     {
         if (isPositiveAndBelow (row, midiMessageList.size()))
         {
-            typeface = Typeface::createSystemTypefaceFor(BinaryData::quicksand_regular_ttf, BinaryData::quicksand_regular_ttf_Size);
-            Font font(typeface);
-            g.setFont(font);
+            const Font font (EmbeddedResources::getUIFont (14.0f));
+            g.setFont (font);
             
             auto r = Rectangle<float> (width, height);
             const float arrowH = font.getAscent() * 1.8f;
@@ -1321,10 +2722,8 @@ public:
     {
         if (isPositiveAndBelow (row, midiMessageList.size()))
         {
-            String documentsFolder = File::getSpecialLocation(File::userDocumentsDirectory).getFullPathName();
-            String folder = documentsFolder + "/Middle/Projects/";
             const String& message = midiMessageList.getReference (row);
-            graph.loadFrom(File(folder + message + ".middlet"), true);
+            graph.loadFromAsync (ProjectLibrary::getProjectsFolder().getChildFile (message + ".middlet"), true);
         }
         
     }
@@ -1334,7 +2733,6 @@ public:
 private:
     const Array<String>& midiMessageList;
     FilterGraph& graph;
-    ReferenceCountedObjectPtr<Typeface> typeface;
     
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (FileListBoxModel)
 };
@@ -1343,7 +2741,8 @@ private:
 
 //==============================================================================
 class FileListBoxComponent  : public Component,
-private AsyncUpdater
+private AsyncUpdater,
+private ChangeListener
 {
 public:
     FileListBoxComponent (FilterGraph& graph_)
@@ -1359,13 +2758,14 @@ public:
         messageListBox.setMultipleSelectionEnabled(false);
         messageListBox.setRowHeight(40);
         messageListBox.setColour(ListBox::backgroundColourId, Colours::whitesmoke);
+        library->addChangeListener (this);
         fillList();
         
     }
     
     ~FileListBoxComponent()
     {
-
+        library->removeChangeListener (this);
     }
     
     void paint (Graphics& g) override
@@ -1382,16 +2782,16 @@ public:
     
     void fillList ()
     {
+        // The library has already read the folder, so this never touches the disk.
         clearMessagesFromList();
-        String documentsFolder = File::getSpecialLocation(File::userDocumentsDirectory).getFullPathName();
-        String folder = documentsFolder + "/Middle/Projects";
-        DirectoryIterator iter (File (folder), false, "*.middlet");
+        const ProjectLibrary::Snapshot::Ptr snapshot (library->getSnapshot());
         
-        while (iter.next())
+        for (int i = 0; i < snapshot->projects.size(); ++i)
         {
-            File theFileItFound (iter.getFile());
-			if (!theFileItFound.hasWriteAccess())
-            addMessageToList (theFileItFound.getFileNameWithoutExtension());
+            const ProjectLibrary::Project& project = snapshot->projects.getReference (i);
+
+            if (project.isTemplate)
+                addMessageToList (project.name);
         }
         
         selectOpenedListItem();
@@ -1423,8 +2823,14 @@ public:
         messageListBox.repaint();
     }
     
+    void changeListenerCallback (ChangeBroadcaster*) override
+    {
+        fillList();
+    }
+    
 
 private:
+    SharedResourcePointer<ProjectLibrary> library;
     ListBox messageListBox;
     Array<String> midiMessageList;
     FileListBoxModel midiLogListBoxModel;
@@ -1439,49 +2845,32 @@ private:
 
 
 //==============================================================================
+/**
+ Lists every project in the library with its plugins, size and a sketch of its
+ layout, all read from the library's index rather than from the files.
+ */
 class PresetBrowser   : public Component,
-public DragAndDropContainer,
-private Button::Listener,
-private FileBrowserListener
+private ListBoxModel,
+private ChangeListener
 {
 public:
     PresetBrowser(FilterGraph* graph_)
-    : moviesWildcardFilter ("*.middlet", "*.middlet", "File Filter"),
-    directoryThread ("File Scanner Thread"),
-    movieList (&moviesWildcardFilter, directoryThread),
-    fileTree (movieList),
-    resizerBar (&stretchableManager, 1, false),
-    graph(graph_)
+    : graph(graph_)
     {
         setOpaque (false);
-        String documentsFolder = File::getSpecialLocation(File::userDocumentsDirectory).getFullPathName();
-        String folder = documentsFolder + "/Middle/Projects";
-        movieList.setDirectory (File(folder), true, true);
-        directoryThread.startThread (1);
-        
-        fileTree.addListener (this);
-        fileTree.setColour (FileTreeComponent::backgroundColourId, Colours::whitesmoke.withAlpha (0.2f));
-        fileTree.setColour (FileTreeComponent::highlightColourId, Colours::lightskyblue);
-        addAndMakeVisible (fileTree);
         
-        addAndMakeVisible (resizerBar);
+        projectList.setModel (this);
+        projectList.setRowHeight (48);
+        projectList.setColour (ListBox::backgroundColourId, Colours::whitesmoke.withAlpha (0.2f));
+        addAndMakeVisible (projectList);
         
-        // we have to set up our StretchableLayoutManager so it know the limits and preferred sizes of it's contents
-        stretchableManager.setItemLayout (0,            // for the fileTree
-                                          -0.1, -0.9,   // must be between 50 pixels and 90% of the available space
-                                          -1.0);        // and its preferred size is 30% of the total available space
-//        
-//        stretchableManager.setItemLayout (1,            // for the resize bar
-//                                          5, 5, 5);     // hard limit to 5 pixels
-//        
-//        stretchableManager.setItemLayout (2,            // for the movie components
-//                                          -0.1, -0.9,   // size must be between 50 pixels and 90% of the available space
-//                                          -0.7);        // and its preferred size is 70% of the total available space
+        library->addChangeListener (this);
+        changeListenerCallback (nullptr);
     }
     
     ~PresetBrowser()
     {
-        fileTree.removeListener (this);
+        library->removeChangeListener (this);
     }
     
     void paint (Graphics& g) override
@@ -1491,57 +2880,85 @@ public:
     
     void resized() override
     {
-        // make a list of two of our child components that we want to reposition
-        Component* comps[] = { &fileTree, &resizerBar, nullptr };
-        
-        // this will position the 3 components, one above the other, to fit
-        // vertically into the rectangle provided.
-        stretchableManager.layOutComponents (comps, 3,
-                                             0, 0, getWidth(), getHeight(),
-                                             true, true);
-        
-        // now position out two video components in the space that's left
-        //Rectangle<int> area (getLocalBounds().removeFromBottom (getHeight() - resizerBar.getBottom()));
-        
-        {
-
-        }
-
+        projectList.setBounds (getLocalBounds());
     }
     
 private:
-    WildcardFileFilter moviesWildcardFilter;
-    TimeSliceThread directoryThread;
-    DirectoryContentsList movieList;
-    FileTreeComponent fileTree;
-    StretchableLayoutManager stretchableManager;
-    StretchableLayoutResizerBar resizerBar;
+    SharedResourcePointer<ProjectLibrary> library;
+    ProjectLibrary::Snapshot::Ptr snapshot;
+    ListBox projectList;
     FilterGraph* graph;
     
-    void refresh() {
-        movieList.refresh();
-        fileTree.refresh();
+    int getNumRows() override
+    {
+        return snapshot->projects.size();
     }
     
-    void buttonClicked (Button* button) override
+    void paintListBoxItem (int row, Graphics& g, int width, int height, bool rowIsSelected) override
     {
+        if (! isPositiveAndBelow (row, snapshot->projects.size()))
+            return;
+        
+        const ProjectLibrary::Project& project = snapshot->projects.getReference (row);
+        Rectangle<int> r (width, height);
+        
+        if (rowIsSelected)
+            g.fillAll (Colours::lightskyblue);
+        
+        // A dot for each node, as a thumbnail of the layout.
+        const Rectangle<float> thumb (r.removeFromLeft (height).reduced (6).toFloat());
+        g.setColour (Colour (0xff575757).withAlpha (0.15f));
+        g.fillRect (thumb);
+        g.setColour (findColour (mainAccentColourId));
+        
+        // Nodes can sit anywhere, so the default view is stretched to take in all of them.
+        Point<float> topLeft, bottomRight (1.0f, 1.0f);
 
+        for (int i = 0; i < project.nodePositions.size(); ++i)
+        {
+            const Point<float> pos (project.nodePositions.getReference (i));
+            topLeft = Point<float> (jmin (topLeft.x, pos.x), jmin (topLeft.y, pos.y));
+            bottomRight = Point<float> (jmax (bottomRight.x, pos.x), jmax (bottomRight.y, pos.y));
+        }
+
+        for (int i = 0; i < project.nodePositions.size(); ++i)
+        {
+            const Point<float> pos ((project.nodePositions.getReference (i) - topLeft) / (bottomRight - topLeft));
+
+            g.fillEllipse (thumb.getX() + pos.x * thumb.getWidth() - 2.0f,
+                           thumb.getY() + pos.y * thumb.getHeight() - 2.0f, 4.0f, 4.0f);
+        }
+        
+        r.reduce (4, 4);
+        g.setColour (Colour (0xff575757));
+        g.setFont (EmbeddedResources::getUIFont (15.0f));
+        g.drawText (project.name + (project.isTemplate ? " (template)" : String()),
+                    r.removeFromTop (r.getHeight() / 2), Justification::centredLeft, true);
+        
+        g.setFont (EmbeddedResources::getUIFont (12.0f));
+        g.drawText (File::descriptionOfSizeInBytes (project.size) + "  " + project.plugins.joinIntoString (", "),
+                    r, Justification::centredLeft, true);
     }
     
-    void selectionChanged() override
+    void selectedRowsChanged (int row) override
     {
+        if (! isPositiveAndBelow (row, snapshot->projects.size()))
+            return;
+        
+        const File file (snapshot->projects.getReference (row).file);
         
         if (graph != nullptr && graph->saveIfNeededAndUserAgrees() == FileBasedDocument::savedOk) {
-            graph->setLastDocumentOpened(fileTree.getSelectedFile().getFullPathName());
-            graph->loadFrom(fileTree.getSelectedFile().getFullPathName(), false);
+            graph->setLastDocumentOpened(file);
+            graph->loadFromAsync (file, false);
         }
-        
     }
     
-    
-    void fileClicked (const File&, const MouseEvent&) override {}
-    void fileDoubleClicked (const File&) override {}
-    void browserRootChanged (const File&) override {}
+    void changeListenerCallback (ChangeBroadcaster*) override
+    {
+        snapshot = library->getSnapshot();
+        projectList.updateContent();
+        projectList.repaint();
+    }
     
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (PresetBrowser)
 };
@@ -1559,18 +2976,12 @@ public:
     TemplateOptionButton (const String& buttonName, ButtonStyle buttonStyle, const char* thumbSvg)
     : DrawableButton (buttonName, buttonStyle)
     {
-        // svg for thumbnail icon
-        ScopedPointer<XmlElement> svg (XmlDocument::parse (thumbSvg));
-        jassert (svg != nullptr);
-        
-        thumb = Drawable::createFromSVG (*svg);
+        // svg for thumbnail icon, copied from the shared one so it can be recoloured
+        thumb = EmbeddedResources::getDrawable (thumbSvg)->createCopy();
         thumb->replaceColour(Colour (0xff448AFF), findColour(mainAccentColourId));
         
         // svg for thumbnail background highlight
-        ScopedPointer<XmlElement> backSvg (XmlDocument::parse (BinaryData::middle_highlight_svg));
-        jassert (backSvg != nullptr);
-        
-        hoverBackground = Drawable::createFromSVG (*backSvg);
+        hoverBackground = EmbeddedResources::getDrawable (BinaryData::middle_highlight_svg)->createCopy();
         hoverBackground->replaceColour(Colour (0xffDDDDDD), findColour(mainAccentColourId).withAlpha(0.3f));
         
         name = buttonName;
@@ -1673,20 +3084,25 @@ public:
         
         if (textH > 0)
         {
-            ReferenceCountedObjectPtr<Typeface> typeface;
-            typeface = Typeface::createSystemTypefaceFor(BinaryData::quicksand_regular_ttf, BinaryData::quicksand_regular_ttf_Size);
-            Font font(typeface);
-            font.setHeight((float) textH);
-            g.setFont(font);
+            const Rectangle<int> nameArea (2, getLocalBounds().getHeight() - textH - getLocalBounds().proportionOfHeight (0.25f),
+                                           getLocalBounds().getWidth() - 4, textH);
+
+            // The label only changes when the button is resized, so it's laid out once and reused.
+            if (nameArea != nameGlyphArea)
+            {
+                nameGlyphs.clear();
+                nameGlyphs.addFittedText (EmbeddedResources::getUIFont ((float) textH), name,
+                                          (float) nameArea.getX(), (float) nameArea.getY(),
+                                          (float) nameArea.getWidth(), (float) nameArea.getHeight(),
+                                          Justification::centred, 1);
+                nameGlyphArea = nameArea;
+            }
             
             g.setColour (findColour (getToggleState() ? DrawableButton::textColourOnId
                                      : DrawableButton::textColourId)
                          .withMultipliedAlpha (isEnabled() ? 1.0f : 0.4f));
             
-            g.drawFittedText (name,
-                              2, getLocalBounds().getHeight() - textH - getLocalBounds().proportionOfHeight (0.25f),
-                              getLocalBounds().getWidth() - 4, textH,
-                              Justification::centred, 1);
+            nameGlyphs.draw (g);
         }
         else
         {
@@ -1716,6 +3132,8 @@ public:
 private:
     ScopedPointer<Drawable> thumb, hoverBackground;
     String name, description;
+    GlyphArrangement nameGlyphs;
+    Rectangle<int> nameGlyphArea;
     
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (TemplateOptionButton)
 };
@@ -1753,11 +3171,7 @@ public:
     void paint (Graphics& g) override
     {
         g.setColour (Colours::lightgrey);
-        ReferenceCountedObjectPtr<Typeface> typeface;
-        typeface = Typeface::createSystemTypefaceFor(BinaryData::quicksand_regular_ttf, BinaryData::quicksand_regular_ttf_Size);
-        Font font(typeface);
-        font.setHeight(20.0f);
-        g.setFont(font);
+        g.setFont (EmbeddedResources::getUIFont (20.0f));
         
 		if (projectHasPlugin("Recorder")) {
 			g.drawText("Loading...", 0, 0, getWidth(), 200, Justification::centred, true);
@@ -1851,7 +3265,8 @@ private:
 GraphDocumentComponent::GraphDocumentComponent (AudioPluginFormatManager& formatManager,
                                                 AudioDeviceManager* deviceManager_)
     : graph (new FilterGraph (formatManager)), deviceManager (deviceManager_),
-      graphPlayer (getAppProperties().getUserSettings()->getBoolValue ("doublePrecisionProcessing", false))
+      graphPlayer (getAppProperties().getUserSettings()->getBoolValue ("doublePrecisionProcessing", false)),
+      audioMonitor (graphPlayer, graph->getInputTap())
 {
     graphPanel = new GraphEditorPanel (*graph);
     addAndMakeVisible(panel = new Peels::SlidingPanelComponent());
@@ -1864,15 +3279,25 @@ GraphDocumentComponent::GraphDocumentComponent (AudioPluginFormatManager& format
     graphPlayer.setProcessor (&graph->getGraph());
 
     keyState.addListener (&graphPlayer.getMidiMessageCollector());
+    keyState.addListener (&audioMonitor);
 
     addAndMakeVisible (keyboardComp = new CustomMidiKeyboardComponent (keyState, CustomMidiKeyboardComponent::Orientation::horizontalKeyboard));
     
-    addAndMakeVisible (statusBar = new TooltipBar());
+    addAndMakeVisible (statusBar = new StatusBar (*graph, audioMonitor));
+    addChildComponent (frameTimeReadout = new FrameTimeReadout (frameTimeStats, openGLContext));
+    addChildComponent (loadingOverlay = new LoadingOverlay (*graph));
 
-    deviceManager->addAudioCallback (&graphPlayer);
+    deviceManager->addAudioCallback (&audioMonitor);
     deviceManager->addMidiInputCallback (String(), &graphPlayer.getMidiMessageCollector());
+    deviceManager->addMidiInputCallback (String(), &audioMonitor);
 
     graphPanel->updateComponents();
+
+    if (PropertiesFile* const props = getAppProperties().getUserSettings())
+    {
+        setUsingOpenGL (props->getBoolValue ("useOpenGLRenderer", false));
+        setFrameTimeVisible (props->getBoolValue ("showFrameTime", false));
+    }
     
 	keyboardFocusTransferer = new KeyboardFocusTransferer();
 	keyboardFocusTransferer->setCallback(this, keyboardComp);
@@ -1882,8 +3307,10 @@ GraphDocumentComponent::GraphDocumentComponent (AudioPluginFormatManager& format
 
 GraphDocumentComponent::~GraphDocumentComponent()
 {
+    openGLContext.detach();
     releaseGraph();
     keyState.removeListener (&graphPlayer.getMidiMessageCollector());
+    keyState.removeListener (&audioMonitor);
     keyboardFocusTransferer->~KeyboardFocusTransferer();
 
 }
@@ -1894,7 +3321,14 @@ void GraphDocumentComponent::resized()
     const int statusHeight = 20;
 
     panel->setBounds (0, 0, getWidth(), getHeight() - keysHeight);
-    statusBar->setBounds (0, getHeight() - keysHeight - statusHeight, getWidth(), statusHeight);
+    loadingOverlay->setBounds (Rectangle<int> (jmin (420, getWidth() - 20), 64).withCentre (Point<int> (getWidth() / 2, 60)));
+
+    Rectangle<int> statusArea (0, getHeight() - keysHeight - statusHeight, getWidth(), statusHeight);
+
+    if (frameTimeReadout->isVisible())
+        frameTimeReadout->setBounds (statusArea.removeFromRight (260));
+
+    statusBar->setBounds (statusArea);
     keyboardComp->setBounds (0, getHeight() - keysHeight, getWidth(), keysHeight);
     //transComp->setBounds (0, getHeight() - keysHeight, getWidth(), keysHeight);
 }
@@ -1909,13 +3343,40 @@ void GraphDocumentComponent::unfocusKeyboardComponent()
     keyboardComp->unfocusAllComponents();
 }
 
+void GraphDocumentComponent::setUsingOpenGL (const bool shouldUseOpenGL)
+{
+    if (shouldUseOpenGL == isUsingOpenGL())
+        return;
+
+    // Detaching puts everything back on the software renderer, which also serves
+    // as the fallback when no GL context can be created.
+    if (shouldUseOpenGL)
+        openGLContext.attachTo (*this);
+    else
+        openGLContext.detach();
+
+    repaint();
+}
+
+void GraphDocumentComponent::setFrameTimeVisible (const bool shouldBeVisible)
+{
+    if (frameTimeReadout != nullptr)
+    {
+        frameTimeReadout->setVisible (shouldBeVisible);
+        resized();
+    }
+}
+
 void GraphDocumentComponent::releaseGraph()
 {
-    deviceManager->removeAudioCallback (&graphPlayer);
+    deviceManager->removeAudioCallback (&audioMonitor);
     deviceManager->removeMidiInputCallback (String(), &graphPlayer.getMidiMessageCollector());
+    deviceManager->removeMidiInputCallback (String(), &audioMonitor);
     deviceManager->removeChangeListener (graphPanel);
 
     deleteAllChildren();
+    frameTimeReadout = nullptr;
+    loadingOverlay = nullptr;
 
     graphPlayer.setProcessor (nullptr);
     graph = nullptr;
@@ -1924,6 +3385,14 @@ void GraphDocumentComponent::releaseGraph()
 void GraphDocumentComponent::paint (Graphics& g)
 {
     g.fillAll(findColour (mainBackgroundColourId));
+
+    // Only the children are timed, not the background they mostly cover up.
+    frameTimeStats.frameStarted();
+}
+
+void GraphDocumentComponent::paintOverChildren (Graphics&)
+{
+    frameTimeStats.frameFinished();
 }
         
 void GraphDocumentComponent::mouseDown(const MouseEvent &event)
@@ -25,8 +25,10 @@
 #ifndef __GRAPHEDITORPANEL_JUCEHEADER__
 #define __GRAPHEDITORPANEL_JUCEHEADER__
 
+#include <atomic>
 #include "FilterGraph.h"
 #include "CustomMidiKeyboardComponent.h"
+#include "SpatialGrid.h"
 
 class FilterComponent;
 class ConnectorComponent;
@@ -36,6 +38,16 @@ class PinComponent;
 //==============================================================================
 /**
     A panel that displays and edits a FilterGraph.
+
+    The graph sits on an unbounded canvas that can be panned and zoomed. Every
+    node's box and pin positions are worked out without any components, so only
+    the nodes in view have a live FilterComponent; the rest are just filed in a
+    grid by where they are. Below the detail zoom there are no node components at
+    all, and the panel stamps each node as a cached glyph, so big graphs can
+    still be moved around smoothly.
+
+    Components on the panel are laid out in canvas coordinates, and shown through
+    the view transform.
 */
 class GraphEditorPanel   : public Component,
                            public ChangeListener
@@ -46,17 +58,62 @@ public:
 
     void paint (Graphics& g);
     void mouseDown (const MouseEvent& e);
+    void mouseDrag (const MouseEvent& e);
+    void mouseUp (const MouseEvent& e);
+    void mouseDoubleClick (const MouseEvent& e);
+    void mouseWheelMove (const MouseEvent& e, const MouseWheelDetails& wheel);
+    void mouseMagnify (const MouseEvent& e, float scaleFactor);
 
+    /** Adds a plugin at a point on the panel, as it's currently showing. */
     void createNewPlugin (const PluginDescription* desc, int x, int y);
 
     FilterComponent* getComponentForFilter (uint32 filterID) const;
-    ConnectorComponent* getComponentForConnection (const AudioProcessorGraph::Connection& conn) const;
+
+    /** Finds the pin of a node in view at a point on the canvas. */
     PinComponent* findPinAt (int x, int y) const;
 
+    /** Finds where a node's pin is on the canvas, whether or not it has a component. */
+    bool getPinPosition (uint32 filterID, int channel, bool isInput, Point<float>& canvasPos) const;
+
     void resized();
     void changeListenerCallback (ChangeBroadcaster*);
+
+    //==============================================================================
+    /** How far one unit of a node position is across the canvas, so that a graph
+        laid out between 0 and 1 fills the panel's usual size at 100%.
+    */
+    enum { canvasUnitWidth = 600, canvasUnitHeight = 440 };
+
+    static Point<int> positionToCanvas (Point<double> nodePosition) noexcept;
+    static Point<double> canvasToPosition (Point<int> canvasPos) noexcept;
+
+    /** Maps canvas coordinates onto the panel, for the current zoom and scroll. */
+    AffineTransform getViewTransform() const noexcept;
+    Point<float> viewToCanvas (Point<float> panelPos) const noexcept;
+    Rectangle<int> canvasToView (const Rectangle<int>& canvasArea) const noexcept;
+
+    /** The part of the canvas that's on screen. */
+    Rectangle<int> getVisibleCanvasArea() const noexcept;
+
+    float getZoom() const noexcept                                       { return zoom; }
+
+    /** Zooms by a factor, keeping the canvas point under panelPos where it is. */
+    void zoomAround (float factor, Point<float> panelPos);
+
+    /** Scrolls and zooms so that every node is in view, up to 100%. */
+    void zoomToFit();
+
+    /** Brings the components in line with the graph: creates and deletes them for
+        nodes and connections that have come or gone, and only redraws the wires
+        whose filter has actually moved or changed shape.
+    */
     void updateComponents();
 
+    /** A cheaper update for when a single node has been moved: just repositions it
+        and the wires attached to it.
+    */
+    void updateComponentsFor (uint32 filterID);
+
     //==============================================================================
     void beginConnectorDrag (uint32 sourceFilterID, int sourceFilterChannel,
                              uint32 destFilterID, int destFilterChannel,
@@ -66,8 +123,68 @@ public:
 
     //==============================================================================
 private:
+    //==============================================================================
+    struct ConnectionKey
+    {
+        ConnectionKey (uint32 sourceId, int sourceChannel, uint32 destId, int destChannel) noexcept;
+        ConnectionKey (const AudioProcessorGraph::Connection&) noexcept;
+
+        bool operator== (const ConnectionKey&) const noexcept;
+
+        uint32 sourceNodeId, destNodeId;
+        int sourceChannelIndex, destChannelIndex;
+    };
+
+    struct KeyHashFunctions
+    {
+        static int generateHash (uint32 nodeId, int upperLimit) noexcept;
+        static int generateHash (const ConnectionKey&, int upperLimit) noexcept;
+    };
+
+    class ConnectorLayer;
+    struct NodeView;
+
     FilterGraph& graph;
     ScopedPointer<ConnectorComponent> draggingConnector;
+    ScopedPointer<ConnectorLayer> connectorLayer;
+
+    // Where every node is on the canvas, whether or not it's in view.
+    OwnedArray<NodeView> nodeViews;
+    HashMap<uint32, NodeView*, KeyHashFunctions> nodeViewsById;
+    SpatialGrid<NodeView*> nodeIndex;
+
+    // The FilterComponents of the nodes in view, so lookups don't have to search the child list.
+    HashMap<uint32, FilterComponent*, KeyHashFunctions> filterComponents;
+
+    // Every pin in view, by position on the canvas, for hit-testing while a wire is dragged.
+    SpatialGrid<PinComponent*> pinIndex;
+
+    float zoom;
+    Point<float> viewOrigin;
+
+    // A glyph for each size of node at the current zoom; nodes mostly come in a few sizes.
+    HashMap<int64, Image> glyphCache;
+    float glyphCacheZoom;
+    uint32 glyphStamp;
+
+    // What a drag on the panel itself is doing: moving a glyph, or scrolling.
+    uint32 draggedGlyphID;
+    Point<int> dragStartCentre;
+    Point<float> dragStartOrigin;
+
+    void indexPinsOf (FilterComponent&);
+    void unindexPinsOf (FilterComponent&);
+    void removeDeletedFilters();
+
+    bool updateNodeView (NodeView&, AudioProcessorGraph::Node&);
+    void updateVisibleComponents();
+    void createComponentFor (NodeView&);
+    void deleteComponentFor (NodeView&);
+    void setView (float newZoom, Point<float> newOrigin);
+    bool isShowingDetail() const noexcept;
+    NodeView* getGlyphAt (Point<float> canvasPos) const;
+    const SignalTap* getOutputTapFor (uint32 nodeId) const;
+    Image getGlyph (int width, int height);
 
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (GraphEditorPanel)
 };
@@ -110,6 +227,89 @@ private:
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (KeyboardFocusTransferer)
 };
 
+//==============================================================================
+/**
+    Keeps track of how long the graph document takes to paint.
+
+    Frames are painted on the message thread by the software renderer, or on the
+    context's own thread when OpenGL is in use, so the totals are kept in atomics
+    and collected from the message thread.
+*/
+class FrameTimeStats
+{
+public:
+    FrameTimeStats() noexcept;
+
+    void frameStarted() noexcept;
+    void frameFinished() noexcept;
+
+    /** Returns what's been painted since the last call, and starts counting again. */
+    void collect (int& numFrames, double& meanMilliseconds, double& worstMilliseconds) noexcept;
+
+private:
+    double frameStartMs;
+    std::atomic<int> numFrames;
+    std::atomic<int64> totalMicroseconds, worstMicroseconds;
+
+    JUCE_DECLARE_NON_COPYABLE (FrameTimeStats)
+};
+
+//==============================================================================
+/**
+    Sits between the audio device and the callback that plays the graph, and
+    times every block.
+
+    The load, the number of xruns and the device's format are kept in atomics
+    for the message thread to poll. Nothing here locks or allocates, so it can't
+    add to the xruns it's counting.
+
+    It also measures what comes into the graph - the device's inputs, plus the
+    midi from devices and the on-screen keyboard - into the graph's input tap.
+*/
+class AudioCallbackMonitor   : public AudioIODeviceCallback,
+                               public MidiInputCallback,
+                               public MidiKeyboardStateListener
+{
+public:
+    AudioCallbackMonitor (AudioIODeviceCallback& callbackToMonitor, SignalTap& inputTap) noexcept;
+
+    //==============================================================================
+    void audioDeviceIOCallback (const float** inputChannelData, int numInputChannels,
+                                float** outputChannelData, int numOutputChannels,
+                                int numSamples) override;
+    void audioDeviceAboutToStart (AudioIODevice*) override;
+    void audioDeviceStopped() override;
+    void audioDeviceError (const String& errorMessage) override;
+
+    void handleIncomingMidiMessage (MidiInput*, const MidiMessage&) override;
+    void handleNoteOn (MidiKeyboardState*, int midiChannel, int midiNoteNumber, float velocity) override;
+    void handleNoteOff (MidiKeyboardState*, int midiChannel, int midiNoteNumber, float velocity) override;
+
+    //==============================================================================
+    /** The smoothed fraction of each block's duration spent processing it. */
+    float getLoad() const noexcept                                       { return load.load(); }
+
+    /** Blocks that took longer to process than they last, or that arrived late. */
+    int getNumXruns() const noexcept                                     { return numXruns.load(); }
+
+    /** The device's sample rate and block size, or 0 when it isn't running. */
+    double getSampleRate() const noexcept                                { return sampleRate.load(); }
+    int getBufferSize() const noexcept                                   { return bufferSize.load(); }
+
+private:
+    AudioIODeviceCallback& callback;
+    SignalTap& inputTap;
+
+    std::atomic<float> load;
+    std::atomic<int> numXruns, bufferSize;
+    std::atomic<double> sampleRate;
+
+    int64 lastCallbackStart;
+    double ticksPerSecond;
+
+    JUCE_DECLARE_NON_COPYABLE (AudioCallbackMonitor)
+};
+
 //==============================================================================
 /**
     A panel that embeds a GraphEditorPanel with a midi keyboard at the bottom.
@@ -141,8 +341,19 @@ public:
     //==============================================================================
     void releaseGraph();
     
+    //==============================================================================
+    /** Switches the whole document - graph, wires, meters and keyboard - between
+        the software renderer and an OpenGL context.
+    */
+    void setUsingOpenGL (bool shouldUseOpenGL);
+    bool isUsingOpenGL() const noexcept                                  { return openGLContext.isAttached(); }
+
+    /** Shows or hides the frame time readout next to the status bar. */
+    void setFrameTimeVisible (bool shouldBeVisible);
+
     //==============================================================================
     void paint (Graphics& g) override;
+    void paintOverChildren (Graphics& g) override;
     
     void mouseDown(const MouseEvent &event) override;
     
@@ -151,7 +362,10 @@ private:
     //==============================================================================
     AudioDeviceManager* deviceManager;
     AudioProcessorPlayer graphPlayer;
+    AudioCallbackMonitor audioMonitor;
     MidiKeyboardState keyState;
+    OpenGLContext openGLContext;
+    FrameTimeStats frameTimeStats;
 
 public:
     GraphEditorPanel* graphPanel;
@@ -161,6 +375,8 @@ public:
 private:
     Component* keyboardComp;
     Component* statusBar;
+    Component* frameTimeReadout;
+    Component* loadingOverlay;
     KeyboardFocusTransferer* keyboardFocusTransferer;
 
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (GraphDocumentComponent)
@@ -168,8 +384,15 @@ private:
 
 
 //==============================================================================
-/** A desktop window containing a plugin's UI. */
-class PluginWindow  : public DocumentWindow
+/** A desktop window containing a plugin's UI.
+
+    If the window stays minimised for longer than getHiddenEditorTimeout(), the
+    plugin's editor is deleted to free its memory and stop it drawing, and a new
+    one is made as soon as the window is shown again. The window itself stays
+    open, so its position and open state are kept just as they were.
+*/
+class PluginWindow  : public DocumentWindow,
+                      private Timer
 {
 public:
     enum WindowFormatType
@@ -187,16 +410,33 @@ public:
 
     static PluginWindow* getWindowFor (AudioProcessorGraph::Node*, WindowFormatType, AudioProcessorGraph&);
 
-    static void closeCurrentlyOpenWindowsFor (const uint32 nodeId);
+    static void closeCurrentlyOpenWindowsFor (AudioProcessorGraph&, const uint32 nodeId);
+    static void closeCurrentlyOpenWindowsFor (AudioProcessorGraph&);
     static void closeAllCurrentlyOpenWindows();
 
+    /** How many seconds a plugin editor may stay out of sight before it's
+        deleted, in a window or embedded in a PluginEditor. 0 means never.
+    */
+    static void setHiddenEditorTimeout (int seconds) noexcept;
+    static int getHiddenEditorTimeout() noexcept;
+
     void moved() override;
     void closeButtonPressed() override;
+    void minimisationStateChanged (bool isNowMinimised) override;
+
+    bool isEditorSuspended() const noexcept                              { return suspended; }
+    void resumeEditor();
 
 private:
     AudioProcessorGraph& graph;
     AudioProcessorGraph::Node* owner;
     WindowFormatType type;
+    bool suspended;
+    uint32 hiddenSince;
+
+    static AudioProcessorEditor* createEditor (AudioProcessor*, WindowFormatType&);
+    void suspendEditor();
+    void timerCallback() override;
 
     float getDesktopScaleFactor() const override     { return 1.0f; }
 
@@ -204,8 +444,13 @@ private:
 };
 
 //==============================================================================
-/** A desktop window containing a plugin's UI. */
-class PluginEditor  : public Component
+/** A plugin's UI embedded in another component.
+
+    Like PluginWindow, the editor is deleted once it has been out of sight for a
+    while - on a hidden tab, say - and made again when it comes back into view.
+*/
+class PluginEditor  : public Component,
+                      private Timer
 {
 public:
     enum WindowFormatType
@@ -223,17 +468,26 @@ public:
     
     static PluginEditor* getPluginEditorFor (AudioProcessorGraph::Node*, WindowFormatType, AudioProcessorGraph&);
     
-    static void closePluginEditorsFor (const uint32 nodeId);
+    static void closePluginEditorsFor (AudioProcessorGraph&, const uint32 nodeId);
+    static void closePluginEditorsFor (AudioProcessorGraph&);
     static void closeAllPluginEditors();
     void clearContentComponent();
     static void* deleteComponent (void* userData);
     static void closeProcessor (AudioProcessor* processor);
     void resized() override;
     
+    bool isEditorSuspended() const noexcept                              { return suspended; }
+    void resumeEditor();
+    
 private:
     AudioProcessorGraph& graph;
     AudioProcessorGraph::Node* owner;
     WindowFormatType type;
+    bool suspended;
+    uint32 hiddenSince;
+    
+    static AudioProcessorEditor* createEditor (AudioProcessor*, WindowFormatType&);
+    void timerCallback() override;
     
     float getDesktopScaleFactor() const override     { return 1.0f; }
     
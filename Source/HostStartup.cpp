@@ -25,6 +25,7 @@
 #include "../JuceLibraryCode/JuceHeader.h"
 #include "MainHostWindow.h"
 #include "InternalFilters.h"
+#include "ConvolutionProcessor.h"
 
 #if ! (JUCE_PLUGINHOST_VST || JUCE_PLUGINHOST_VST3 || JUCE_PLUGINHOST_AU)
  #error "If you're building the audio plugin host, you probably want to enable VST and/or AU support"
@@ -39,8 +40,17 @@ public:
     //ScopedPointer<Icons> icons;
     PluginHostApp() {}
     
-    void initialise (const String&) override
+    void initialise (const String& commandLine) override
     {
+        // "--benchmark-convolution" prints the convolution engine's CPU use against IR length and quits.
+        if (commandLine.contains ("--benchmark-convolution"))
+        {
+            fputs (ConvolutionProcessor::runBenchmark().toRawUTF8(), stdout);
+            fflush (stdout);
+            quit();
+            return;
+        }
+
         // initialise our settings file..
 
         PropertiesFile::Options options;
@@ -97,7 +107,7 @@ public:
         if (fileToOpen.existsAsFile())
             if (GraphDocumentComponent* graph = mainWindow->getGraphEditor())
                 if (FilterGraph* ioGraph = graph->graph.get())
-                    ioGraph->loadFrom (fileToOpen, true);
+                    ioGraph->loadFromAsync (fileToOpen, true);
     }
 
     void shutdown() override
@@ -24,11 +24,23 @@
 
 #include "../JuceLibraryCode/JuceHeader.h"
 #include "InternalFilters.h"
+#include "InternalProcessors.h"
+#include "FilePlayerProcessor.h"
+#include "RecorderProcessor.h"
+#include "MeterProcessor.h"
+#include "AnalyzerProcessor.h"
+#include "ConvolutionProcessor.h"
+#include "RackProcessor.h"
+#include "OversamplingProcessor.h"
+#include "SampleRateBridgeProcessor.h"
+#include "GeneratorProcessor.h"
+#include "LatencyProbeProcessor.h"
 #include "FilterGraph.h"
 
 
 //==============================================================================
-InternalPluginFormat::InternalPluginFormat()
+InternalPluginFormat::InternalPluginFormat (AudioPluginFormatManager* formatManager_)
+    : formatManager (formatManager_)
 {
     {
         AudioProcessorGraph::AudioGraphIOProcessor p (AudioProcessorGraph::AudioGraphIOProcessor::audioOutputNode);
@@ -44,6 +56,23 @@ InternalPluginFormat::InternalPluginFormat()
         AudioProcessorGraph::AudioGraphIOProcessor p (AudioProcessorGraph::AudioGraphIOProcessor::midiInputNode);
         p.fillInPluginDescription (midiInDesc);
     }
+
+    // Some of these are expensive to build (file formats, FFTs, threads) and some need a
+    // format manager, so none of them is created just to describe it.
+    InternalPlugin::fillInDescription (gainDesc, GainProcessor::gainName, 2, 2);
+    InternalPlugin::fillInDescription (panDesc, PanProcessor::panName, 2, 2);
+    InternalPlugin::fillInDescription (mixerDesc, MixerProcessor::mixerName, 2, 2);
+    InternalPlugin::fillInDescription (filePlayerDesc, FilePlayerProcessor::filePlayerName, 0, 2);
+    InternalPlugin::fillInDescription (recorderDesc, RecorderProcessor::recorderName, 2, 2);
+    InternalPlugin::fillInDescription (meterDesc, MeterProcessor::meterName, 2, 2);
+    InternalPlugin::fillInDescription (analyzerDesc, AnalyzerProcessor::analyzerName, 2, 2);
+    InternalPlugin::fillInDescription (convolutionDesc, ConvolutionProcessor::convolutionName, 2, 2);
+    InternalPlugin::fillInDescription (rackDesc, RackProcessor::rackName, 2, 2);
+    InternalPlugin::fillInDescription (oversamplerDesc, OversamplingProcessor::oversamplerName, 2, 2);
+    InternalPlugin::fillInDescription (bridgeDesc, SampleRateBridgeProcessor::bridgeName, 2, 2);
+    InternalPlugin::fillInDescription (generatorDesc, GeneratorProcessor::generatorName, 0, 2);
+    InternalPlugin::fillInDescription (probeSendDesc, LatencyProbeSendProcessor::probeSendName, 0, 2);
+    InternalPlugin::fillInDescription (probeReceiveDesc, LatencyProbeReceiveProcessor::probeReceiveName, 2, 2);
 }
 
 void InternalPluginFormat::createPluginInstance (const PluginDescription& desc,
@@ -62,6 +91,48 @@ void InternalPluginFormat::createPluginInstance (const PluginDescription& desc,
     if (desc.name == midiInDesc.name)
         retval = new AudioProcessorGraph::AudioGraphIOProcessor (AudioProcessorGraph::AudioGraphIOProcessor::midiInputNode);
 
+    if (desc.name == gainDesc.name)
+        retval = new GainProcessor();
+
+    if (desc.name == panDesc.name)
+        retval = new PanProcessor();
+
+    if (desc.name == mixerDesc.name)
+        retval = new MixerProcessor();
+
+    if (desc.name == filePlayerDesc.name)
+        retval = new FilePlayerProcessor();
+
+    if (desc.name == recorderDesc.name)
+        retval = new RecorderProcessor();
+
+    if (desc.name == meterDesc.name)
+        retval = new MeterProcessor();
+
+    if (desc.name == analyzerDesc.name)
+        retval = new AnalyzerProcessor();
+
+    if (desc.name == convolutionDesc.name)
+        retval = new ConvolutionProcessor();
+
+    if (desc.name == rackDesc.name && formatManager != nullptr)
+        retval = new RackProcessor (*formatManager);
+
+    if (desc.name == oversamplerDesc.name && formatManager != nullptr)
+        retval = new OversamplingProcessor (*formatManager);
+
+    if (desc.name == bridgeDesc.name && formatManager != nullptr)
+        retval = new SampleRateBridgeProcessor (*formatManager);
+
+    if (desc.name == generatorDesc.name)
+        retval = new GeneratorProcessor();
+
+    if (desc.name == probeSendDesc.name)
+        retval = new LatencyProbeSendProcessor();
+
+    if (desc.name == probeReceiveDesc.name)
+        retval = new LatencyProbeReceiveProcessor();
+
     callback (userData, retval, retval == nullptr ? NEEDS_TRANS ("Invalid internal filter name") : String());
 }
 
@@ -77,6 +148,20 @@ const PluginDescription* InternalPluginFormat::getDescriptionFor (const Internal
         case audioInputFilter:      return &audioInDesc;
         case audioOutputFilter:     return &audioOutDesc;
         case midiInputFilter:       return &midiInDesc;
+        case gainFilter:            return &gainDesc;
+        case panFilter:             return &panDesc;
+        case mixerFilter:           return &mixerDesc;
+        case filePlayerFilter:      return &filePlayerDesc;
+        case recorderFilter:        return &recorderDesc;
+        case meterFilter:           return &meterDesc;
+        case analyzerFilter:        return &analyzerDesc;
+        case convolutionFilter:     return &convolutionDesc;
+        case rackFilter:            return &rackDesc;
+        case oversamplerFilter:     return &oversamplerDesc;
+        case bridgeFilter:          return &bridgeDesc;
+        case generatorFilter:       return &generatorDesc;
+        case probeSendFilter:       return &probeSendDesc;
+        case probeReceiveFilter:    return &probeReceiveDesc;
         default:                    break;
     }
 
@@ -36,7 +36,10 @@ class InternalPluginFormat   : public AudioPluginFormat
 {
 public:
     //==============================================================================
-    InternalPluginFormat();
+    /** Racks, bridges and oversamplers need a format manager to create the plugins
+        inside them; without one they're still listed, but can't be instantiated.
+    */
+    InternalPluginFormat (AudioPluginFormatManager* formatManager = nullptr);
     ~InternalPluginFormat() {}
 
     //==============================================================================
@@ -45,6 +48,20 @@ public:
         audioInputFilter = 0,
         audioOutputFilter,
         midiInputFilter,
+        gainFilter,
+        panFilter,
+        mixerFilter,
+        filePlayerFilter,
+        recorderFilter,
+        meterFilter,
+        analyzerFilter,
+        convolutionFilter,
+        rackFilter,
+        oversamplerFilter,
+        bridgeFilter,
+        generatorFilter,
+        probeSendFilter,
+        probeReceiveFilter,
 
         endOfFilterTypes
     };
@@ -74,9 +91,25 @@ private:
     bool requiresUnblockedMessageThreadDuringCreation (const PluginDescription&) const noexcept override;
 private:
     //==============================================================================
+    AudioPluginFormatManager* formatManager;
+
     PluginDescription audioInDesc;
     PluginDescription audioOutDesc;
     PluginDescription midiInDesc;
+    PluginDescription gainDesc;
+    PluginDescription panDesc;
+    PluginDescription mixerDesc;
+    PluginDescription filePlayerDesc;
+    PluginDescription recorderDesc;
+    PluginDescription meterDesc;
+    PluginDescription analyzerDesc;
+    PluginDescription convolutionDesc;
+    PluginDescription rackDesc;
+    PluginDescription oversamplerDesc;
+    PluginDescription bridgeDesc;
+    PluginDescription generatorDesc;
+    PluginDescription probeSendDesc;
+    PluginDescription probeReceiveDesc;
 };
 
 
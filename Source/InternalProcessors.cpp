@@ -0,0 +1,349 @@
+/*
+  ==============================================================================
+
+    InternalProcessors.cpp
+    Middle
+
+  ==============================================================================
+*/
+
+#include "../JuceLibraryCode/JuceHeader.h"
+#include "InternalProcessors.h"
+
+
+//==============================================================================
+InternalPlugin::InternalPlugin (const String& name_, const BusesProperties& ioLayouts)
+    : AudioPluginInstance (ioLayouts),
+      rampBufferSize (0),
+      name (name_)
+{
+}
+
+void InternalPlugin::fillInPluginDescription (PluginDescription& d) const
+{
+    fillInDescription (d, name, getTotalNumInputChannels(), getTotalNumOutputChannels());
+}
+
+void InternalPlugin::fillInDescription (PluginDescription& d, const String& pluginName,
+                                        int numInputChannels, int numOutputChannels)
+{
+    d.name              = pluginName;
+    d.descriptiveName   = pluginName;
+    d.pluginFormatName  = "Internal";
+    d.category          = "Utility";
+    d.manufacturerName  = "Middle";
+    d.version           = ProjectInfo::versionString;
+    d.fileOrIdentifier  = pluginName;
+    d.uid               = pluginName.hashCode();
+    d.isInstrument      = false;
+    d.numInputChannels  = numInputChannels;
+    d.numOutputChannels = numOutputChannels;
+}
+
+XmlElement* InternalPlugin::createStateXml() const
+{
+    XmlElement* const xml = new XmlElement ("INTERNALSTATE");
+
+    const OwnedArray<AudioProcessorParameter>& params = getParameters();
+
+    for (int i = 0; i < params.size(); ++i)
+        if (AudioProcessorParameterWithID* p = dynamic_cast<AudioProcessorParameterWithID*> (params.getUnchecked (i)))
+            xml->setAttribute (p->paramID, p->getValue());
+
+    writeExtraState (*xml);
+    return xml;
+}
+
+void InternalPlugin::restoreStateFromXml (const XmlElement& xml)
+{
+    if (! xml.hasTagName ("INTERNALSTATE"))
+        return;
+
+    const OwnedArray<AudioProcessorParameter>& params = getParameters();
+
+    for (int i = 0; i < params.size(); ++i)
+        if (AudioProcessorParameterWithID* p = dynamic_cast<AudioProcessorParameterWithID*> (params.getUnchecked (i)))
+            if (xml.hasAttribute (p->paramID))
+                p->setValueNotifyingHost ((float) xml.getDoubleAttribute (p->paramID));
+
+    readExtraState (xml);
+}
+
+void InternalPlugin::getStateInformation (MemoryBlock& destData)
+{
+    const ScopedPointer<XmlElement> xml (createStateXml());
+    copyXmlToBinary (*xml, destData);
+}
+
+void InternalPlugin::setStateInformation (const void* data, int sizeInBytes)
+{
+    const ScopedPointer<XmlElement> xml (getXmlFromBinary (data, sizeInBytes));
+
+    if (xml != nullptr)
+        restoreStateFromXml (*xml);
+}
+
+void InternalPlugin::processBlock (AudioBuffer<float>& buffer, MidiBuffer& midiMessages)
+{
+    renderBlock (buffer, midiMessages);
+
+    outputTap.measure (buffer, getTotalNumOutputChannels());
+    outputTap.countMidi (midiMessages);
+}
+
+void InternalPlugin::ensureRampBuffer (const int numSamples)
+{
+    if (numSamples > rampBufferSize)
+    {
+        rampBuffer.allocate ((size_t) numSamples, false);
+        rampBufferSize = numSamples;
+    }
+}
+
+void InternalPlugin::applySmoothedGain (SmoothedGain& gain, AudioBuffer<float>& buffer,
+                                        const int startChannel, const int numChannels)
+{
+    const int numSamples = buffer.getNumSamples();
+
+    if (gain.isRamping())
+    {
+        // The ramp buffer is sized in prepareToPlay(), so a bigger block is ramped in pieces.
+        for (int pos = 0; pos < numSamples && rampBufferSize > 0;)
+        {
+            const int num = jmin (numSamples - pos, rampBufferSize);
+            gain.fillRamp (rampBuffer, num);
+
+            for (int ch = startChannel; ch < startChannel + numChannels; ++ch)
+                FloatVectorOperations::multiply (buffer.getWritePointer (ch, pos), rampBuffer, num);
+
+            pos += num;
+        }
+    }
+    else
+    {
+        const float g = gain.getCurrent();
+
+        if (g == 1.0f)
+            return;
+
+        for (int ch = startChannel; ch < startChannel + numChannels; ++ch)
+        {
+            if (g == 0.0f)
+                buffer.clear (ch, 0, numSamples);
+            else
+                FloatVectorOperations::multiply (buffer.getWritePointer (ch), g, numSamples);
+        }
+    }
+}
+
+//==============================================================================
+static const double parameterRampSeconds = 0.05;
+
+static bool isMainBusOnlyLayout (const AudioProcessor::BusesLayout& layouts)
+{
+    return layouts.inputBuses.size() == 1 && layouts.outputBuses.size() == 1
+            && ! layouts.getMainInputChannelSet().isDisabled()
+            && ! layouts.getMainOutputChannelSet().isDisabled();
+}
+
+//==============================================================================
+const char* const GainProcessor::gainName = "Gain";
+
+GainProcessor::GainProcessor()
+    : InternalPlugin (gainName, BusesProperties().withInput  ("Input",  AudioChannelSet::stereo())
+                                                 .withOutput ("Output", AudioChannelSet::stereo()))
+{
+    addParameter (gainDb = new AudioParameterFloat ("gain", "Gain (dB)",
+                                                    NormalisableRange<float> (-60.0f, 12.0f), 0.0f));
+}
+
+bool GainProcessor::isBusesLayoutSupported (const BusesLayout& layouts) const
+{
+    return isMainBusOnlyLayout (layouts)
+            && layouts.getMainInputChannelSet() == layouts.getMainOutputChannelSet();
+}
+
+void GainProcessor::prepareToPlay (double sampleRate, int maximumExpectedSamplesPerBlock)
+{
+    gain.prepare (sampleRate, parameterRampSeconds);
+    gain.setImmediately (Decibels::decibelsToGain (gainDb->get(), -60.0f));
+    ensureRampBuffer (maximumExpectedSamplesPerBlock);
+}
+
+void GainProcessor::releaseResources()
+{
+}
+
+void GainProcessor::renderBlock (AudioBuffer<float>& buffer, MidiBuffer&)
+{
+    gain.setTarget (Decibels::decibelsToGain (gainDb->get(), -60.0f));
+    applySmoothedGain (gain, buffer, 0, getTotalNumOutputChannels());
+}
+
+//==============================================================================
+const char* const PanProcessor::panName = "Stereo Pan";
+
+PanProcessor::PanProcessor()
+    : InternalPlugin (panName, BusesProperties().withInput  ("Input",  AudioChannelSet::stereo())
+                                                .withOutput ("Output", AudioChannelSet::stereo()))
+{
+    addParameter (pan = new AudioParameterFloat ("pan", "Pan", NormalisableRange<float> (-1.0f, 1.0f), 0.0f));
+}
+
+bool PanProcessor::isBusesLayoutSupported (const BusesLayout& layouts) const
+{
+    const AudioChannelSet& in = layouts.getMainInputChannelSet();
+
+    return isMainBusOnlyLayout (layouts)
+            && layouts.getMainOutputChannelSet() == AudioChannelSet::stereo()
+            && (in == AudioChannelSet::mono() || in == AudioChannelSet::stereo());
+}
+
+void PanProcessor::getGainsForPan (const float panValue, const bool isMonoInput,
+                                   float& left, float& right) const noexcept
+{
+    if (isMonoInput)
+    {
+        const float angle = (panValue + 1.0f) * float_Pi * 0.25f;
+        left  = std::cos (angle);
+        right = std::sin (angle);
+    }
+    else
+    {
+        left  = panValue > 0.0f ? std::cos (panValue * float_Pi * 0.5f)  : 1.0f;
+        right = panValue < 0.0f ? std::cos (-panValue * float_Pi * 0.5f) : 1.0f;
+    }
+}
+
+void PanProcessor::prepareToPlay (double sampleRate, int maximumExpectedSamplesPerBlock)
+{
+    float left, right;
+    getGainsForPan (pan->get(), getTotalNumInputChannels() == 1, left, right);
+
+    leftGain.prepare (sampleRate, parameterRampSeconds);
+    rightGain.prepare (sampleRate, parameterRampSeconds);
+    leftGain.setImmediately (left);
+    rightGain.setImmediately (right);
+
+    ensureRampBuffer (maximumExpectedSamplesPerBlock);
+}
+
+void PanProcessor::releaseResources()
+{
+}
+
+void PanProcessor::renderBlock (AudioBuffer<float>& buffer, MidiBuffer&)
+{
+    const bool isMonoInput = getTotalNumInputChannels() == 1;
+
+    if (isMonoInput)
+        buffer.copyFrom (1, 0, buffer, 0, 0, buffer.getNumSamples());
+
+    float left, right;
+    getGainsForPan (pan->get(), isMonoInput, left, right);
+
+    leftGain.setTarget (left);
+    rightGain.setTarget (right);
+
+    applySmoothedGain (leftGain,  buffer, 0, 1);
+    applySmoothedGain (rightGain, buffer, 1, 1);
+}
+
+//==============================================================================
+const char* const MixerProcessor::mixerName = "Matrix Mixer";
+
+MixerProcessor::MixerProcessor()
+    : InternalPlugin (mixerName, BusesProperties().withInput  ("Input",  AudioChannelSet::stereo())
+                                                  .withOutput ("Output", AudioChannelSet::stereo()))
+{
+    for (int in = 0; in < maxChannels; ++in)
+    {
+        for (int out = 0; out < maxChannels; ++out)
+        {
+            const String paramID   ("in" + String (in + 1) + "out" + String (out + 1));
+            const String paramName ("In " + String (in + 1) + " > Out " + String (out + 1));
+
+            addParameter (crosspoints[in][out] = new AudioParameterFloat (paramID, paramName, NormalisableRange<float> (0.0f, 1.0f),
+                                                                          in == out ? 1.0f : 0.0f));
+        }
+    }
+}
+
+bool MixerProcessor::isBusesLayoutSupported (const BusesLayout& layouts) const
+{
+    return isMainBusOnlyLayout (layouts)
+            && layouts.getMainInputChannelSet().size()  <= maxChannels
+            && layouts.getMainOutputChannelSet().size() <= maxChannels;
+}
+
+void MixerProcessor::prepareToPlay (double sampleRate, int maximumExpectedSamplesPerBlock)
+{
+    for (int in = 0; in < maxChannels; ++in)
+    {
+        for (int out = 0; out < maxChannels; ++out)
+        {
+            crosspointGains[in][out].prepare (sampleRate, parameterRampSeconds);
+            crosspointGains[in][out].setImmediately (crosspoints[in][out]->get());
+        }
+    }
+
+    mixBuffer.setSize (maxChannels, maximumExpectedSamplesPerBlock);
+    ensureRampBuffer (maximumExpectedSamplesPerBlock);
+}
+
+void MixerProcessor::releaseResources()
+{
+    mixBuffer.setSize (0, 0);
+}
+
+void MixerProcessor::renderBlock (AudioBuffer<float>& buffer, MidiBuffer&)
+{
+    // Both scratch buffers are sized in prepareToPlay(), for every channel the
+    // mixer can have, so a bigger block than promised is mixed in pieces.
+    const int chunkSize = jmin (mixBuffer.getNumSamples(), rampBufferSize);
+    const int numSamples = buffer.getNumSamples();
+
+    if (chunkSize <= 0)
+        return;
+
+    for (int pos = 0; pos < numSamples;)
+    {
+        const int num = jmin (numSamples - pos, chunkSize);
+        mixChunk (buffer, pos, num);
+        pos += num;
+    }
+}
+
+void MixerProcessor::mixChunk (AudioBuffer<float>& buffer, const int startSample, const int numSamples)
+{
+    const int numIns = getTotalNumInputChannels();
+    const int numOuts = getTotalNumOutputChannels();
+
+    for (int out = 0; out < numOuts; ++out)
+    {
+        float* const dest = mixBuffer.getWritePointer (out);
+        FloatVectorOperations::clear (dest, numSamples);
+
+        for (int in = 0; in < numIns; ++in)
+        {
+            SmoothedGain& gain = crosspointGains[in][out];
+            gain.setTarget (crosspoints[in][out]->get());
+
+            const float* const src = buffer.getReadPointer (in, startSample);
+
+            if (gain.isRamping())
+            {
+                gain.fillRamp (rampBuffer, numSamples);
+                FloatVectorOperations::multiply (rampBuffer, src, numSamples);
+                FloatVectorOperations::add (dest, rampBuffer, numSamples);
+            }
+            else if (gain.getCurrent() != 0.0f)
+            {
+                FloatVectorOperations::addWithMultiply (dest, src, gain.getCurrent(), numSamples);
+            }
+        }
+    }
+
+    for (int out = 0; out < numOuts; ++out)
+        buffer.copyFrom (out, startSample, mixBuffer, out, 0, numSamples);
+}
@@ -0,0 +1,241 @@
+/*
+  ==============================================================================
+
+    InternalProcessors.h
+    Middle
+
+  ==============================================================================
+*/
+
+#ifndef __INTERNALPROCESSORS_JUCEHEADER__
+#define __INTERNALPROCESSORS_JUCEHEADER__
+
+#include "SignalTap.h"
+
+//==============================================================================
+/**
+    A gain value that ramps linearly towards its target, so parameter changes
+    don't click. The ramp for a block is written into a buffer once and then
+    applied to every channel with FloatVectorOperations.
+*/
+class SmoothedGain
+{
+public:
+    SmoothedGain() noexcept  : current (1.0f), target (1.0f), step (0.0f), stepsToTarget (0), rampLength (0) {}
+
+    void prepare (double sampleRate, double rampSeconds) noexcept
+    {
+        rampLength = jmax (1, roundToInt (sampleRate * rampSeconds));
+        current = target;
+        stepsToTarget = 0;
+    }
+
+    void setTarget (float newTarget) noexcept
+    {
+        if (newTarget != target)
+        {
+            target = newTarget;
+            stepsToTarget = rampLength;
+            step = (target - current) / (float) stepsToTarget;
+        }
+    }
+
+    /** Snaps straight to a value, e.g. when the state is restored. */
+    void setImmediately (float newValue) noexcept
+    {
+        current = target = newValue;
+        stepsToTarget = 0;
+    }
+
+    bool isRamping() const noexcept        { return stepsToTarget > 0; }
+    float getCurrent() const noexcept      { return current; }
+
+    /** Writes the next numSamples gain values into dest, advancing the ramp. */
+    void fillRamp (float* dest, int numSamples) noexcept
+    {
+        const int numRamped = jmin (numSamples, stepsToTarget);
+
+        for (int i = 0; i < numRamped; ++i)
+            dest[i] = (current += step);
+
+        stepsToTarget -= numRamped;
+
+        if (stepsToTarget == 0)
+            current = target;
+
+        if (numRamped < numSamples)
+            FloatVectorOperations::fill (dest + numRamped, current, numSamples - numRamped);
+    }
+
+private:
+    float current, target, step;
+    int stepsToTarget, rampLength;
+};
+
+//==============================================================================
+/**
+    Base class for the processors that InternalPluginFormat creates itself.
+
+    It fills in a PluginDescription that InternalPluginFormat can match by name,
+    and stores every AudioProcessorParameterWithID as an attribute of a small xml
+    blob, so the node's state round-trips through the FILTER/STATE element of a
+    saved graph like any other plugin's.
+
+    Subclasses do their processing in renderBlock(); processBlock() calls it and
+    then measures what's left in the buffer, so the editor can show the level on
+    the wires leaving the node.
+*/
+class InternalPlugin   : public AudioPluginInstance
+{
+public:
+    //==============================================================================
+    InternalPlugin (const String& name, const BusesProperties& ioLayouts);
+    ~InternalPlugin() {}
+
+    //==============================================================================
+    const String getName() const override                                { return name; }
+    void fillInPluginDescription (PluginDescription&) const override;
+
+    /** Fills in a description for an internal type without having to create one,
+        for processors that can't be built on their own.
+    */
+    static void fillInDescription (PluginDescription&, const String& pluginName,
+                                   int numInputChannels, int numOutputChannels);
+
+    double getTailLengthSeconds() const override                        { return 0.0; }
+    bool acceptsMidi() const override                                   { return false; }
+    bool producesMidi() const override                                  { return false; }
+
+    AudioProcessorEditor* createEditor() override                       { return new GenericAudioProcessorEditor (this); }
+    bool hasEditor() const override                                     { return true; }
+
+    int getNumPrograms() override                                       { return 1; }
+    int getCurrentProgram() override                                    { return 0; }
+    void setCurrentProgram (int) override                               {}
+    const String getProgramName (int) override                          { return String(); }
+    void changeProgramName (int, const String&) override                {}
+
+    void getStateInformation (MemoryBlock& destData) override;
+    void setStateInformation (const void* data, int sizeInBytes) override;
+
+    /** The same state as an INTERNALSTATE element, which a saved graph nests as it is. */
+    XmlElement* createStateXml() const;
+    void restoreStateFromXml (const XmlElement&);
+
+    //==============================================================================
+    void processBlock (AudioBuffer<float>&, MidiBuffer&) override final;
+
+    /** What this node last sent out of each output channel and its midi output. */
+    const SignalTap& getOutputTap() const noexcept                       { return outputTap; }
+
+protected:
+    //==============================================================================
+    /** Processes a block, just like processBlock() would. */
+    virtual void renderBlock (AudioBuffer<float>&, MidiBuffer&) = 0;
+
+    /** Lets subclasses save anything that isn't a parameter (file paths, etc). */
+    virtual void writeExtraState (XmlElement&) const                     {}
+    virtual void readExtraState (const XmlElement&)                      {}
+
+    /** Multiplies a range of channels by a smoothed gain, using a shared ramp buffer
+        while the gain is moving and a single vector multiply once it has settled.
+    */
+    void applySmoothedGain (SmoothedGain&, AudioBuffer<float>&, int startChannel, int numChannels);
+
+    /** Makes sure the scratch ramp buffer can hold a block; call from prepareToPlay(). */
+    void ensureRampBuffer (int numSamples);
+
+    HeapBlock<float> rampBuffer;
+    int rampBufferSize;
+
+private:
+    const String name;
+    SignalTap outputTap;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (InternalPlugin)
+};
+
+//==============================================================================
+/** A simple gain stage in dB, for any channel count. */
+class GainProcessor   : public InternalPlugin
+{
+public:
+    GainProcessor();
+
+    static const char* const gainName;
+
+    void prepareToPlay (double sampleRate, int maximumExpectedSamplesPerBlock) override;
+    void releaseResources() override;
+    void renderBlock (AudioBuffer<float>&, MidiBuffer&) override;
+
+    bool isBusesLayoutSupported (const BusesLayout&) const override;
+
+private:
+    AudioParameterFloat* gainDb;
+    SmoothedGain gain;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (GainProcessor)
+};
+
+//==============================================================================
+/**
+    A constant-power stereo panner.
+
+    With a mono input the signal is placed between the two outputs; with a stereo
+    input it acts as a balance control and attenuates the opposite side.
+*/
+class PanProcessor   : public InternalPlugin
+{
+public:
+    PanProcessor();
+
+    static const char* const panName;
+
+    void prepareToPlay (double sampleRate, int maximumExpectedSamplesPerBlock) override;
+    void releaseResources() override;
+    void renderBlock (AudioBuffer<float>&, MidiBuffer&) override;
+
+    bool isBusesLayoutSupported (const BusesLayout&) const override;
+
+private:
+    AudioParameterFloat* pan;
+    SmoothedGain leftGain, rightGain;
+
+    void getGainsForPan (float panValue, bool isMonoInput, float& left, float& right) const noexcept;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (PanProcessor)
+};
+
+//==============================================================================
+/**
+    An N-to-M matrix mixer. Each output channel is the sum of every input channel
+    scaled by its own crosspoint gain. The bus layout can be changed from the
+    node's "Configure Audio I/O" window, up to maxChannels on either side.
+*/
+class MixerProcessor   : public InternalPlugin
+{
+public:
+    MixerProcessor();
+
+    static const char* const mixerName;
+
+    enum { maxChannels = 8 };
+
+    void prepareToPlay (double sampleRate, int maximumExpectedSamplesPerBlock) override;
+    void releaseResources() override;
+    void renderBlock (AudioBuffer<float>&, MidiBuffer&) override;
+
+    bool isBusesLayoutSupported (const BusesLayout&) const override;
+
+private:
+    AudioParameterFloat* crosspoints[maxChannels][maxChannels];
+    SmoothedGain crosspointGains[maxChannels][maxChannels];
+    AudioBuffer<float> mixBuffer;
+
+    void mixChunk (AudioBuffer<float>&, int startSample, int numSamples);
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (MixerProcessor)
+};
+
+
+#endif   // __INTERNALPROCESSORS_JUCEHEADER__
@@ -0,0 +1,301 @@
+/*
+  ==============================================================================
+
+    LatencyProbeProcessor.cpp
+    Middle
+
+  ==============================================================================
+*/
+
+#include "../JuceLibraryCode/JuceHeader.h"
+#include "LatencyProbeProcessor.h"
+
+
+//==============================================================================
+/**
+    What a sender publishes for its receivers. Both halves run on the audio
+    thread, one after the other, but the atomics keep it well-defined if a host
+    ever processes them on different threads.
+*/
+struct ProbeLink
+{
+    ProbeLink() noexcept  : blockStart (0), impulseTime (-1), lastBlockSize (0), generation (0) {}
+
+    std::atomic<int64> blockStart, impulseTime;
+    std::atomic<int> lastBlockSize;
+    std::atomic<uint32> generation;
+};
+
+static ProbeLink probeLinks[LatencyProbeSendProcessor::numLinks];
+
+static ProbeLink& getProbeLink (const AudioParameterInt& linkParam) noexcept
+{
+    return probeLinks[jlimit (1, (int) LatencyProbeSendProcessor::numLinks, linkParam.get()) - 1];
+}
+
+//==============================================================================
+const char* const LatencyProbeSendProcessor::probeSendName = "Probe Send";
+
+LatencyProbeSendProcessor::LatencyProbeSendProcessor()
+    : InternalPlugin (probeSendName, BusesProperties().withOutput ("Output", AudioChannelSet::stereo())),
+      currentSampleRate (44100.0),
+      samplePosition (0),
+      nextImpulse (0)
+{
+    addParameter (link = new AudioParameterInt ("link", "Link", 1, numLinks, 1));
+    addParameter (intervalSeconds = new AudioParameterFloat ("interval", "Interval (s)",
+                                                             NormalisableRange<float> (0.1f, 5.0f), 1.0f));
+}
+
+bool LatencyProbeSendProcessor::isBusesLayoutSupported (const BusesLayout& layouts) const
+{
+    return layouts.inputBuses.size() == 0 && layouts.outputBuses.size() == 1
+            && ! layouts.getMainOutputChannelSet().isDisabled();
+}
+
+void LatencyProbeSendProcessor::prepareToPlay (double sampleRate, int)
+{
+    currentSampleRate = sampleRate;
+    samplePosition = 0;
+    nextImpulse = 0;
+
+    // The generation is left alone, so a receiver that's already been prepared
+    // still knows whether we've run yet in each callback.
+    ProbeLink& l = getProbeLink (*link);
+    l.blockStart = 0;
+    l.lastBlockSize = 0;
+    l.impulseTime = -1;
+}
+
+void LatencyProbeSendProcessor::releaseResources()
+{
+}
+
+void LatencyProbeSendProcessor::renderBlock (AudioBuffer<float>& buffer, MidiBuffer&)
+{
+    const int numSamples = buffer.getNumSamples();
+    const int64 interval = jmax ((int64) 1, (int64) (intervalSeconds->get() * currentSampleRate));
+    ProbeLink& l = getProbeLink (*link);
+
+    buffer.clear();
+
+    while (nextImpulse < samplePosition + numSamples)
+    {
+        const int offset = (int) (nextImpulse - samplePosition);
+
+        for (int ch = 0; ch < buffer.getNumChannels(); ++ch)
+            buffer.setSample (ch, offset, 1.0f);
+
+        l.impulseTime = nextImpulse;
+        nextImpulse += interval;
+    }
+
+    l.blockStart = samplePosition;
+    l.lastBlockSize = numSamples;
+    ++l.generation;
+
+    samplePosition += numSamples;
+}
+
+//==============================================================================
+class LatencyProbeEditor   : public AudioProcessorEditor,
+                             private Button::Listener,
+                             private Timer
+{
+public:
+    LatencyProbeEditor (LatencyProbeReceiveProcessor& p)
+        : AudioProcessorEditor (p),
+          probe (p),
+          parameterEditor (&p),
+          resetButton ("Reset")
+    {
+        addAndMakeVisible (parameterEditor);
+        addAndMakeVisible (resultsLabel);
+        addAndMakeVisible (resetButton);
+
+        resultsLabel.setJustificationType (Justification::topLeft);
+        resultsLabel.setFont (Font (Font::getDefaultMonospacedFontName(), 13.0f, Font::plain));
+        resetButton.addListener (this);
+
+        setSize (jmax (320, parameterEditor.getWidth()), parameterEditor.getHeight() + 96);
+        timerCallback();
+        startTimerHz (10);
+    }
+
+    void paint (Graphics& g) override
+    {
+        g.fillAll (getLookAndFeel().findColour (ResizableWindow::backgroundColourId));
+    }
+
+    void resized() override
+    {
+        Rectangle<int> r (getLocalBounds());
+
+        parameterEditor.setBounds (r.removeFromTop (parameterEditor.getHeight()));
+        r.reduce (8, 8);
+        resetButton.setBounds (r.removeFromBottom (24).removeFromLeft (80));
+        resultsLabel.setBounds (r);
+    }
+
+private:
+    LatencyProbeReceiveProcessor& probe;
+    GenericAudioProcessorEditor parameterEditor;
+    Label resultsLabel;
+    TextButton resetButton;
+
+    String describe (int numSamples) const
+    {
+        if (numSamples < 0)
+            return "-";
+
+        const double sampleRate = probe.getMeasuredSampleRate();
+
+        return String (numSamples) + " samples"
+                 + (sampleRate > 0 ? " (" + String (numSamples * 1000.0 / sampleRate, 2) + " ms)" : String());
+    }
+
+    void buttonClicked (Button*) override
+    {
+        probe.resetMeasurements();
+    }
+
+    void timerCallback() override
+    {
+        resultsLabel.setText ("Last:     " + describe (probe.getLastLatency()) + "\n"
+                              "Min/Max:  " + describe (probe.getMinLatency()) + " / " + describe (probe.getMaxLatency()) + "\n"
+                              "Received: " + String (probe.getNumMeasurements())
+                                + "   Missed: " + String (probe.getNumMissed()),
+                              dontSendNotification);
+    }
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (LatencyProbeEditor)
+};
+
+//==============================================================================
+const char* const LatencyProbeReceiveProcessor::probeReceiveName = "Probe Receive";
+
+LatencyProbeReceiveProcessor::LatencyProbeReceiveProcessor()
+    : InternalPlugin (probeReceiveName, BusesProperties().withInput  ("Input",  AudioChannelSet::stereo())
+                                                         .withOutput ("Output", AudioChannelSet::stereo())),
+      currentSampleRate (0.0),
+      resetRequested (false),
+      currentLink (0),
+      lastGeneration (0),
+      lastSeenImpulse (-1),
+      lastMatchedImpulse (-1)
+{
+    addParameter (link = new AudioParameterInt ("link", "Link", 1, LatencyProbeSendProcessor::numLinks, 1));
+    addParameter (thresholdDb = new AudioParameterFloat ("threshold", "Threshold (dB)",
+                                                         NormalisableRange<float> (-60.0f, 0.0f), -20.0f));
+    clearMeasurements();
+}
+
+bool LatencyProbeReceiveProcessor::isBusesLayoutSupported (const BusesLayout& layouts) const
+{
+    const AudioChannelSet& in = layouts.getMainInputChannelSet();
+
+    return layouts.inputBuses.size() == 1 && layouts.outputBuses.size() == 1
+            && ! in.isDisabled() && in == layouts.getMainOutputChannelSet();
+}
+
+AudioProcessorEditor* LatencyProbeReceiveProcessor::createEditor()
+{
+    return new LatencyProbeEditor (*this);
+}
+
+void LatencyProbeReceiveProcessor::clearMeasurements() noexcept
+{
+    lastLatency = -1;
+    minLatency = -1;
+    maxLatency = -1;
+    numMeasurements = 0;
+    numMissed = 0;
+}
+
+void LatencyProbeReceiveProcessor::prepareToPlay (double sampleRate, int)
+{
+    currentSampleRate = sampleRate;
+    currentLink = 0;
+    clearMeasurements();
+}
+
+void LatencyProbeReceiveProcessor::releaseResources()
+{
+}
+
+void LatencyProbeReceiveProcessor::renderBlock (AudioBuffer<float>& buffer, MidiBuffer&)
+{
+    const int numSamples = buffer.getNumSamples();
+    const ProbeLink& l = getProbeLink (*link);
+    const uint32 generation = l.generation.load();
+
+    if (resetRequested.exchange (false))
+        clearMeasurements();
+
+    if (link->get() != currentLink)
+    {
+        // We can't tell yet whether the sender runs before or after us, so just
+        // sync up and start measuring from the next block.
+        currentLink = link->get();
+        lastGeneration = generation;
+        lastSeenImpulse = lastMatchedImpulse = l.impulseTime.load();
+        return;
+    }
+
+    // If the sender has already run in this callback, this block lines up with
+    // the one it just published; otherwise it lines up with the one after it.
+    const int64 blockTime = generation != lastGeneration ? l.blockStart.load()
+                                                         : l.blockStart.load() + l.lastBlockSize.load();
+    lastGeneration = generation;
+
+    const int64 impulse = l.impulseTime.load();
+
+    if (impulse != lastSeenImpulse)
+    {
+        if (lastSeenImpulse >= 0 && lastMatchedImpulse != lastSeenImpulse)
+            ++numMissed;
+
+        lastSeenImpulse = impulse;
+    }
+
+    if (impulse < 0 || impulse == lastMatchedImpulse)
+        return;
+
+    const int64 firstPossible = impulse - blockTime;
+
+    if (firstPossible >= numSamples)
+        return;
+
+    const int start = (int) jmax ((int64) 0, firstPossible);
+    const float threshold = Decibels::decibelsToGain (thresholdDb->get());
+    int arrival = numSamples;
+
+    for (int ch = 0; ch < buffer.getNumChannels() && arrival > start; ++ch)
+    {
+        const float* const data = buffer.getReadPointer (ch);
+        const Range<float> range (FloatVectorOperations::findMinAndMax (data + start, arrival - start));
+
+        if (jmax (-range.getStart(), range.getEnd()) <= threshold)
+            continue;
+
+        for (int i = start; i < arrival; ++i)
+        {
+            if (std::abs (data[i]) > threshold)
+            {
+                arrival = i;
+                break;
+            }
+        }
+    }
+
+    if (arrival < numSamples)
+    {
+        const int latency = (int) (blockTime + arrival - impulse);
+
+        lastLatency = latency;
+        minLatency = minLatency.load() < 0 ? latency : jmin (minLatency.load(), latency);
+        maxLatency = jmax (maxLatency.load(), latency);
+        ++numMeasurements;
+        lastMatchedImpulse = impulse;
+    }
+}
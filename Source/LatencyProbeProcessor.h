@@ -0,0 +1,111 @@
+/*
+  ==============================================================================
+
+    LatencyProbeProcessor.h
+    Middle
+
+  ==============================================================================
+*/
+
+#ifndef __LATENCYPROBEPROCESSOR_JUCEHEADER__
+#define __LATENCYPROBEPROCESSOR_JUCEHEADER__
+
+#include <atomic>
+#include "InternalProcessors.h"
+
+
+//==============================================================================
+/**
+    The sending half of a latency probe.
+
+    It writes a single full-scale sample to every output channel at a regular
+    interval, and publishes when it did so, in its own sample clock, on one of a
+    handful of numbered links. A LatencyProbeReceiveProcessor on the same link
+    listens for the impulse and works out how long it took to arrive.
+
+    The probe is split in two because a graph can't contain a loop: put the
+    sender before a chain and the receiver after it to check that the chain's
+    reported latency matches reality, or connect the sender to the audio output
+    and the receiver to the audio input to measure the device's round trip.
+    Both halves must be in the same graph, running at the same rate.
+*/
+class LatencyProbeSendProcessor   : public InternalPlugin
+{
+public:
+    LatencyProbeSendProcessor();
+
+    static const char* const probeSendName;
+
+    enum { numLinks = 8 };
+
+    void prepareToPlay (double sampleRate, int maximumExpectedSamplesPerBlock) override;
+    void releaseResources() override;
+    void renderBlock (AudioBuffer<float>&, MidiBuffer&) override;
+
+    bool isBusesLayoutSupported (const BusesLayout&) const override;
+
+private:
+    AudioParameterInt* link;
+    AudioParameterFloat* intervalSeconds;
+
+    double currentSampleRate;
+    int64 samplePosition, nextImpulse;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (LatencyProbeSendProcessor)
+};
+
+//==============================================================================
+/**
+    The receiving half of a latency probe; see LatencyProbeSendProcessor.
+
+    Audio passes straight through. The first sample above the threshold after
+    each impulse is sent gives one measurement, and impulses that never turn up
+    are counted as missed. The results are published as atomics for the editor.
+*/
+class LatencyProbeReceiveProcessor   : public InternalPlugin
+{
+public:
+    LatencyProbeReceiveProcessor();
+
+    static const char* const probeReceiveName;
+
+    void prepareToPlay (double sampleRate, int maximumExpectedSamplesPerBlock) override;
+    void releaseResources() override;
+    void renderBlock (AudioBuffer<float>&, MidiBuffer&) override;
+
+    bool isBusesLayoutSupported (const BusesLayout&) const override;
+
+    AudioProcessorEditor* createEditor() override;
+
+    //==============================================================================
+    /** The most recent measurement in samples, or -1 if nothing has arrived yet. */
+    int getLastLatency() const noexcept                                  { return lastLatency.load(); }
+    int getMinLatency() const noexcept                                   { return minLatency.load(); }
+    int getMaxLatency() const noexcept                                   { return maxLatency.load(); }
+    int getNumMeasurements() const noexcept                              { return numMeasurements.load(); }
+    int getNumMissed() const noexcept                                    { return numMissed.load(); }
+    double getMeasuredSampleRate() const noexcept                        { return currentSampleRate.load(); }
+
+    /** Clears the results; the audio thread picks this up on its next block. */
+    void resetMeasurements() noexcept                                    { resetRequested = true; }
+
+private:
+    //==============================================================================
+    AudioParameterInt* link;
+    AudioParameterFloat* thresholdDb;
+
+    std::atomic<int> lastLatency, minLatency, maxLatency, numMeasurements, numMissed;
+    std::atomic<double> currentSampleRate;
+    std::atomic<bool> resetRequested;
+
+    int currentLink;
+    uint32 lastGeneration;
+    int64 lastSeenImpulse, lastMatchedImpulse;
+
+    void clearMeasurements() noexcept;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (LatencyProbeReceiveProcessor)
+};
+
+
+#endif   // __LATENCYPROBEPROCESSOR_JUCEHEADER__
@@ -25,6 +25,7 @@
 #include "../JuceLibraryCode/JuceHeader.h"
 #include "MainHostWindow.h"
 #include "InternalFilters.h"
+#include "StallMonitor.h"
 
 
 //==============================================================================
@@ -70,19 +71,206 @@ private:
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (PluginListWindow)
 };
 
+//==============================================================================
+/** Shows the StallMonitor's latency histogram and stall log, and exports them. */
+class MainHostWindow::StallReportWindow  : public DocumentWindow
+{
+public:
+    StallReportWindow (MainHostWindow& owner_)
+        : DocumentWindow ("Message Thread Stalls", Colours::white,
+                          DocumentWindow::closeButton),
+          owner (owner_)
+    {
+        setContentOwned (new Content(), true);
+        setResizable (true, false);
+        setResizeLimits (400, 300, 1200, 1200);
+        setTopLeftPosition (80, 80);
+
+        restoreWindowStateFromString (getAppProperties().getUserSettings()->getValue ("stallWindowPos"));
+        setVisible (true);
+    }
+
+    ~StallReportWindow()
+    {
+        getAppProperties().getUserSettings()->setValue ("stallWindowPos", getWindowStateAsString());
+
+        clearContentComponent();
+    }
+
+    void closeButtonPressed()
+    {
+        owner.stallReportWindow = nullptr;
+    }
+
+private:
+    //==============================================================================
+    class Content   : public Component,
+                      private ChangeListener,
+                      private Button::Listener,
+                      private Timer
+    {
+    public:
+        Content()
+            : monitor (*StallMonitor::getInstance()),
+              exportButton ("Export..."), resetButton ("Reset"),
+              numStallsShown (-1)
+        {
+            log.setMultiLine (true);
+            log.setReadOnly (true);
+            log.setCaretVisible (false);
+            log.setFont (Font (Font::getDefaultMonospacedFontName(), 13.0f, Font::plain));
+            addAndMakeVisible (log);
+
+            exportButton.addListener (this);
+            resetButton.addListener (this);
+            addAndMakeVisible (exportButton);
+            addAndMakeVisible (resetButton);
+
+            monitor.addChangeListener (this);
+            update();
+
+            // The histogram moves with every probe, so it's sampled; stalls are pushed.
+            startTimer (1000);
+            setSize (520, 460);
+        }
+
+        ~Content()
+        {
+            monitor.removeChangeListener (this);
+        }
+
+        void paint (Graphics& g) override
+        {
+            g.fillAll (Colours::white);
+
+            Rectangle<int> area (histogramArea);
+            const int barHeight = area.getHeight() / StallMonitor::numBuckets;
+            int maxCount = 1;
+
+            for (int i = 0; i < counts.size(); ++i)
+                maxCount = jmax (maxCount, counts[i]);
+
+            g.setFont (13.0f);
+
+            for (int i = 0; i < counts.size(); ++i)
+            {
+                Rectangle<int> row (area.removeFromTop (barHeight));
+
+                g.setColour (Colours::black);
+                g.drawText (StallMonitor::getBucketName (i), row.removeFromLeft (110), Justification::centredLeft, false);
+                g.drawText (String (counts[i]), row.removeFromRight (60), Justification::centredRight, false);
+
+                // Square-root scaling keeps the rare, long stalls visible next to the thousands of quick probes.
+                const float proportion = std::sqrt (counts[i] / (float) maxCount);
+
+                g.setColour (i >= StallMonitor::getBucketFor (StallMonitor::stallThresholdMs) ? Colours::orangered
+                                                                                              : Colours::grey);
+                g.fillRect (row.reduced (0, 2).withWidth (roundToInt (row.getWidth() * proportion)));
+            }
+        }
+
+        void resized() override
+        {
+            Rectangle<int> r (getLocalBounds().reduced (8));
+
+            Rectangle<int> buttons (r.removeFromBottom (26));
+            exportButton.setBounds (buttons.removeFromRight (90));
+            buttons.removeFromRight (8);
+            resetButton.setBounds (buttons.removeFromRight (90));
+            r.removeFromBottom (8);
+
+            histogramArea = r.removeFromTop (StallMonitor::numBuckets * 18);
+            r.removeFromTop (8);
+            log.setBounds (r);
+        }
+
+    private:
+        StallMonitor& monitor;
+        TextEditor log;
+        TextButton exportButton, resetButton;
+        Rectangle<int> histogramArea;
+        Array<int> counts;
+        int numStallsShown;
+
+        void update()
+        {
+            const Array<int> newCounts (monitor.getHistogram());
+
+            if (newCounts != counts)
+            {
+                counts = newCounts;
+                repaint (histogramArea);
+            }
+
+            if (monitor.getNumStalls() == numStallsShown)
+                return;
+
+            numStallsShown = monitor.getNumStalls();
+
+            const Array<StallMonitor::Stall> stalls (monitor.getStalls());
+            String text;
+
+            // Newest first, since that's usually the one that's just been noticed.
+            for (int i = stalls.size(); --i >= 0;)
+            {
+                const StallMonitor::Stall& s = stalls.getReference (i);
+
+                text << s.time.formatted ("%H:%M:%S") << "  "
+                     << String (roundToInt (s.milliseconds)).paddedLeft (' ', 6) << " ms  "
+                     << s.activity << newLine;
+            }
+
+            log.setText (text.isNotEmpty() ? text : "No stalls over " + String ((int) StallMonitor::stallThresholdMs) + " ms yet", false);
+        }
+
+        void changeListenerCallback (ChangeBroadcaster*) override     { update(); }
+        void timerCallback() override                                  { update(); }
+
+        void buttonClicked (Button* b) override
+        {
+            if (b == &resetButton)
+            {
+                monitor.reset();
+            }
+            else if (b == &exportButton)
+            {
+                FileChooser chooser ("Export the stall report",
+                                     File::getSpecialLocation (File::userDocumentsDirectory).getChildFile ("Middle stalls.txt"),
+                                     "*.txt");
+
+                if (chooser.browseForFileToSave (true) && ! monitor.exportReport (chooser.getResult()))
+                    AlertWindow::showMessageBoxAsync (AlertWindow::WarningIcon, "Export failed",
+                                                      "Couldn't write to " + chooser.getResult().getFullPathName());
+            }
+        }
+
+        JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (Content)
+    };
+
+    MainHostWindow& owner;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (StallReportWindow)
+};
+
 //==============================================================================
 MainHostWindow::MainHostWindow()
     : DocumentWindow (JUCEApplication::getInstance()->getApplicationName(), Colours::lightgrey,
                       DocumentWindow::minimiseButton|DocumentWindow::closeButton)
 {
+    // Starts watching the message loop before anything gets a chance to hold it up.
+    StallMonitor::getInstance();
+
     formatManager.addDefaultFormats();
-    formatManager.addFormat (new InternalPluginFormat());
+    formatManager.addFormat (new InternalPluginFormat (&formatManager));
 
     ScopedPointer<XmlElement> savedAudioState (getAppProperties().getUserSettings()
                                                    ->getXmlValue ("audioDeviceState"));
 
     deviceManager.initialise (256, 256, savedAudioState, true);
 
+    PluginWindow::setHiddenEditorTimeout (getAppProperties().getUserSettings()
+                                              ->getIntValue ("hiddenEditorTimeout", PluginWindow::getHiddenEditorTimeout()));
+
     setFullScreen(false);
     setResizable (false, false);
     //setResizeLimits (500, 400, 10000, 10000);
@@ -125,6 +313,7 @@ MainHostWindow::MainHostWindow()
 MainHostWindow::~MainHostWindow()
 {
     pluginListWindow = nullptr;
+    stallReportWindow = nullptr;
     knownPluginList.removeChangeListener (this);
 
     if (FilterGraph* filterGraph = getGraphEditor()->graph.get())
@@ -248,6 +437,18 @@ PopupMenu MainHostWindow::getMenuForIndex (int topLevelMenuIndex, const String&
         menu.addSeparator();
         menu.addCommandItem (&getCommandManager(), CommandIDs::showAudioSettings);
         menu.addCommandItem (&getCommandManager(), CommandIDs::toggleDoublePrecision);
+        menu.addCommandItem (&getCommandManager(), CommandIDs::toggleOpenGLRenderer);
+        menu.addCommandItem (&getCommandManager(), CommandIDs::toggleFrameTime);
+
+        const int timeout = PluginWindow::getHiddenEditorTimeout();
+
+        PopupMenu hiddenEditorMenu;
+        hiddenEditorMenu.addItem (260, "Never",                   true, timeout == 0);
+        hiddenEditorMenu.addItem (261, "After 10 seconds hidden", true, timeout == 10);
+        hiddenEditorMenu.addItem (262, "After 1 minute hidden",   true, timeout == 60);
+        hiddenEditorMenu.addItem (263, "After 5 minutes hidden",  true, timeout == 300);
+        menu.addSubMenu ("Close hidden plugin editors", hiddenEditorMenu);
+        menu.addCommandItem (&getCommandManager(), CommandIDs::showStallReport);
 
         menu.addSeparator();
         menu.addCommandItem (&getCommandManager(), CommandIDs::aboutBox);
@@ -279,7 +480,7 @@ void MainHostWindow::menuItemSelected (int menuItemID, int /*topLevelMenuIndex*/
         if (graphEditor != nullptr
               && getGraphEditor()->graph != nullptr
               && graphEditor->graph->saveIfNeededAndUserAgrees() == FileBasedDocument::savedOk)
-            graphEditor->graph->loadFrom (recentFiles.getFile (menuItemID - 100), true);
+            graphEditor->graph->loadFromAsync (recentFiles.getFile (menuItemID - 100), true);
     }
     else if (menuItemID >= 200 && menuItemID < 210)
     {
@@ -293,6 +494,15 @@ void MainHostWindow::menuItemSelected (int menuItemID, int /*topLevelMenuIndex*/
 
         menuItemsChanged();
     }
+    else if (menuItemID >= 260 && menuItemID < 264)
+    {
+        static const int timeouts[] = { 0, 10, 60, 300 };
+
+        PluginWindow::setHiddenEditorTimeout (timeouts[menuItemID - 260]);
+        getAppProperties().getUserSettings()->setValue ("hiddenEditorTimeout", PluginWindow::getHiddenEditorTimeout());
+
+        menuItemsChanged();
+    }
     else
     {
         createPlugin (getChosenType (menuItemID),
@@ -351,6 +561,9 @@ void MainHostWindow::getAllCommands (Array <CommandID>& commands)
                               CommandIDs::showPluginListEditor,
                               CommandIDs::showAudioSettings,
                               CommandIDs::toggleDoublePrecision,
+                              CommandIDs::toggleOpenGLRenderer,
+                              CommandIDs::toggleFrameTime,
+                              CommandIDs::showStallReport,
                               CommandIDs::aboutBox,
                               CommandIDs::allWindowsForward
                             };
@@ -400,6 +613,20 @@ void MainHostWindow::getCommandInfo (const CommandID commandID, ApplicationComma
         updatePrecisionMenuItem (result);
         break;
 
+    case CommandIDs::toggleOpenGLRenderer:
+        result.setInfo ("Render the graph with OpenGL", "Draws the graph editor through an OpenGL context instead of the software renderer", category, 0);
+        result.setTicked (getDisplayOption ("useOpenGLRenderer"));
+        break;
+
+    case CommandIDs::toggleFrameTime:
+        result.setInfo ("Show frame times", "Shows how long the graph editor takes to paint", category, 0);
+        result.setTicked (getDisplayOption ("showFrameTime"));
+        break;
+
+    case CommandIDs::showStallReport:
+        result.setInfo ("Show message thread stalls...", "Shows how often the UI has been held up, and by what", category, 0);
+        break;
+
     case CommandIDs::aboutBox:
         result.setInfo ("About...", String(), category, 0);
         break;
@@ -417,6 +644,7 @@ void MainHostWindow::getCommandInfo (const CommandID commandID, ApplicationComma
 bool MainHostWindow::perform (const InvocationInfo& info)
 {
     GraphDocumentComponent* const graphEditor = getGraphEditor();
+    const StallMonitor::ScopedActivity activity ("Running the " + getCommandManager().getNameOfCommand (info.commandID).quoted() + " command");
 
     switch (info.commandID)
     {
@@ -429,8 +657,10 @@ bool MainHostWindow::perform (const InvocationInfo& info)
             if (graphEditor != nullptr && graphEditor->graph != nullptr && graphEditor->graph->saveIfNeededAndUserAgrees() == FileBasedDocument::savedOk) {
                 String documentsFolder = File::getSpecialLocation(File::userDocumentsDirectory).getFullPathName();
                 String folder = documentsFolder + "/Middle/Projects";
-                graphEditor->graph->setLastDocumentOpened(File(folder));
-                graphEditor->graph->loadFromUserSpecifiedFile (true);
+                FileChooser chooser ("Load a Middle project", File (folder), filenameWildcard);
+
+                if (chooser.browseForFileToOpen())
+                    graphEditor->graph->loadFromAsync (chooser.getResult(), true);
             }
         break;
 
@@ -472,6 +702,34 @@ bool MainHostWindow::perform (const InvocationInfo& info)
         }
         break;
 
+    case CommandIDs::toggleOpenGLRenderer:
+    case CommandIDs::toggleFrameTime:
+        if (PropertiesFile* props = getAppProperties().getUserSettings())
+        {
+            const bool isOpenGL = info.commandID == CommandIDs::toggleOpenGLRenderer;
+            const String settingName (isOpenGL ? "useOpenGLRenderer" : "showFrameTime");
+            const bool newValue = ! getDisplayOption (settingName);
+
+            props->setValue (settingName, var (newValue));
+            menuItemsChanged();
+
+            if (graphEditor != nullptr)
+            {
+                if (isOpenGL)
+                    graphEditor->setUsingOpenGL (newValue);
+                else
+                    graphEditor->setFrameTimeVisible (newValue);
+            }
+        }
+        break;
+
+    case CommandIDs::showStallReport:
+        if (stallReportWindow == nullptr)
+            stallReportWindow = new StallReportWindow (*this);
+
+        stallReportWindow->toFront (true);
+        break;
+
     case CommandIDs::aboutBox:
         // TODO
         break;
@@ -551,7 +809,7 @@ void MainHostWindow::filesDropped (const StringArray& files, int x, int y)
         {
             if (FilterGraph* filterGraph = graphEditor->graph.get())
             if (filterGraph->saveIfNeededAndUserAgrees() == FileBasedDocument::savedOk)
-                filterGraph->loadFrom (File (files[0]), true);
+                filterGraph->loadFromAsync (File (files[0]), true);
         }
         else
         {
@@ -566,6 +824,18 @@ void MainHostWindow::filesDropped (const StringArray& files, int x, int y)
     }
 }
 
+MainHostWindow* MainHostWindow::findFor (Component& c)
+{
+    if (MainHostWindow* const mainWindow = c.findParentComponentOfClass<MainHostWindow>())
+        return mainWindow;
+
+    for (int i = 0; i < Desktop::getInstance().getNumComponents(); ++i)
+        if (MainHostWindow* const mainWindow = dynamic_cast<MainHostWindow*> (Desktop::getInstance().getComponent (i)))
+            return mainWindow;
+
+    return nullptr;
+}
+
 GraphDocumentComponent* MainHostWindow::getGraphEditor() const
 {
     return dynamic_cast<GraphDocumentComponent*> (getContentComponent());
@@ -579,6 +849,14 @@ bool MainHostWindow::isDoublePrecisionProcessing()
     return false;
 }
 
+bool MainHostWindow::getDisplayOption (const String& settingName)
+{
+    if (PropertiesFile* props = getAppProperties().getUserSettings())
+        return props->getBoolValue (settingName, false);
+
+    return false;
+}
+
 void MainHostWindow::updatePrecisionMenuItem (ApplicationCommandInfo& info)
 {
     info.setInfo ("Double floating point precision rendering", String(), "General", 0);
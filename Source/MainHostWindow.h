@@ -41,6 +41,9 @@ namespace CommandIDs
     static const int aboutBox               = 0x30300;
     static const int allWindowsForward      = 0x30400;
     static const int toggleDoublePrecision  = 0x30500;
+    static const int toggleOpenGLRenderer   = 0x30600;
+    static const int toggleFrameTime        = 0x30700;
+    static const int showStallReport        = 0x30800;
 }
 
 ApplicationCommandManager& getCommandManager();
@@ -89,8 +92,16 @@ public:
 
     GraphDocumentComponent* getGraphEditor() const;
 
+    /** Finds the main window from any component, including ones that live in
+        a separate plugin window rather than inside the main window itself.
+    */
+    static MainHostWindow* findFor (Component&);
+
     bool isDoublePrecisionProcessing();
     void updatePrecisionMenuItem (ApplicationCommandInfo& info);
+
+    /** Reads one of the on/off display options kept in the user settings. */
+    static bool getDisplayOption (const String& settingName);
     
 
 private:
@@ -105,6 +116,9 @@ private:
     class PluginListWindow;
     ScopedPointer<PluginListWindow> pluginListWindow;
 
+    class StallReportWindow;
+    ScopedPointer<StallReportWindow> stallReportWindow;
+
     void showAudioSettings();
 
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (MainHostWindow)
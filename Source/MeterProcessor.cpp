@@ -0,0 +1,354 @@
+/*
+  ==============================================================================
+
+    MeterProcessor.cpp
+    Middle
+
+  ==============================================================================
+*/
+
+#include "../JuceLibraryCode/JuceHeader.h"
+#include "MeterProcessor.h"
+
+#if JUCE_INTEL
+ #include <xmmintrin.h>
+#endif
+
+
+//==============================================================================
+const float MeterProcessor::minusInfinityLufs = -100.0f;
+
+static const double rmsTimeConstantSeconds = 0.3;
+static const double peakFallDbPerSecond = 20.0;
+static const float meterFloorDb = -60.0f;
+
+static float sumOfSquares (const float* data, int numSamples) noexcept
+{
+    float sum = 0.0f;
+
+   #if JUCE_INTEL
+    __m128 acc0 = _mm_setzero_ps();
+    __m128 acc1 = _mm_setzero_ps();
+
+    for (; numSamples >= 8; numSamples -= 8, data += 8)
+    {
+        const __m128 a = _mm_loadu_ps (data);
+        const __m128 b = _mm_loadu_ps (data + 4);
+        acc0 = _mm_add_ps (acc0, _mm_mul_ps (a, a));
+        acc1 = _mm_add_ps (acc1, _mm_mul_ps (b, b));
+    }
+
+    float lanes[4];
+    _mm_storeu_ps (lanes, _mm_add_ps (acc0, acc1));
+    sum = (lanes[0] + lanes[1]) + (lanes[2] + lanes[3]);
+   #endif
+
+    for (int i = 0; i < numSamples; ++i)
+        sum += data[i] * data[i];
+
+    return sum;
+}
+
+/** The two stages of the ITU-R BS.1770 K-weighting curve, for any sample rate. */
+static void getKWeightingCoefficients (double sampleRate, IIRCoefficients& shelf, IIRCoefficients& highPass)
+{
+    {
+        const double f0 = 1681.974450955533;
+        const double gainDb = 3.999843853973347;
+        const double q = 0.7071752369554196;
+
+        const double k = std::tan (double_Pi * f0 / sampleRate);
+        const double vh = std::pow (10.0, gainDb / 20.0);
+        const double vb = std::pow (vh, 0.4996667741545416);
+        const double a0 = 1.0 + k / q + k * k;
+
+        shelf = IIRCoefficients ((vh + vb * k / q + k * k) / a0,
+                                 2.0 * (k * k - vh) / a0,
+                                 (vh - vb * k / q + k * k) / a0,
+                                 1.0,
+                                 2.0 * (k * k - 1.0) / a0,
+                                 (1.0 - k / q + k * k) / a0);
+    }
+
+    {
+        const double f0 = 38.13547087602444;
+        const double q = 0.5003270373238773;
+
+        const double k = std::tan (double_Pi * f0 / sampleRate);
+        const double a0 = 1.0 + k / q + k * k;
+
+        highPass = IIRCoefficients (1.0, -2.0, 1.0,
+                                    1.0,
+                                    2.0 * (k * k - 1.0) / a0,
+                                    (1.0 - k / q + k * k) / a0);
+    }
+}
+
+//==============================================================================
+class MeterEditor   : public AudioProcessorEditor
+{
+public:
+    MeterEditor (MeterProcessor& p)
+        : AudioProcessorEditor (p),
+          meterComponent (p)
+    {
+        addAndMakeVisible (meterComponent);
+        setSize (jmax (160, p.getNumMeteredChannels() * 14 + 16), 240);
+    }
+
+    void paint (Graphics& g) override
+    {
+        g.fillAll (Colours::darkgrey);
+    }
+
+    void resized() override
+    {
+        meterComponent.setBounds (getLocalBounds().reduced (8));
+    }
+
+private:
+    LevelMeterComponent meterComponent;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (MeterEditor)
+};
+
+//==============================================================================
+const char* const MeterProcessor::meterName = "Meter";
+
+MeterProcessor::MeterProcessor()
+    : InternalPlugin (meterName, BusesProperties().withInput  ("Input",  AudioChannelSet::stereo())
+                                                  .withOutput ("Output", AudioChannelSet::stereo())),
+      numMeteredChannels (0),
+      shortTermLoudness (minusInfinityLufs),
+      currentSampleRate (44100.0),
+      currentBlockEnergy (0.0),
+      loudnessBlockIndex (0),
+      samplesInCurrentBlock (0),
+      samplesPerLoudnessBlock (4410)
+{
+    for (int ch = 0; ch < maxChannels; ++ch)
+    {
+        peakLevels[ch] = 0.0f;
+        rmsLevels[ch] = 0.0f;
+        peakHold[ch] = 0.0f;
+        meanSquare[ch] = 0.0f;
+    }
+
+    for (int i = 0; i < numLoudnessBlocks; ++i)
+        loudnessBlocks[i] = 0.0;
+}
+
+bool MeterProcessor::isBusesLayoutSupported (const BusesLayout& layouts) const
+{
+    const AudioChannelSet& in = layouts.getMainInputChannelSet();
+
+    return layouts.inputBuses.size() == 1 && layouts.outputBuses.size() == 1
+            && ! in.isDisabled() && in.size() <= maxChannels
+            && in == layouts.getMainOutputChannelSet();
+}
+
+AudioProcessorEditor* MeterProcessor::createEditor()
+{
+    return new MeterEditor (*this);
+}
+
+//==============================================================================
+void MeterProcessor::prepareToPlay (double sampleRate, int maximumExpectedSamplesPerBlock)
+{
+    currentSampleRate = sampleRate;
+    weightedBuffer.setSize (1, jmax (1, maximumExpectedSamplesPerBlock));
+
+    IIRCoefficients shelf, highPass;
+    getKWeightingCoefficients (sampleRate, shelf, highPass);
+
+    for (int ch = 0; ch < maxChannels; ++ch)
+    {
+        shelfFilters[ch].setCoefficients (shelf);
+        highPassFilters[ch].setCoefficients (highPass);
+        shelfFilters[ch].reset();
+        highPassFilters[ch].reset();
+
+        peakHold[ch] = meanSquare[ch] = 0.0f;
+        peakLevels[ch] = rmsLevels[ch] = 0.0f;
+    }
+
+    for (int i = 0; i < numLoudnessBlocks; ++i)
+        loudnessBlocks[i] = 0.0;
+
+    currentBlockEnergy = 0.0;
+    loudnessBlockIndex = 0;
+    samplesInCurrentBlock = 0;
+    samplesPerLoudnessBlock = jmax (1, roundToInt (sampleRate * 0.1));
+
+    shortTermLoudness = minusInfinityLufs;
+    numMeteredChannels = jmin (getTotalNumInputChannels(), (int) maxChannels);
+}
+
+void MeterProcessor::releaseResources()
+{
+    weightedBuffer.setSize (0, 0);
+}
+
+void MeterProcessor::renderBlock (AudioBuffer<float>& buffer, MidiBuffer&)
+{
+    // The audio passes through untouched.
+    const int numChannels = jmin (numMeteredChannels.load(), buffer.getNumChannels());
+    const int numSamples = buffer.getNumSamples();
+    const int chunkSize = weightedBuffer.getNumSamples();
+
+    if (chunkSize == 0)
+        return;
+
+    for (int pos = 0; pos < numSamples;)
+    {
+        const int num = jmin (numSamples - pos, chunkSize, samplesPerLoudnessBlock - samplesInCurrentBlock);
+        measureChunk (buffer, pos, num, numChannels);
+        pos += num;
+    }
+
+    for (int ch = 0; ch < numChannels; ++ch)
+    {
+        peakLevels[ch] = peakHold[ch];
+        rmsLevels[ch] = std::sqrt (meanSquare[ch]);
+    }
+}
+
+void MeterProcessor::measureChunk (const AudioBuffer<float>& buffer, const int startSample,
+                                   const int numSamples, const int numChannels)
+{
+    const float rmsCoeff = (float) std::exp (-numSamples / (rmsTimeConstantSeconds * currentSampleRate));
+    const float peakFall = Decibels::decibelsToGain ((float) (-peakFallDbPerSecond * numSamples / currentSampleRate));
+    float* const weighted = weightedBuffer.getWritePointer (0);
+    double energy = 0.0;
+
+    for (int ch = 0; ch < numChannels; ++ch)
+    {
+        const float* const data = buffer.getReadPointer (ch, startSample);
+
+        const Range<float> range (FloatVectorOperations::findMinAndMax (data, numSamples));
+        peakHold[ch] = jmax (-range.getStart(), range.getEnd(), peakHold[ch] * peakFall);
+
+        const float chunkMeanSquare = sumOfSquares (data, numSamples) / numSamples;
+        meanSquare[ch] = chunkMeanSquare + rmsCoeff * (meanSquare[ch] - chunkMeanSquare);
+
+        if (meanSquare[ch] < 1.0e-12f)
+            meanSquare[ch] = 0.0f;
+
+        FloatVectorOperations::copy (weighted, data, numSamples);
+        shelfFilters[ch].processSamples (weighted, numSamples);
+        highPassFilters[ch].processSamples (weighted, numSamples);
+
+        energy += sumOfSquares (weighted, numSamples);
+    }
+
+    currentBlockEnergy += energy;
+    samplesInCurrentBlock += numSamples;
+
+    if (samplesInCurrentBlock >= samplesPerLoudnessBlock)
+    {
+        loudnessBlocks[loudnessBlockIndex] = currentBlockEnergy / samplesInCurrentBlock;
+        loudnessBlockIndex = (loudnessBlockIndex + 1) % numLoudnessBlocks;
+        currentBlockEnergy = 0.0;
+        samplesInCurrentBlock = 0;
+
+        double total = 0.0;
+
+        for (int i = 0; i < numLoudnessBlocks; ++i)
+            total += loudnessBlocks[i];
+
+        const double meanEnergy = total / numLoudnessBlocks;
+
+        shortTermLoudness = meanEnergy > 0.0 ? jmax (minusInfinityLufs, (float) (-0.691 + 10.0 * std::log10 (meanEnergy)))
+                                             : minusInfinityLufs;
+    }
+}
+
+//==============================================================================
+static float levelToProportion (float level) noexcept
+{
+    return jlimit (0.0f, 1.0f, (Decibels::gainToDecibels (level, meterFloorDb) - meterFloorDb) / -meterFloorDb);
+}
+
+LevelMeterComponent::LevelMeterComponent (MeterProcessor& m)
+    : meter (m), lastLoudness (MeterProcessor::minusInfinityLufs), lastNumChannels (0)
+{
+    for (int ch = 0; ch < MeterProcessor::maxChannels; ++ch)
+        lastPeaks[ch] = lastRms[ch] = 0.0f;
+
+    setOpaque (false);
+    startTimerHz (30);
+}
+
+LevelMeterComponent::~LevelMeterComponent()
+{
+}
+
+void LevelMeterComponent::timerCallback()
+{
+    bool changed = false;
+
+    const int numChannels = meter.getNumMeteredChannels();
+
+    if (numChannels != lastNumChannels)
+    {
+        lastNumChannels = numChannels;
+        changed = true;
+    }
+
+    for (int ch = 0; ch < numChannels; ++ch)
+    {
+        const float peak = levelToProportion (meter.getPeakLevel (ch));
+        const float rms  = levelToProportion (meter.getRmsLevel (ch));
+
+        if (std::abs (peak - lastPeaks[ch]) > 0.002f || std::abs (rms - lastRms[ch]) > 0.002f)
+        {
+            lastPeaks[ch] = peak;
+            lastRms[ch] = rms;
+            changed = true;
+        }
+    }
+
+    const float loudness = meter.getShortTermLoudness();
+
+    if (std::abs (loudness - lastLoudness) >= 0.05f)
+    {
+        lastLoudness = loudness;
+        changed = true;
+    }
+
+    if (changed)
+        repaint();
+}
+
+void LevelMeterComponent::paint (Graphics& g)
+{
+    Rectangle<float> area (getLocalBounds().toFloat());
+    const Rectangle<float> textArea (area.removeFromBottom (jmin (14.0f, area.getHeight() * 0.3f)));
+
+    g.setColour (Colours::black.withAlpha (0.4f));
+    g.fillRoundedRectangle (area, 2.0f);
+
+    if (lastNumChannels > 0)
+    {
+        const float barWidth = area.getWidth() / lastNumChannels;
+        const float gap = jmin (1.0f, barWidth * 0.2f);
+
+        for (int ch = 0; ch < lastNumChannels; ++ch)
+        {
+            const Rectangle<float> bar (area.getX() + ch * barWidth + gap, area.getY() + 1.0f,
+                                        barWidth - gap * 2.0f, area.getHeight() - 2.0f);
+
+            g.setColour (Colours::limegreen);
+            g.fillRect (bar.withTop (bar.getBottom() - bar.getHeight() * lastRms[ch]));
+
+            g.setColour (lastPeaks[ch] >= 1.0f ? Colours::red : Colours::white);
+            g.fillRect (bar.getX(), bar.getBottom() - bar.getHeight() * lastPeaks[ch], bar.getWidth(), 1.0f);
+        }
+    }
+
+    g.setColour (Colours::white);
+    g.setFont (textArea.getHeight() * 0.85f);
+    g.drawText (lastLoudness <= MeterProcessor::minusInfinityLufs ? String ("-inf LUFS")
+                                                                  : String (lastLoudness, 1) + " LUFS",
+                textArea, Justification::centred, false);
+}
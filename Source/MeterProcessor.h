@@ -0,0 +1,106 @@
+/*
+  ==============================================================================
+
+    MeterProcessor.h
+    Middle
+
+  ==============================================================================
+*/
+
+#ifndef __METERPROCESSOR_JUCEHEADER__
+#define __METERPROCESSOR_JUCEHEADER__
+
+#include <atomic>
+#include "InternalProcessors.h"
+
+
+//==============================================================================
+/**
+    A pass-through node that measures per-channel peak and RMS levels, plus the
+    short-term loudness (EBU R128, 3 second window) of all its channels.
+
+    The audio thread does all the work, into fixed-size arrays that are sized in
+    prepareToPlay(), and publishes the results as atomics. The GUI can read them
+    whenever it likes without taking a lock.
+*/
+class MeterProcessor   : public InternalPlugin
+{
+public:
+    MeterProcessor();
+
+    static const char* const meterName;
+
+    enum { maxChannels = 32 };
+
+    void prepareToPlay (double sampleRate, int maximumExpectedSamplesPerBlock) override;
+    void releaseResources() override;
+    void renderBlock (AudioBuffer<float>&, MidiBuffer&) override;
+
+    bool isBusesLayoutSupported (const BusesLayout&) const override;
+
+    AudioProcessorEditor* createEditor() override;
+
+    //==============================================================================
+    int getNumMeteredChannels() const noexcept                           { return numMeteredChannels.load(); }
+
+    /** Linear peak level, with a falling hold. */
+    float getPeakLevel (int channel) const noexcept                      { return peakLevels[channel].load(); }
+    /** Linear RMS level over roughly the last 300ms. */
+    float getRmsLevel (int channel) const noexcept                       { return rmsLevels[channel].load(); }
+    /** Short-term loudness in LUFS, or minusInfinityLufs when silent. */
+    float getShortTermLoudness() const noexcept                          { return shortTermLoudness.load(); }
+
+    static const float minusInfinityLufs;
+
+private:
+    //==============================================================================
+    std::atomic<int> numMeteredChannels;
+    std::atomic<float> peakLevels[maxChannels], rmsLevels[maxChannels];
+    std::atomic<float> shortTermLoudness;
+
+    float peakHold[maxChannels], meanSquare[maxChannels];
+    IIRFilter shelfFilters[maxChannels], highPassFilters[maxChannels];
+    AudioBuffer<float> weightedBuffer;
+    double currentSampleRate;
+
+    // Short-term loudness is the mean of the last 30 100ms sub-blocks of K-weighted energy.
+    enum { numLoudnessBlocks = 30 };
+    double loudnessBlocks[numLoudnessBlocks];
+    double currentBlockEnergy;
+    int loudnessBlockIndex, samplesInCurrentBlock, samplesPerLoudnessBlock;
+
+    void measureChunk (const AudioBuffer<float>&, int startSample, int numSamples, int numChannels);
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (MeterProcessor)
+};
+
+//==============================================================================
+/**
+    Draws a MeterProcessor's levels as a row of bars with the short-term loudness
+    underneath. It polls the atomics at display rate and only repaints when
+    something has visibly changed.
+
+    Used both as the node's editor and inline on its box in the graph.
+*/
+class LevelMeterComponent   : public Component,
+                              private Timer
+{
+public:
+    LevelMeterComponent (MeterProcessor&);
+    ~LevelMeterComponent();
+
+    void paint (Graphics&) override;
+
+private:
+    MeterProcessor& meter;
+    float lastPeaks[MeterProcessor::maxChannels], lastRms[MeterProcessor::maxChannels];
+    float lastLoudness;
+    int lastNumChannels;
+
+    void timerCallback() override;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (LevelMeterComponent)
+};
+
+
+#endif   // __METERPROCESSOR_JUCEHEADER__
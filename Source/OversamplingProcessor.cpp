@@ -0,0 +1,654 @@
+/*
+  ==============================================================================
+
+    OversamplingProcessor.cpp
+    Middle
+
+  ==============================================================================
+*/
+
+#include "../JuceLibraryCode/JuceHeader.h"
+#include "OversamplingProcessor.h"
+#include "MainHostWindow.h"
+
+
+//==============================================================================
+const char* const OversamplingProcessor::oversamplerName = "Oversampler";
+
+static const int maxOversamplerChannels = 8;
+
+/** Centre tap of each stage's half-band filter, starting from the one nearest the
+    graph's rate. That first stage has to be steep; the later ones only have to
+    reject what's above the first stage's band, so they can be much shorter.
+*/
+static const int stageCentreTaps[] = { 31, 15, 11 };
+
+static double besselI0 (double x) noexcept
+{
+    double sum = 1.0, term = 1.0;
+
+    for (int k = 1; k < 32; ++k)
+    {
+        const double t = x / (2.0 * k);
+        term *= t * t;
+        sum += term;
+    }
+
+    return sum;
+}
+
+//==============================================================================
+/**
+    One doubling or halving of the sample rate, for a single channel.
+
+    The filter is a Kaiser-windowed half-band with an odd centre index, so the
+    non-zero taps all land on even indices apart from the centre. Only those
+    even taps are stored.
+*/
+class HalfBandStage
+{
+public:
+    HalfBandStage (int centreTap, int maxInputSamples)
+        : centre (centreTap),
+          numTaps (centreTap + 1),
+          taps ((size_t) numTaps),
+          upTaps ((size_t) numTaps),
+          upHistory ((size_t) (centreTap + maxInputSamples), true),
+          evenHistory ((size_t) (centreTap + maxInputSamples), true),
+          oddHistory ((size_t) (centreTap + maxInputSamples), true),
+          scratch ((size_t) maxInputSamples, true)
+    {
+        jassert ((centre & 1) != 0);
+
+        const double beta = 8.0;
+        double sum = 0.0;
+
+        for (int j = 0; j < numTaps; ++j)
+        {
+            const int m = 2 * j - centre;
+            const double r = m / (double) (centre + 1);
+            const double window = besselI0 (beta * std::sqrt (1.0 - r * r)) / besselI0 (beta);
+            const double sinc = std::sin (double_Pi * m * 0.5) / (double_Pi * m);
+
+            taps[j] = (float) (sinc * window);
+            sum += taps[j];
+        }
+
+        // The centre tap is 0.5, so the rest must add up to 0.5 for unity gain at DC.
+        for (int j = 0; j < numTaps; ++j)
+        {
+            taps[j] = (float) (taps[j] * 0.5 / sum);
+            upTaps[j] = taps[j] * 2.0f;
+        }
+    }
+
+    /** numSamples in, numSamples * 2 out. */
+    void upsample (const float* input, float* output, int numSamples) noexcept
+    {
+        FloatVectorOperations::copy (upHistory + centre, input, numSamples);
+
+        // Even outputs come from the FIR branch...
+        FloatVectorOperations::clear (scratch, numSamples);
+
+        for (int j = 0; j < numTaps; ++j)
+            FloatVectorOperations::addWithMultiply (scratch, upHistory + centre - j, upTaps[j], numSamples);
+
+        // ...and odd ones from the branch holding only the centre tap, which is just a delay.
+        const float* const delayed = upHistory + centre - (centre - 1) / 2;
+
+        for (int i = 0; i < numSamples; ++i)
+        {
+            output[2 * i]     = scratch[i];
+            output[2 * i + 1] = delayed[i];
+        }
+
+        memmove (upHistory, upHistory + numSamples, sizeof (float) * (size_t) centre);
+    }
+
+    /** numSamples * 2 in, numSamples out. */
+    void downsample (const float* input, float* output, int numSamples) noexcept
+    {
+        for (int i = 0; i < numSamples; ++i)
+        {
+            evenHistory[centre + i] = input[2 * i];
+            oddHistory[centre + i]  = input[2 * i + 1];
+        }
+
+        FloatVectorOperations::copyWithMultiply (output, oddHistory + centre - (centre + 1) / 2, 0.5f, numSamples);
+
+        for (int j = 0; j < numTaps; ++j)
+            FloatVectorOperations::addWithMultiply (output, evenHistory + centre - j, taps[j], numSamples);
+
+        memmove (evenHistory, evenHistory + numSamples, sizeof (float) * (size_t) centre);
+        memmove (oddHistory,  oddHistory + numSamples,  sizeof (float) * (size_t) centre);
+    }
+
+private:
+    const int centre, numTaps;
+    HeapBlock<float> taps, upTaps, upHistory, evenHistory, oddHistory, scratch;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (HalfBandStage)
+};
+
+//==============================================================================
+/** The chain of half-band stages for one channel, plus whatever delay it takes
+    to make the round trip a whole number of samples at the graph's rate.
+*/
+class HalfBandOversampler
+{
+public:
+    HalfBandOversampler (int numStagesToUse, int maxBlockSize)
+        : numStages (numStagesToUse),
+          alignmentDelay (getAlignmentDelay (numStagesToUse)),
+          maxOversampledSize (maxBlockSize << numStagesToUse),
+          delayLine ((size_t) (alignmentDelay + maxOversampledSize), true)
+    {
+        for (int i = 0; i < numStages; ++i)
+            stages.add (new HalfBandStage (stageCentreTaps[i], maxBlockSize << i));
+
+        for (int i = 0; i < 2; ++i)
+            temp[i].allocate ((size_t) maxOversampledSize, true);
+    }
+
+    /** numSamples in, numSamples << numStages out. */
+    void upsample (const float* input, float* output, int numSamples) noexcept
+    {
+        const float* source = input;
+
+        for (int i = 0; i < numStages; ++i)
+        {
+            float* const dest = (i == numStages - 1) ? output : temp[i & 1].getData();
+            stages.getUnchecked (i)->upsample (source, dest, numSamples << i);
+            source = dest;
+        }
+
+        if (alignmentDelay > 0)
+        {
+            const int numOversampled = numSamples << numStages;
+
+            FloatVectorOperations::copy (delayLine + alignmentDelay, output, numOversampled);
+            FloatVectorOperations::copy (output, delayLine, numOversampled);
+            memmove (delayLine, delayLine + numOversampled, sizeof (float) * (size_t) alignmentDelay);
+        }
+    }
+
+    /** numSamples << numStages in, numSamples out. */
+    void downsample (const float* input, float* output, int numSamples) noexcept
+    {
+        const float* source = input;
+
+        for (int i = numStages; --i >= 0;)
+        {
+            float* const dest = (i == 0) ? output : temp[i & 1].getData();
+            stages.getUnchecked (i)->downsample (source, dest, numSamples << i);
+            source = dest;
+        }
+    }
+
+    /** The round-trip latency at the graph's rate, including the alignment delay. */
+    static int getLatencySamples (int numStagesUsed) noexcept
+    {
+        return (getFilterDelay (numStagesUsed) + getAlignmentDelay (numStagesUsed)) >> numStagesUsed;
+    }
+
+private:
+    const int numStages, alignmentDelay, maxOversampledSize;
+    OwnedArray<HalfBandStage> stages;
+    HeapBlock<float> temp[2], delayLine;
+
+    /** Total delay of the up and down filters, in samples at the oversampled rate.
+        Each stage delays by its centre tap on the way up and again on the way down,
+        at a rate that's 2^(numStages - stage - 1) times lower than the top one.
+    */
+    static int getFilterDelay (int numStagesUsed) noexcept
+    {
+        int delay = 0;
+
+        for (int i = 0; i < numStagesUsed; ++i)
+            delay += 2 * stageCentreTaps[i] << (numStagesUsed - i - 1);
+
+        return delay;
+    }
+
+    static int getAlignmentDelay (int numStagesUsed) noexcept
+    {
+        const int mask = (1 << numStagesUsed) - 1;
+        return (mask + 1 - (getFilterDelay (numStagesUsed) & mask)) & mask;
+    }
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (HalfBandOversampler)
+};
+
+//==============================================================================
+class OversamplingEditor   : public AudioProcessorEditor,
+                             private Button::Listener,
+                             private ComboBox::Listener,
+                             private ComponentListener
+{
+public:
+    OversamplingEditor (OversamplingProcessor& p)
+        : AudioProcessorEditor (p),
+          oversampler (p),
+          pluginButton ("Choose Plugin...")
+    {
+        addAndMakeVisible (pluginButton);
+        pluginButton.addListener (this);
+
+        factorBox.addItem ("Off", 1);
+
+        for (int i = 1; i <= OversamplingProcessor::maxOrder; ++i)
+            factorBox.addItem (String (1 << i) + "x", i + 1);
+
+        factorBox.setSelectedId (p.getOversamplingOrder() + 1, dontSendNotification);
+        factorBox.addListener (this);
+        addAndMakeVisible (factorBox);
+
+        createPluginEditor();
+    }
+
+    ~OversamplingEditor()
+    {
+        deletePluginEditor();
+    }
+
+    void createPluginEditor()
+    {
+        if (AudioPluginInstance* const plugin = oversampler.getPlugin())
+        {
+            pluginEditor = plugin->createEditorIfNeeded();
+
+            if (pluginEditor == nullptr)
+                pluginEditor = new GenericAudioProcessorEditor (plugin);
+
+            addAndMakeVisible (pluginEditor);
+            pluginEditor->addComponentListener (this);
+        }
+
+        updateSize();
+    }
+
+    void deletePluginEditor()
+    {
+        if (pluginEditor != nullptr)
+        {
+            pluginEditor->removeComponentListener (this);
+            pluginEditor = nullptr;
+        }
+    }
+
+    void paint (Graphics& g) override
+    {
+        g.fillAll (getLookAndFeel().findColour (ResizableWindow::backgroundColourId));
+
+        if (pluginEditor == nullptr)
+        {
+            g.setColour (Colours::black);
+            g.setFont (13.0f);
+            g.drawText ("No plugin loaded", getLocalBounds().withTrimmedTop (barHeight),
+                        Justification::centred, false);
+        }
+    }
+
+    void resized() override
+    {
+        Rectangle<int> bar (getLocalBounds().removeFromTop (barHeight).reduced (4));
+        pluginButton.setBounds (bar.removeFromLeft (130));
+        bar.removeFromLeft (8);
+        factorBox.setBounds (bar.removeFromLeft (80));
+
+        if (pluginEditor != nullptr)
+            pluginEditor->setTopLeftPosition (0, barHeight);
+    }
+
+private:
+    enum { barHeight = 32, removePluginId = 0x10000 };
+
+    OversamplingProcessor& oversampler;
+    TextButton pluginButton;
+    ComboBox factorBox;
+    ScopedPointer<AudioProcessorEditor> pluginEditor;
+
+    void updateSize()
+    {
+        if (pluginEditor != nullptr)
+            setSize (jmax (300, pluginEditor->getWidth()), barHeight + pluginEditor->getHeight());
+        else
+            setSize (300, barHeight + 60);
+    }
+
+    void componentMovedOrResized (Component&, bool, bool wasResized) override
+    {
+        if (wasResized)
+            updateSize();
+    }
+
+    void buttonClicked (Button*) override
+    {
+        MainHostWindow* const mainWindow = MainHostWindow::findFor (*this);
+
+        if (mainWindow == nullptr)
+            return;
+
+        PopupMenu m;
+        mainWindow->addPluginsToMenu (m);
+        m.addSeparator();
+        m.addItem (removePluginId, "Remove Plugin", oversampler.getPlugin() != nullptr);
+
+        const int r = m.showMenu (PopupMenu::Options().withTargetComponent (&pluginButton));
+
+        if (r == removePluginId)
+        {
+            oversampler.clearPlugin();
+        }
+        else if (const PluginDescription* const desc = mainWindow->getChosenType (r))
+        {
+            String error;
+
+            if (! oversampler.setPlugin (*desc, error))
+                AlertWindow::showMessageBoxAsync (AlertWindow::WarningIcon, "Oversampler",
+                                                  "Couldn't load " + desc->name + ": " + error);
+        }
+    }
+
+    void comboBoxChanged (ComboBox*) override
+    {
+        oversampler.setOversamplingOrder (factorBox.getSelectedId() - 1);
+    }
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (OversamplingEditor)
+};
+
+//==============================================================================
+OversamplingProcessor::OversamplingProcessor (AudioPluginFormatManager& fm)
+    : InternalPlugin (oversamplerName, BusesProperties().withInput  ("Input",  AudioChannelSet::stereo())
+                                                        .withOutput ("Output", AudioChannelSet::stereo())),
+      formatManager (fm),
+      currentSampleRate (44100.0),
+      currentBlockSize (512),
+      order (1),
+      isPrepared (false)
+{
+}
+
+OversamplingProcessor::~OversamplingProcessor()
+{
+    if (plugin != nullptr)
+        plugin->removeListener (this);
+}
+
+bool OversamplingProcessor::isBusesLayoutSupported (const BusesLayout& layouts) const
+{
+    const AudioChannelSet& in = layouts.getMainInputChannelSet();
+
+    return layouts.inputBuses.size() == 1 && layouts.outputBuses.size() == 1
+            && ! in.isDisabled() && in.size() <= maxOversamplerChannels
+            && in == layouts.getMainOutputChannelSet();
+}
+
+double OversamplingProcessor::getTailLengthSeconds() const
+{
+    return plugin != nullptr ? plugin->getTailLengthSeconds() : 0.0;
+}
+
+AudioProcessorEditor* OversamplingProcessor::createEditor()
+{
+    return new OversamplingEditor (*this);
+}
+
+//==============================================================================
+void OversamplingProcessor::prepareToPlay (double sampleRate, int maximumExpectedSamplesPerBlock)
+{
+    currentSampleRate = sampleRate;
+    currentBlockSize = maximumExpectedSamplesPerBlock;
+
+    prepareOversamplers();
+
+    if (plugin != nullptr)
+        preparePlugin (*plugin);
+
+    isPrepared = true;
+    updateLatency();
+}
+
+void OversamplingProcessor::releaseResources()
+{
+    if (plugin != nullptr)
+        plugin->releaseResources();
+
+    isPrepared = false;
+}
+
+void OversamplingProcessor::prepareOversamplers()
+{
+    const int numChannels = getTotalNumInputChannels();
+
+    oversamplers.clear();
+
+    for (int i = 0; i < numChannels; ++i)
+        oversamplers.add (new HalfBandOversampler (order, currentBlockSize));
+
+    int numBufferChannels = numChannels;
+
+    if (plugin != nullptr)
+        numBufferChannels = jmax (numBufferChannels, plugin->getTotalNumInputChannels(), plugin->getTotalNumOutputChannels());
+
+    oversampledBuffer.setSize (numBufferChannels, currentBlockSize << order);
+    oversampledMidi.ensureSize (2048);
+}
+
+void OversamplingProcessor::preparePlugin (AudioPluginInstance& p)
+{
+    const int numChannels = getTotalNumInputChannels();
+    const double rate = currentSampleRate * getOversamplingFactor();
+    const int blockSize = currentBlockSize << order;
+
+    p.setPlayConfigDetails (numChannels, numChannels, rate, blockSize);
+    p.prepareToPlay (rate, blockSize);
+}
+
+void OversamplingProcessor::updateLatency()
+{
+    int latency = 0;
+
+    if (plugin != nullptr)
+    {
+        latency = roundToInt (plugin->getLatencySamples() / (double) getOversamplingFactor());
+
+        if (order > 0)
+            latency += HalfBandOversampler::getLatencySamples (order);
+    }
+
+    setLatencySamples (latency);
+}
+
+void OversamplingProcessor::audioProcessorChanged (AudioProcessor*)
+{
+    updateLatency();
+}
+
+//==============================================================================
+void OversamplingProcessor::renderBlock (AudioBuffer<float>& buffer, MidiBuffer& midiMessages)
+{
+    if (plugin == nullptr)
+        return;
+
+    if (order == 0)
+    {
+        plugin->processBlock (buffer, midiMessages);
+        return;
+    }
+
+    const int numSamples = buffer.getNumSamples();
+
+    for (int start = 0; start < numSamples; start += currentBlockSize)
+        processChunk (buffer, midiMessages, start, jmin (currentBlockSize, numSamples - start));
+}
+
+void OversamplingProcessor::processChunk (AudioBuffer<float>& buffer, MidiBuffer& midiMessages,
+                                          int startSample, int numSamples)
+{
+    const int factor = getOversamplingFactor();
+    const int numOversampled = numSamples * factor;
+    const int numChannels = jmin (buffer.getNumChannels(), oversamplers.size());
+
+    AudioBuffer<float> oversampled (oversampledBuffer.getArrayOfWritePointers(),
+                                    oversampledBuffer.getNumChannels(), numOversampled);
+
+    for (int ch = 0; ch < numChannels; ++ch)
+        oversamplers.getUnchecked (ch)->upsample (buffer.getReadPointer (ch, startSample),
+                                                  oversampled.getWritePointer (ch), numSamples);
+
+    for (int ch = numChannels; ch < oversampled.getNumChannels(); ++ch)
+        oversampled.clear (ch, 0, numOversampled);
+
+    oversampledMidi.clear();
+
+    MidiBuffer::Iterator iter (midiMessages);
+    MidiMessage message;
+    int position;
+
+    while (iter.getNextEvent (message, position))
+        if (position >= startSample && position < startSample + numSamples)
+            oversampledMidi.addEvent (message, (position - startSample) * factor);
+
+    plugin->processBlock (oversampled, oversampledMidi);
+
+    for (int ch = 0; ch < numChannels; ++ch)
+        oversamplers.getUnchecked (ch)->downsample (oversampled.getReadPointer (ch),
+                                                    buffer.getWritePointer (ch, startSample), numSamples);
+}
+
+//==============================================================================
+bool OversamplingProcessor::setPlugin (const PluginDescription& desc, String& errorMessage)
+{
+    ScopedPointer<AudioPluginInstance> newPlugin (formatManager.createPluginInstance (desc,
+                                                                                      currentSampleRate * getOversamplingFactor(),
+                                                                                      currentBlockSize << order,
+                                                                                      errorMessage));
+    if (newPlugin == nullptr)
+        return false;
+
+    if (dynamic_cast<AudioProcessorGraph::AudioGraphIOProcessor*> (newPlugin.get()) != nullptr)
+    {
+        errorMessage = "Graph I/O nodes can't be oversampled";
+        return false;
+    }
+
+    // Prepared before the swap, so the audio thread only waits for the pointer exchange.
+    if (isPrepared)
+        preparePlugin (*newPlugin);
+
+    swapPlugin (newPlugin.release());
+    return true;
+}
+
+void OversamplingProcessor::clearPlugin()
+{
+    swapPlugin (nullptr);
+}
+
+void OversamplingProcessor::swapPlugin (AudioPluginInstance* newPlugin)
+{
+    ScopedPointer<AudioPluginInstance> previous (newPlugin);
+
+    OversamplingEditor* const editor = dynamic_cast<OversamplingEditor*> (getActiveEditor());
+
+    if (editor != nullptr)
+        editor->deletePluginEditor();
+
+    if (plugin != nullptr)
+        plugin->removeListener (this);
+
+    suspendProcessing (true);
+    plugin.swapWith (previous);
+
+    if (isPrepared)
+        prepareOversamplers();
+
+    suspendProcessing (false);
+
+    if (previous != nullptr)
+        previous->releaseResources();
+
+    previous = nullptr;
+
+    if (plugin != nullptr)
+        plugin->addListener (this);
+
+    updateLatency();
+    updateHostDisplay();
+
+    if (editor != nullptr)
+        editor->createPluginEditor();
+}
+
+void OversamplingProcessor::setOversamplingOrder (int newOrder)
+{
+    newOrder = jlimit (0, (int) maxOrder, newOrder);
+
+    if (newOrder == order)
+        return;
+
+    suspendProcessing (true);
+    order = newOrder;
+
+    if (isPrepared)
+    {
+        prepareOversamplers();
+
+        if (plugin != nullptr)
+        {
+            plugin->releaseResources();
+            preparePlugin (*plugin);
+        }
+    }
+
+    suspendProcessing (false);
+
+    updateLatency();
+    updateHostDisplay();
+}
+
+//==============================================================================
+void OversamplingProcessor::writeExtraState (XmlElement& xml) const
+{
+    xml.setAttribute ("order", order);
+
+    if (plugin != nullptr)
+    {
+        PluginDescription pd;
+        plugin->fillInPluginDescription (pd);
+        xml.addChildElement (pd.createXml());
+
+        MemoryBlock m;
+        plugin->getStateInformation (m);
+        xml.createNewChildElement ("PLUGINSTATE")->addTextElement (m.toBase64Encoding());
+    }
+}
+
+void OversamplingProcessor::readExtraState (const XmlElement& xml)
+{
+    setOversamplingOrder (xml.getIntAttribute ("order", 1));
+
+    PluginDescription pd;
+
+    forEachXmlChildElement (xml, e)
+    {
+        if (pd.loadFromXml (*e))
+        {
+            String error;
+
+            if (setPlugin (pd, error))
+            {
+                if (const XmlElement* const state = xml.getChildByName ("PLUGINSTATE"))
+                {
+                    MemoryBlock m;
+                    m.fromBase64Encoding (state->getAllSubText());
+                    plugin->setStateInformation (m.getData(), (int) m.getSize());
+                }
+            }
+
+            break;
+        }
+    }
+}
@@ -0,0 +1,93 @@
+/*
+  ==============================================================================
+
+    OversamplingProcessor.h
+    Middle
+
+  ==============================================================================
+*/
+
+#ifndef __OVERSAMPLINGPROCESSOR_JUCEHEADER__
+#define __OVERSAMPLINGPROCESSOR_JUCEHEADER__
+
+#include "InternalProcessors.h"
+
+class HalfBandOversampler;
+
+
+//==============================================================================
+/**
+    A container that runs one hosted plugin at 2x, 4x or 8x the graph's rate.
+
+    Each doubling is a polyphase half-band FIR stage. Half of a half-band
+    filter's taps are zero and the centre tap is exactly 0.5, so each stage
+    only needs a short FIR on one polyphase branch and a plain delay on the
+    other. The FIRs run as a series of FloatVectorOperations across the block,
+    one per tap, which keeps them on the vectorised paths.
+
+    The hosted plugin is prepared at the higher rate and block size, and the
+    latency of the filters is added to whatever the plugin itself reports.
+*/
+class OversamplingProcessor   : public InternalPlugin,
+                                private AudioProcessorListener
+{
+public:
+    OversamplingProcessor (AudioPluginFormatManager&);
+    ~OversamplingProcessor();
+
+    static const char* const oversamplerName;
+
+    //==============================================================================
+    void prepareToPlay (double sampleRate, int maximumExpectedSamplesPerBlock) override;
+    void releaseResources() override;
+    void renderBlock (AudioBuffer<float>&, MidiBuffer&) override;
+
+    bool isBusesLayoutSupported (const BusesLayout&) const override;
+    double getTailLengthSeconds() const override;
+    bool acceptsMidi() const override                                   { return true; }
+
+    AudioProcessorEditor* createEditor() override;
+
+    //==============================================================================
+    /** Replaces the hosted plugin. Call on the message thread. */
+    bool setPlugin (const PluginDescription&, String& errorMessage);
+    void clearPlugin();
+    AudioPluginInstance* getPlugin() const noexcept                      { return plugin; }
+
+    /** 0 is off, then 2x, 4x and 8x. Call on the message thread. */
+    void setOversamplingOrder (int newOrder);
+    int getOversamplingOrder() const noexcept                            { return order; }
+    int getOversamplingFactor() const noexcept                           { return 1 << order; }
+
+    enum { maxOrder = 3 };
+
+private:
+    //==============================================================================
+    AudioPluginFormatManager& formatManager;
+    ScopedPointer<AudioPluginInstance> plugin;
+
+    OwnedArray<HalfBandOversampler> oversamplers;
+    AudioBuffer<float> oversampledBuffer;
+    MidiBuffer oversampledMidi;
+
+    double currentSampleRate;
+    int currentBlockSize, order;
+    bool isPrepared;
+
+    void swapPlugin (AudioPluginInstance* newPlugin);
+    void preparePlugin (AudioPluginInstance&);
+    void prepareOversamplers();
+    void updateLatency();
+    void processChunk (AudioBuffer<float>&, MidiBuffer&, int startSample, int numSamples);
+
+    void audioProcessorParameterChanged (AudioProcessor*, int, float) override {}
+    void audioProcessorChanged (AudioProcessor*) override;
+
+    void writeExtraState (XmlElement&) const override;
+    void readExtraState (const XmlElement&) override;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (OversamplingProcessor)
+};
+
+
+#endif   // __OVERSAMPLINGPROCESSOR_JUCEHEADER__
@@ -0,0 +1,373 @@
+/*
+  ==============================================================================
+
+    ProjectLibrary.cpp
+    Middle
+
+  ==============================================================================
+*/
+
+#include "../JuceLibraryCode/JuceHeader.h"
+#include "ProjectLibrary.h"
+#include "MainHostWindow.h"
+
+#if JUCE_LINUX
+ #include <sys/inotify.h>
+ #include <poll.h>
+ #include <unistd.h>
+#endif
+
+
+//==============================================================================
+static const char* const projectWildcard = "*.middlet";
+static const int rescanIntervalMs = 3000;
+static const int settleTimeMs = 250;
+
+/** Reads what the browsers need from a project file. A file that can't be
+    parsed is still listed, just without any plugins.
+*/
+static void readProject (const File& file, int64 size, Time modified, bool isReadOnly,
+                         ProjectLibrary::Project& project)
+{
+    project.file = file;
+    project.name = file.getFileNameWithoutExtension();
+    project.size = size;
+    project.modified = modified;
+    project.isTemplate = isReadOnly;
+    project.plugins.clear();
+    project.nodePositions.clearQuick();
+
+    XmlDocument doc (file);
+    ScopedPointer<XmlElement> xml (doc.getDocumentElement());
+
+    if (xml == nullptr || ! xml->hasTagName ("FILTERGRAPH"))
+        return;
+
+    forEachXmlChildElementWithTagName (*xml, e, "FILTER")
+    {
+        if (const XmlElement* const plugin = e->getChildByName ("PLUGIN"))
+            project.plugins.add (plugin->getStringAttribute ("name"));
+
+        project.nodePositions.add (Point<float> ((float) e->getDoubleAttribute ("x"),
+                                                 (float) e->getDoubleAttribute ("y")));
+    }
+}
+
+struct ProjectNameComparator
+{
+    static int compareElements (const ProjectLibrary::Project& a, const ProjectLibrary::Project& b)
+    {
+        return a.name.compareNatural (b.name);
+    }
+};
+
+//==============================================================================
+ProjectLibrary::ProjectLibrary()
+    : Thread ("Project Library"),
+      folder (getProjectsFolder()),
+      indexFile (getAppProperties().getUserSettings()->getFile().getSiblingFile ("ProjectIndex.xml")),
+      snapshot (new Snapshot()),
+      refreshRequested (false)
+{
+    snapshot->isUpToDate = false;
+    startThread (2);
+}
+
+ProjectLibrary::~ProjectLibrary()
+{
+    stopThread (5000);
+}
+
+File ProjectLibrary::getProjectsFolder()
+{
+    return File::getSpecialLocation (File::userDocumentsDirectory).getChildFile ("Middle/Projects");
+}
+
+ProjectLibrary::Snapshot::Ptr ProjectLibrary::getSnapshot() const
+{
+    const ScopedLock sl (snapshotLock);
+    return snapshot;
+}
+
+void ProjectLibrary::refresh()
+{
+    refreshRequested = true;
+    notify();
+}
+
+//==============================================================================
+void ProjectLibrary::run()
+{
+    loadIndex();
+
+    if (projects.size() > 0)
+        publish (false);
+
+    if (rescan())
+        saveIndex();
+
+    publish (true);
+
+   #if JUCE_LINUX
+    const int inotifyFd = inotify_init1 (IN_NONBLOCK | IN_CLOEXEC);
+    int watch = -1;
+    Array<File> changedFiles;
+    HeapBlock<char> events (4096);
+   #endif
+
+    while (! threadShouldExit())
+    {
+        bool changed = false;
+
+       #if JUCE_LINUX
+        if (watch < 0 && inotifyFd >= 0)
+        {
+            watch = inotify_add_watch (inotifyFd, folder.getFullPathName().toRawUTF8(),
+                                       IN_CLOSE_WRITE | IN_CREATE | IN_DELETE | IN_MOVED_FROM | IN_MOVED_TO
+                                        | IN_ATTRIB | IN_DELETE_SELF | IN_MOVE_SELF);
+
+            // Anything could have happened while nobody was watching.
+            if (watch >= 0)
+                changed = rescan();
+        }
+
+        if (watch >= 0)
+        {
+            pollfd p = { inotifyFd, POLLIN, 0 };
+
+            if (poll (&p, 1, settleTimeMs) > 0)
+            {
+                const ssize_t numBytes = read (inotifyFd, events, 4096);
+
+                for (ssize_t pos = 0; pos < numBytes;)
+                {
+                    const inotify_event* const event = reinterpret_cast<const inotify_event*> (events + pos);
+                    pos += (ssize_t) (sizeof (inotify_event) + event->len);
+
+                    if ((event->mask & IN_Q_OVERFLOW) != 0)
+                    {
+                        refreshRequested = true;
+                    }
+                    else if ((event->mask & (IN_IGNORED | IN_DELETE_SELF | IN_MOVE_SELF)) != 0)
+                    {
+                        // The folder itself has gone; go back to waiting for it to appear.
+                        inotify_rm_watch (inotifyFd, watch);
+                        watch = -1;
+                        refreshRequested = true;
+                    }
+                    else if (event->len > 0)
+                    {
+                        const String name (CharPointer_UTF8 (event->name));
+
+                        if (name.matchesWildcard (projectWildcard, ! File::areFileNamesCaseSensitive()))
+                            changedFiles.addIfNotAlreadyThere (folder.getChildFile (name));
+                    }
+                }
+
+                // Keep collecting until things go quiet, so a save only gets read once.
+                continue;
+            }
+
+            for (int i = 0; i < changedFiles.size(); ++i)
+                changed = updateFile (changedFiles.getReference (i)) || changed;
+
+            changedFiles.clearQuick();
+        }
+        else
+       #endif
+        {
+            wait (rescanIntervalMs);
+            refreshRequested = true;
+        }
+
+        if (refreshRequested.exchange (false))
+            changed = rescan() || changed;
+
+        if (changed && ! threadShouldExit())
+        {
+            publish (true);
+            saveIndex();
+        }
+    }
+
+   #if JUCE_LINUX
+    if (inotifyFd >= 0)
+        close (inotifyFd);
+   #endif
+}
+
+//==============================================================================
+bool ProjectLibrary::rescan()
+{
+    bool changed = false;
+    Array<bool> found;
+    found.insertMultiple (0, false, projects.size());
+
+    if (folder.isDirectory())
+    {
+        DirectoryIterator iter (folder, false, projectWildcard);
+        bool isDirectory, isHidden, isReadOnly;
+        int64 size;
+        Time modified, created;
+
+        // The iterator already has each file's details, so unchanged files cost nothing.
+        while (iter.next (&isDirectory, &isHidden, &size, &modified, &created, &isReadOnly))
+        {
+            if (threadShouldExit())
+                return changed;
+
+            const File file (iter.getFile());
+            const String path (file.getFullPathName());
+
+            if (indexByPath.contains (path))
+            {
+                const int index = indexByPath [path];
+                const Project& existing = projects.getReference (index);
+                found.set (index, true);
+
+                if (existing.size == size && existing.modified == modified && existing.isTemplate == isReadOnly)
+                    continue;
+            }
+            else
+            {
+                found.add (true);
+            }
+
+            Project project;
+            readProject (file, size, modified, isReadOnly, project);
+            addOrReplace (project);
+            changed = true;
+        }
+    }
+
+    for (int i = projects.size(); --i >= 0;)
+    {
+        if (! found[i])
+        {
+            projects.remove (i);
+            changed = true;
+        }
+    }
+
+    rebuildIndexByPath();
+    return changed;
+}
+
+bool ProjectLibrary::updateFile (const File& file)
+{
+    const String path (file.getFullPathName());
+
+    if (! file.existsAsFile())
+    {
+        if (! indexByPath.contains (path))
+            return false;
+
+        projects.remove (indexByPath [path]);
+        rebuildIndexByPath();
+        return true;
+    }
+
+    Project project;
+    readProject (file, file.getSize(), file.getLastModificationTime(), ! file.hasWriteAccess(), project);
+    addOrReplace (project);
+    return true;
+}
+
+void ProjectLibrary::addOrReplace (const Project& project)
+{
+    const String path (project.file.getFullPathName());
+
+    if (indexByPath.contains (path))
+    {
+        projects.setUnchecked (indexByPath [path], project);
+    }
+    else
+    {
+        indexByPath.set (path, projects.size());
+        projects.add (project);
+    }
+}
+
+void ProjectLibrary::rebuildIndexByPath()
+{
+    indexByPath.clear();
+
+    for (int i = 0; i < projects.size(); ++i)
+        indexByPath.set (projects.getReference (i).file.getFullPathName(), i);
+}
+
+void ProjectLibrary::publish (const bool isUpToDate)
+{
+    Snapshot::Ptr s (new Snapshot());
+    s->projects = projects;
+    s->isUpToDate = isUpToDate;
+
+    ProjectNameComparator comparator;
+    s->projects.sort (comparator, true);
+
+    {
+        const ScopedLock sl (snapshotLock);
+        snapshot = s;
+    }
+
+    sendChangeMessage();
+}
+
+//==============================================================================
+void ProjectLibrary::loadIndex()
+{
+    XmlDocument doc (indexFile);
+    ScopedPointer<XmlElement> xml (doc.getDocumentElement());
+
+    if (xml == nullptr || ! xml->hasTagName ("PROJECTINDEX"))
+        return;
+
+    forEachXmlChildElementWithTagName (*xml, e, "PROJECT")
+    {
+        Project project;
+        project.file = File (e->getStringAttribute ("file"));
+        project.name = project.file.getFileNameWithoutExtension();
+        project.size = e->getStringAttribute ("size").getLargeIntValue();
+        project.modified = Time (e->getStringAttribute ("modified").getLargeIntValue());
+        project.isTemplate = e->getBoolAttribute ("template");
+
+        forEachXmlChildElementWithTagName (*e, plugin, "PLUGIN")
+            project.plugins.add (plugin->getStringAttribute ("name"));
+
+        forEachXmlChildElementWithTagName (*e, node, "NODE")
+            project.nodePositions.add (Point<float> ((float) node->getDoubleAttribute ("x"),
+                                                     (float) node->getDoubleAttribute ("y")));
+
+        // An index written for a different projects folder is no use.
+        if (project.file.isAChildOf (folder))
+            addOrReplace (project);
+    }
+}
+
+void ProjectLibrary::saveIndex() const
+{
+    XmlElement xml ("PROJECTINDEX");
+
+    for (int i = 0; i < projects.size(); ++i)
+    {
+        const Project& project = projects.getReference (i);
+        XmlElement* const e = xml.createNewChildElement ("PROJECT");
+
+        e->setAttribute ("file", project.file.getFullPathName());
+        e->setAttribute ("size", String (project.size));
+        e->setAttribute ("modified", String (project.modified.toMilliseconds()));
+        e->setAttribute ("template", project.isTemplate);
+
+        for (int j = 0; j < project.plugins.size(); ++j)
+            e->createNewChildElement ("PLUGIN")->setAttribute ("name", project.plugins[j]);
+
+        for (int j = 0; j < project.nodePositions.size(); ++j)
+        {
+            XmlElement* const node = e->createNewChildElement ("NODE");
+            node->setAttribute ("x", project.nodePositions.getReference (j).x);
+            node->setAttribute ("y", project.nodePositions.getReference (j).y);
+        }
+    }
+
+    xml.writeToFile (indexFile, String());
+}
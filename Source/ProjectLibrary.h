@@ -0,0 +1,102 @@
+/*
+  ==============================================================================
+
+    ProjectLibrary.h
+    Middle
+
+  ==============================================================================
+*/
+
+#ifndef __PROJECTLIBRARY_JUCEHEADER__
+#define __PROJECTLIBRARY_JUCEHEADER__
+
+#include <atomic>
+
+
+//==============================================================================
+/**
+    An index of the projects in the user's projects folder, kept up to date on
+    a background thread so the browsers never touch the disk themselves.
+
+    Each project's name, plugins, size and node layout are read once and kept,
+    along with the file's size and modification time, in an index file next to
+    the app settings. On the next launch the old index is shown straight away
+    while the folder is checked, and only files that have changed are read
+    again. After that the folder is watched with inotify on Linux, and rescanned
+    now and then elsewhere.
+
+    Use it through a SharedResourcePointer, so every browser shares the same
+    index. Results are handed out as immutable snapshots, and a change message
+    is sent whenever a new one is published.
+*/
+class ProjectLibrary   : public ChangeBroadcaster,
+                         private Thread
+{
+public:
+    ProjectLibrary();
+    ~ProjectLibrary();
+
+    //==============================================================================
+    struct Project
+    {
+        File file;
+        String name;
+        StringArray plugins;
+        int64 size;
+        Time modified;
+        bool isTemplate;
+
+        /** Where each node sits, in the graph's own units, for drawing a thumbnail. */
+        Array<Point<float> > nodePositions;
+    };
+
+    /** The projects at one moment, sorted by name. Never changed once published. */
+    class Snapshot   : public ReferenceCountedObject
+    {
+    public:
+        typedef ReferenceCountedObjectPtr<Snapshot> Ptr;
+
+        Array<Project> projects;
+
+        /** False until the folder itself has been checked, i.e. while only the saved index is known. */
+        bool isUpToDate;
+    };
+
+    /** Returns the latest snapshot; never nullptr. Can be called from any thread. */
+    Snapshot::Ptr getSnapshot() const;
+
+    /** Asks for the folder to be checked again, e.g. after saving a project into it. */
+    void refresh();
+
+    /** The folder that's indexed: Documents/Middle/Projects. */
+    static File getProjectsFolder();
+
+private:
+    //==============================================================================
+    const File folder, indexFile;
+
+    CriticalSection snapshotLock;
+    Snapshot::Ptr snapshot;
+
+    // Only touched by the indexing thread.
+    Array<Project> projects;
+    HashMap<String, int> indexByPath;
+
+    std::atomic<bool> refreshRequested;
+
+    void run() override;
+
+    bool rescan();
+    bool updateFile (const File&);
+    void addOrReplace (const Project&);
+    void rebuildIndexByPath();
+    void publish (bool isUpToDate);
+
+    void loadIndex();
+    void saveIndex() const;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (ProjectLibrary)
+};
+
+
+#endif   // __PROJECTLIBRARY_JUCEHEADER__
@@ -0,0 +1,234 @@
+/*
+  ==============================================================================
+
+    RackProcessor.cpp
+    Middle
+
+  ==============================================================================
+*/
+
+#include "../JuceLibraryCode/JuceHeader.h"
+#include "RackProcessor.h"
+#include "GraphEditorPanel.h"
+
+
+//==============================================================================
+const char* const RackProcessor::rackName = "Rack";
+
+static const int maxRackChannels = 32;
+
+//==============================================================================
+RackProcessor::RackProcessor (AudioPluginFormatManager& formatManager)
+    : RackProcessor (rackName, formatManager)
+{
+}
+
+RackProcessor::RackProcessor (const String& name, AudioPluginFormatManager& formatManager)
+    : InternalPlugin (name, BusesProperties().withInput  ("Input",  AudioChannelSet::stereo())
+                                             .withOutput ("Output", AudioChannelSet::stereo())),
+      innerGraph (formatManager)
+{
+    innerGraph.addChangeListener (this);
+}
+
+RackProcessor::~RackProcessor()
+{
+    innerGraph.removeChangeListener (this);
+}
+
+bool RackProcessor::isBusesLayoutSupported (const BusesLayout& layouts) const
+{
+    if (layouts.inputBuses.size() != 1 || layouts.outputBuses.size() != 1)
+        return false;
+
+    const int numIns  = layouts.getMainInputChannelSet().size();
+    const int numOuts = layouts.getMainOutputChannelSet().size();
+
+    return numIns <= maxRackChannels && numOuts > 0 && numOuts <= maxRackChannels;
+}
+
+AudioProcessorEditor* RackProcessor::createEditor()
+{
+    return new RackEditor (*this);
+}
+
+//==============================================================================
+void RackProcessor::prepareToPlay (double sampleRate, int maximumExpectedSamplesPerBlock)
+{
+    AudioProcessorGraph& graph = innerGraph.getGraph();
+
+    // The inner graph's I/O nodes take their channel counts from this.
+    graph.setPlayConfigDetails (getTotalNumInputChannels(), getTotalNumOutputChannels(),
+                                sampleRate, maximumExpectedSamplesPerBlock);
+    graph.prepareToPlay (sampleRate, maximumExpectedSamplesPerBlock);
+
+    updateLatency();
+}
+
+void RackProcessor::releaseResources()
+{
+    innerGraph.getGraph().releaseResources();
+}
+
+void RackProcessor::renderBlock (AudioBuffer<float>& buffer, MidiBuffer& midiMessages)
+{
+    measureInnerInput (buffer, midiMessages);
+    processInnerGraph (buffer, midiMessages);
+}
+
+void RackProcessor::processInnerGraph (AudioBuffer<float>& buffer, MidiBuffer& midiMessages)
+{
+    AudioProcessorGraph& graph = innerGraph.getGraph();
+    const ScopedLock sl (graph.getCallbackLock());
+
+    if (graph.isSuspended())
+    {
+        buffer.clear();
+        midiMessages.clear();
+    }
+    else
+    {
+        graph.processBlock (buffer, midiMessages);
+    }
+}
+
+void RackProcessor::measureInnerInput (const AudioBuffer<float>& buffer, const MidiBuffer& midiMessages) noexcept
+{
+    SignalTap& tap = innerGraph.getInputTap();
+    tap.measure (buffer, getTotalNumInputChannels());
+    tap.countMidi (midiMessages);
+}
+
+//==============================================================================
+void RackProcessor::updateLatency()
+{
+    setLatencySamples (innerGraph.getGraph().getLatencySamples());
+}
+
+void RackProcessor::changeListenerCallback (ChangeBroadcaster*)
+{
+    // Edits inside the rack should mark the outer document as changed too.
+    updateLatency();
+    updateHostDisplay();
+}
+
+File RackProcessor::getDefaultRackFolder()
+{
+    return File::getSpecialLocation (File::userDocumentsDirectory).getChildFile ("Middle/Racks");
+}
+
+XmlElement* RackProcessor::createGraphXml() const
+{
+    return innerGraph.createXml();
+}
+
+void RackProcessor::restoreGraphFromXml (const XmlElement& xml)
+{
+    innerGraph.restoreFromXml (xml);
+}
+
+bool RackProcessor::saveRack (const File& file) const
+{
+    const ScopedPointer<XmlElement> xml (createGraphXml());
+
+    return xml != nullptr && xml->writeToFile (file, String());
+}
+
+bool RackProcessor::loadRack (const File& file)
+{
+    XmlDocument doc (file);
+    const ScopedPointer<XmlElement> xml (doc.getDocumentElement());
+
+    if (xml == nullptr || ! xml->hasTagName ("FILTERGRAPH"))
+        return false;
+
+    restoreGraphFromXml (*xml);
+    return true;
+}
+
+void RackProcessor::writeExtraState (XmlElement& xml) const
+{
+    xml.addChildElement (createGraphXml());
+}
+
+void RackProcessor::readExtraState (const XmlElement& xml)
+{
+    if (const XmlElement* const graphXml = xml.getChildByName ("FILTERGRAPH"))
+        restoreGraphFromXml (*graphXml);
+}
+
+//==============================================================================
+RackEditor::RackEditor (RackProcessor& p, Component* extraControlToOwn)
+    : AudioProcessorEditor (p),
+      rack (p),
+      graphPanel (new GraphEditorPanel (p.getFilterGraph())),
+      extraControl (extraControlToOwn),
+      loadButton ("Load Rack..."),
+      saveButton ("Save Rack...")
+{
+    addAndMakeVisible (loadButton);
+    addAndMakeVisible (saveButton);
+    addAndMakeVisible (graphPanel);
+
+    if (extraControl != nullptr)
+        addAndMakeVisible (extraControl);
+
+    loadButton.addListener (this);
+    saveButton.addListener (this);
+
+    setResizable (true, true);
+    setResizeLimits (300, 240, 4000, 3000);
+    setSize (600, 450);
+
+    graphPanel->updateComponents();
+}
+
+RackEditor::~RackEditor()
+{
+}
+
+void RackEditor::paint (Graphics& g)
+{
+    g.fillAll (getLookAndFeel().findColour (ResizableWindow::backgroundColourId));
+}
+
+void RackEditor::resized()
+{
+    Rectangle<int> r (getLocalBounds());
+
+    Rectangle<int> top (r.removeFromTop (32).reduced (4));
+    loadButton.setBounds (top.removeFromLeft (100));
+    top.removeFromLeft (8);
+    saveButton.setBounds (top.removeFromLeft (100));
+
+    if (extraControl != nullptr)
+    {
+        top.removeFromLeft (8);
+        extraControl->setBounds (top.removeFromLeft (jmax (100, extraControl->getWidth())));
+    }
+
+    graphPanel->setBounds (r);
+}
+
+void RackEditor::buttonClicked (Button* b)
+{
+    RackProcessor::getDefaultRackFolder().createDirectory();
+
+    if (b == &loadButton)
+    {
+        FileChooser chooser ("Load a rack...", RackProcessor::getDefaultRackFolder(), rackFilenameWildcard);
+
+        if (chooser.browseForFileToOpen() && ! rack.loadRack (chooser.getResult()))
+            AlertWindow::showMessageBoxAsync (AlertWindow::WarningIcon, "Rack",
+                                              "Couldn't load " + chooser.getResult().getFullPathName());
+    }
+    else if (b == &saveButton)
+    {
+        FileChooser chooser ("Save this rack...", RackProcessor::getDefaultRackFolder(), rackFilenameWildcard);
+
+        if (chooser.browseForFileToSave (true)
+             && ! rack.saveRack (chooser.getResult().withFileExtension (rackFilenameSuffix)))
+            AlertWindow::showMessageBoxAsync (AlertWindow::WarningIcon, "Rack",
+                                              "Couldn't save " + chooser.getResult().getFullPathName());
+    }
+}
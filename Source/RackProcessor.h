@@ -0,0 +1,125 @@
+/*
+  ==============================================================================
+
+    RackProcessor.h
+    Middle
+
+  ==============================================================================
+*/
+
+#ifndef __RACKPROCESSOR_JUCEHEADER__
+#define __RACKPROCESSOR_JUCEHEADER__
+
+#include "InternalProcessors.h"
+#include "FilterGraph.h"
+
+class GraphEditorPanel;
+
+const char* const rackFilenameSuffix = ".middlerack";
+const char* const rackFilenameWildcard = "*.middlerack";
+
+
+//==============================================================================
+/**
+    A whole FilterGraph wrapped up as a single node.
+
+    The rack owns its own graph, complete with audio and midi I/O nodes, and
+    just hands each block straight to it. That lets a chain of processors be
+    collapsed into one node in the editor, saved on its own as a .middlerack
+    file, and dropped into other projects.
+
+    The inner graph is kept in the node's state as a nested FILTERGRAPH element.
+    A saved project stores internal nodes' state as xml, so it stays readable
+    instead of ending up as an opaque base64 blob.
+*/
+class RackProcessor   : public InternalPlugin,
+                        private ChangeListener
+{
+public:
+    RackProcessor (AudioPluginFormatManager&);
+    ~RackProcessor();
+
+    static const char* const rackName;
+
+    //==============================================================================
+    void prepareToPlay (double sampleRate, int maximumExpectedSamplesPerBlock) override;
+    void releaseResources() override;
+    void renderBlock (AudioBuffer<float>&, MidiBuffer&) override;
+
+    bool isBusesLayoutSupported (const BusesLayout&) const override;
+    bool acceptsMidi() const override                                   { return true; }
+
+    AudioProcessorEditor* createEditor() override;
+
+    //==============================================================================
+    FilterGraph& getFilterGraph() noexcept                               { return innerGraph; }
+
+    /** The inner graph as a FILTERGRAPH element, plus anything a subclass needs to keep with it. */
+    virtual XmlElement* createGraphXml() const;
+    virtual void restoreGraphFromXml (const XmlElement&);
+
+    /** Writes the inner graph to a .middlerack file. */
+    bool saveRack (const File&) const;
+
+    /** Replaces the inner graph with the contents of a .middlerack file. */
+    bool loadRack (const File&);
+
+    /** The folder that the editor's file choosers start in. */
+    static File getDefaultRackFolder();
+
+protected:
+    //==============================================================================
+    RackProcessor (const String& name, AudioPluginFormatManager&);
+
+    /** Called whenever the inner graph changes, so the rack can report its latency. */
+    virtual void updateLatency();
+
+    /** Measures a block on its way into the inner graph, for the wires leaving its input nodes. */
+    void measureInnerInput (const AudioBuffer<float>&, const MidiBuffer&) noexcept;
+
+    /** Runs a block through the inner graph. Like an AudioProcessorPlayer, this holds
+        the graph's callback lock, which the graph takes while it swaps in a new
+        rendering sequence after an edit and deletes the old one.
+    */
+    void processInnerGraph (AudioBuffer<float>&, MidiBuffer&);
+
+    FilterGraph innerGraph;
+
+private:
+    //==============================================================================
+    void changeListenerCallback (ChangeBroadcaster*) override;
+
+    void writeExtraState (XmlElement&) const override;
+    void readExtraState (const XmlElement&) override;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (RackProcessor)
+};
+
+//==============================================================================
+/**
+    Shows a rack's inner graph, with buttons to load and save it. Subclasses of
+    RackProcessor can pass in an extra control to sit next to the buttons.
+*/
+class RackEditor   : public AudioProcessorEditor,
+                     private Button::Listener
+{
+public:
+    RackEditor (RackProcessor&, Component* extraControlToOwn = nullptr);
+    ~RackEditor();
+
+    void paint (Graphics&) override;
+    void resized() override;
+
+private:
+    RackProcessor& rack;
+    ScopedPointer<GraphEditorPanel> graphPanel;
+    ScopedPointer<Component> extraControl;
+    TextButton loadButton, saveButton;
+
+    void buttonClicked (Button*) override;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (RackEditor)
+};
+
+
+#endif   // __RACKPROCESSOR_JUCEHEADER__
@@ -0,0 +1,497 @@
+/*
+  ==============================================================================
+
+    RecorderProcessor.cpp
+    Middle
+
+  ==============================================================================
+*/
+
+#include "../JuceLibraryCode/JuceHeader.h"
+#include "RecorderProcessor.h"
+
+#if JUCE_LINUX || JUCE_MAC
+ #include <fcntl.h>
+ #include <unistd.h>
+#endif
+
+#if JUCE_LINUX
+ #include <linux/falloc.h>
+#endif
+
+
+//==============================================================================
+static const double fifoSeconds = 10.0;
+static const double preallocateSeconds = 300.0;
+static const int bitsPerSample = 24;
+static const size_t diskBlockSize = 1 << 20;
+
+/** Reserves disk space for a file without changing its length, so the file
+    system can lay it out contiguously and the writer never has to wait for
+    block allocation. Where this isn't available it just does nothing.
+*/
+static bool preallocateFileSpace (const File& file, int64 offset, int64 numBytes)
+{
+   #if JUCE_LINUX || JUCE_MAC
+    const int fd = ::open (file.getFullPathName().toRawUTF8(), O_WRONLY);
+
+    if (fd < 0)
+        return false;
+
+   #if JUCE_LINUX
+    const bool ok = fallocate (fd, FALLOC_FL_KEEP_SIZE, (off_t) offset, (off_t) numBytes) == 0;
+   #else
+    ignoreUnused (offset);
+
+    fstore_t store = { F_ALLOCATECONTIG, F_PEOFPOSMODE, 0, (off_t) numBytes, 0 };
+    bool ok = fcntl (fd, F_PREALLOCATE, &store) != -1;
+
+    if (! ok)
+    {
+        store.fst_flags = F_ALLOCATEALL;
+        ok = fcntl (fd, F_PREALLOCATE, &store) != -1;
+    }
+   #endif
+
+    ::close (fd);
+    return ok;
+   #else
+    ignoreUnused (file, offset, numBytes);
+    return false;
+   #endif
+}
+
+//==============================================================================
+/**
+    Collects whatever is written to it and passes it on to the file in
+    diskBlockSize chunks, so every write the drive sees is large and starts
+    on a block boundary.
+*/
+class BlockWriteStream   : public OutputStream
+{
+public:
+    BlockWriteStream (FileOutputStream* destination)
+        : output (destination), block (diskBlockSize), numBytesInBlock (0)
+    {
+    }
+
+    ~BlockWriteStream()
+    {
+        flush();
+    }
+
+    void flush() override
+    {
+        if (numBytesInBlock > 0)
+        {
+            output->write (block.getData(), numBytesInBlock);
+            numBytesInBlock = 0;
+        }
+
+        output->flush();
+    }
+
+    int64 getPosition() override
+    {
+        return output->getPosition() + (int64) numBytesInBlock;
+    }
+
+    bool setPosition (int64 newPosition) override
+    {
+        flush();
+        return output->setPosition (newPosition);
+    }
+
+    bool write (const void* data, size_t numBytes) override
+    {
+        const char* source = static_cast<const char*> (data);
+
+        while (numBytes > 0)
+        {
+            const size_t numToCopy = jmin (numBytes, diskBlockSize - numBytesInBlock);
+            memcpy (block.getData() + numBytesInBlock, source, numToCopy);
+
+            numBytesInBlock += numToCopy;
+            source += numToCopy;
+            numBytes -= numToCopy;
+
+            if (numBytesInBlock == diskBlockSize)
+            {
+                if (! output->write (block.getData(), diskBlockSize))
+                    return false;
+
+                numBytesInBlock = 0;
+            }
+        }
+
+        return true;
+    }
+
+private:
+    ScopedPointer<FileOutputStream> output;
+    HeapBlock<char> block;
+    size_t numBytesInBlock;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (BlockWriteStream)
+};
+
+//==============================================================================
+static String formatTime (double seconds)
+{
+    const int totalSeconds = (int) seconds;
+    return String (totalSeconds / 60) + ":" + String (totalSeconds % 60).paddedLeft ('0', 2);
+}
+
+class RecorderEditor   : public AudioProcessorEditor,
+                         private Button::Listener,
+                         private Timer
+{
+public:
+    RecorderEditor (RecorderProcessor& p)
+        : AudioProcessorEditor (p),
+          recorder (p),
+          recordButton ("Record"),
+          folderButton ("Show Folder")
+    {
+        addAndMakeVisible (recordButton);
+        addAndMakeVisible (folderButton);
+        addAndMakeVisible (statusLabel);
+
+        recordButton.addListener (this);
+        folderButton.addListener (this);
+
+        setSize (380, 100);
+        timerCallback();
+        startTimerHz (10);
+    }
+
+    void paint (Graphics& g) override
+    {
+        g.fillAll (getLookAndFeel().findColour (ResizableWindow::backgroundColourId));
+
+        const float headroom = recorder.getHeadroom();
+        const Rectangle<float> bar (meterArea.toFloat());
+
+        g.setColour (Colours::black.withAlpha (0.2f));
+        g.fillRect (bar);
+
+        g.setColour (headroom > 0.5f ? Colours::green : (headroom > 0.2f ? Colours::orange : Colours::red));
+        g.fillRect (bar.withWidth (bar.getWidth() * (1.0f - headroom)));
+
+        g.setColour (Colours::black);
+        g.setFont (12.0f);
+        g.drawText ("Buffer headroom " + String (roundToInt (headroom * 100.0f)) + "%"
+                      + " (worst " + String (roundToInt (recorder.getWorstHeadroom() * 100.0f)) + "%)",
+                    meterArea.reduced (4, 0), Justification::centredLeft, true);
+    }
+
+    void resized() override
+    {
+        Rectangle<int> r (getLocalBounds().reduced (8));
+
+        Rectangle<int> top (r.removeFromTop (24));
+        recordButton.setBounds (top.removeFromLeft (80));
+        top.removeFromLeft (8);
+        folderButton.setBounds (top.removeFromLeft (100));
+
+        r.removeFromTop (8);
+        statusLabel.setBounds (r.removeFromTop (20));
+        r.removeFromTop (8);
+        meterArea = r.removeFromTop (20);
+    }
+
+private:
+    RecorderProcessor& recorder;
+    TextButton recordButton, folderButton;
+    Label statusLabel;
+    Rectangle<int> meterArea;
+
+    void buttonClicked (Button* b) override
+    {
+        if (b == &recordButton)
+        {
+            if (recorder.isRecording())
+                recorder.stopRecording();
+            else if (! recorder.startRecording())
+                AlertWindow::showMessageBoxAsync (AlertWindow::WarningIcon, "Recorder",
+                                                  "Couldn't start recording into " + recorder.getRecordingFolder().getFullPathName());
+        }
+        else if (b == &folderButton)
+        {
+            recorder.getRecordingFolder().createDirectory();
+            recorder.getRecordingFolder().revealToUser();
+        }
+
+        timerCallback();
+    }
+
+    void timerCallback() override
+    {
+        recordButton.setButtonText (recorder.isRecording() ? "Stop" : "Record");
+
+        String status;
+
+        if (recorder.hasWriteFailed())
+            status = "Disk write failed: ";
+        else if (recorder.isRecording())
+            status = "Recording: ";
+
+        if (recorder.getRecordingFile() != File())
+            status << recorder.getRecordingFile().getFileName() << "  " << formatTime (recorder.getRecordedSeconds());
+
+        if (recorder.getNumDroppedSamples() > 0)
+            status << "  (" << String (recorder.getNumDroppedSamples()) << " samples dropped)";
+
+        statusLabel.setText (status, dontSendNotification);
+        repaint (meterArea);
+    }
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (RecorderEditor)
+};
+
+//==============================================================================
+const char* const RecorderProcessor::recorderName = "Recorder";
+
+RecorderProcessor::RecorderProcessor()
+    : InternalPlugin (recorderName, BusesProperties().withInput  ("Input",  AudioChannelSet::stereo())
+                                                     .withOutput ("Output", AudioChannelSet::stereo())),
+      Thread ("Recorder Writer"),
+      fifo (1024),
+      currentSampleRate (44100.0),
+      numChannels (0),
+      recordingFolder (File::getSpecialLocation (File::userDocumentsDirectory).getChildFile ("Middle/Recordings")),
+      bytesPreallocated (0),
+      recording (false),
+      writeFailed (false),
+      minFreeSpace (0),
+      framesWritten (0),
+      droppedSamples (0)
+{
+}
+
+RecorderProcessor::~RecorderProcessor()
+{
+    stopRecording();
+}
+
+bool RecorderProcessor::isBusesLayoutSupported (const BusesLayout& layouts) const
+{
+    const AudioChannelSet& in = layouts.getMainInputChannelSet();
+
+    return layouts.inputBuses.size() == 1 && layouts.outputBuses.size() == 1
+            && (in == AudioChannelSet::mono() || in == AudioChannelSet::stereo())
+            && in == layouts.getMainOutputChannelSet();
+}
+
+AudioProcessorEditor* RecorderProcessor::createEditor()
+{
+    return new RecorderEditor (*this);
+}
+
+//==============================================================================
+void RecorderProcessor::prepareToPlay (double sampleRate, int)
+{
+    stopRecording();
+
+    currentSampleRate = sampleRate;
+    numChannels = jmax (1, getTotalNumInputChannels());
+
+    fifo.setTotalSize (roundToInt (sampleRate * fifoSeconds) + 1);
+    fifoBuffer.setSize (numChannels, fifo.getTotalSize());
+}
+
+void RecorderProcessor::releaseResources()
+{
+    stopRecording();
+
+    numChannels = 0;
+    fifoBuffer.setSize (0, 0);
+}
+
+void RecorderProcessor::renderBlock (AudioBuffer<float>& buffer, MidiBuffer&)
+{
+    // The audio passes straight through; while recording it's also copied into the fifo.
+    if (! recording.load())
+        return;
+
+    const int numSamples = buffer.getNumSamples();
+    const int numToCopy = jmin (numChannels, buffer.getNumChannels());
+
+    int start1, size1, start2, size2;
+    fifo.prepareToWrite (numSamples, start1, size1, start2, size2);
+
+    for (int ch = 0; ch < numToCopy; ++ch)
+    {
+        fifoBuffer.copyFrom (ch, start1, buffer, ch, 0, size1);
+
+        if (size2 > 0)
+            fifoBuffer.copyFrom (ch, start2, buffer, ch, size1, size2);
+    }
+
+    fifo.finishedWrite (size1 + size2);
+
+    if (size1 + size2 < numSamples)
+        droppedSamples += numSamples - (size1 + size2);
+
+    const int freeSpace = fifo.getFreeSpace();
+
+    if (freeSpace < minFreeSpace.load())
+        minFreeSpace = freeSpace;
+}
+
+//==============================================================================
+bool RecorderProcessor::startRecording()
+{
+    if (recording.load() || numChannels == 0)
+        return false;
+
+    recordingFolder.createDirectory();
+    recordingFile = recordingFolder.getChildFile ("Recording " + Time::getCurrentTime().formatted ("%Y-%m-%d %H-%M-%S") + ".wav")
+                                   .getNonexistentSibling();
+
+    if (recordingFile.create().failed())
+        return false;
+
+    bytesPreallocated = 0;
+    reserveMoreFileSpace();
+
+    ScopedPointer<FileOutputStream> fileStream (recordingFile.createOutputStream());
+
+    if (fileStream == nullptr)
+        return false;
+
+    ScopedPointer<BlockWriteStream> blockStream (new BlockWriteStream (fileStream.release()));
+
+    WavAudioFormat wavFormat;
+    writer = wavFormat.createWriterFor (blockStream, currentSampleRate, (unsigned int) numChannels,
+                                        bitsPerSample, StringPairArray(), 0);
+
+    if (writer == nullptr)
+    {
+        blockStream = nullptr;
+        recordingFile.deleteFile();
+        return false;
+    }
+
+    blockStream.release();
+
+    fifo.reset();
+    framesWritten = 0;
+    droppedSamples = 0;
+    minFreeSpace = fifo.getFreeSpace();
+    writeFailed = false;
+
+    startThread (7);
+    recording = true;
+    return true;
+}
+
+void RecorderProcessor::stopRecording()
+{
+    if (! recording.load())
+        return;
+
+    recording = false;
+
+    // Taking the callback lock waits for any block that was still copying into the fifo.
+    {
+        const ScopedLock sl (getCallbackLock());
+    }
+
+    signalThreadShouldExit();
+    notify();
+    waitForThreadToExit (-1);
+
+    writer = nullptr;
+
+    // Hand back whatever part of the reservation wasn't used.
+    ScopedPointer<FileOutputStream> trimStream (recordingFile.createOutputStream());
+
+    if (trimStream != nullptr)
+        trimStream->truncate();
+}
+
+double RecorderProcessor::getRecordedSeconds() const noexcept
+{
+    return framesWritten.load() / currentSampleRate;
+}
+
+float RecorderProcessor::getHeadroom() const noexcept
+{
+    return fifo.getFreeSpace() / (float) jmax (1, fifo.getTotalSize() - 1);
+}
+
+float RecorderProcessor::getWorstHeadroom() const noexcept
+{
+    if (! recording.load() && framesWritten.load() == 0)
+        return getHeadroom();
+
+    return minFreeSpace.load() / (float) jmax (1, fifo.getTotalSize() - 1);
+}
+
+//==============================================================================
+void RecorderProcessor::run()
+{
+    while (! threadShouldExit())
+    {
+        if (fifo.getNumReady() >= writeBlockFrames)
+            writeFromFifo (writeBlockFrames);
+        else
+            wait (20);
+    }
+
+    while (fifo.getNumReady() > 0)
+        writeFromFifo (jmin (fifo.getNumReady(), (int) writeBlockFrames));
+}
+
+void RecorderProcessor::writeFromFifo (const int numFrames)
+{
+    int start1, size1, start2, size2;
+    fifo.prepareToRead (numFrames, start1, size1, start2, size2);
+
+    if (! writeFailed.load())
+    {
+        bool ok = writer->writeFromAudioSampleBuffer (fifoBuffer, start1, size1);
+
+        if (ok && size2 > 0)
+            ok = writer->writeFromAudioSampleBuffer (fifoBuffer, start2, size2);
+
+        if (ok)
+        {
+            framesWritten += size1 + size2;
+
+            const int64 bytesWritten = framesWritten.load() * numChannels * (bitsPerSample / 8);
+
+            if (bytesWritten + (int64) diskBlockSize * 16 > bytesPreallocated)
+                reserveMoreFileSpace();
+        }
+        else
+        {
+            writeFailed = true;
+        }
+    }
+
+    fifo.finishedRead (size1 + size2);
+}
+
+void RecorderProcessor::reserveMoreFileSpace()
+{
+    const int64 numBytes = (int64) (currentSampleRate * preallocateSeconds) * numChannels * (bitsPerSample / 8);
+
+    preallocateFileSpace (recordingFile, bytesPreallocated, numBytes);
+    bytesPreallocated += numBytes;
+}
+
+//==============================================================================
+void RecorderProcessor::writeExtraState (XmlElement& xml) const
+{
+    xml.setAttribute ("folder", recordingFolder.getFullPathName());
+}
+
+void RecorderProcessor::readExtraState (const XmlElement& xml)
+{
+    const String folder (xml.getStringAttribute ("folder"));
+
+    if (folder.isNotEmpty())
+        recordingFolder = File (folder);
+}
@@ -0,0 +1,96 @@
+/*
+  ==============================================================================
+
+    RecorderProcessor.h
+    Middle
+
+  ==============================================================================
+*/
+
+#ifndef __RECORDERPROCESSOR_JUCEHEADER__
+#define __RECORDERPROCESSOR_JUCEHEADER__
+
+#include <atomic>
+#include "InternalProcessors.h"
+
+
+//==============================================================================
+/**
+    An internal node that records whatever passes through it to a WAV file.
+
+    The audio thread only copies samples into a preallocated AbstractFifo. A
+    writer thread drains the fifo, encodes 24-bit WAV, and writes it in large
+    fixed-size blocks to a file whose space was reserved up front, so slow
+    drives don't show up as dropouts. If the disk falls behind, the fifo's
+    headroom shows it well before any audio is dropped.
+
+    The node is named "Recorder", so the start page's recorder panel finds it
+    just like the third-party plugin of the same name.
+*/
+class RecorderProcessor   : public InternalPlugin,
+                            private Thread
+{
+public:
+    RecorderProcessor();
+
+    static const char* const recorderName;
+    ~RecorderProcessor();
+
+    //==============================================================================
+    void prepareToPlay (double sampleRate, int maximumExpectedSamplesPerBlock) override;
+    void releaseResources() override;
+    void renderBlock (AudioBuffer<float>&, MidiBuffer&) override;
+
+    bool isBusesLayoutSupported (const BusesLayout&) const override;
+
+    AudioProcessorEditor* createEditor() override;
+
+    //==============================================================================
+    /** Starts writing to a new file in the recordings folder. Call on the message thread. */
+    bool startRecording();
+    /** Stops and finalises the current file. Call on the message thread. */
+    void stopRecording();
+
+    bool isRecording() const noexcept                                    { return recording.load(); }
+    const File& getRecordingFile() const noexcept                        { return recordingFile; }
+    double getRecordedSeconds() const noexcept;
+
+    const File& getRecordingFolder() const noexcept                      { return recordingFolder; }
+    void setRecordingFolder (const File& folder)                         { recordingFolder = folder; }
+
+    /** The fraction of the fifo that is currently free, from 0 to 1. */
+    float getHeadroom() const noexcept;
+    /** The lowest headroom seen since recording started. */
+    float getWorstHeadroom() const noexcept;
+    int64 getNumDroppedSamples() const noexcept                          { return droppedSamples.load(); }
+    bool hasWriteFailed() const noexcept                                 { return writeFailed.load(); }
+
+private:
+    //==============================================================================
+    AbstractFifo fifo;
+    AudioBuffer<float> fifoBuffer;
+    double currentSampleRate;
+    int numChannels;
+
+    ScopedPointer<AudioFormatWriter> writer;
+    File recordingFolder, recordingFile;
+    int64 bytesPreallocated;
+
+    std::atomic<bool> recording, writeFailed;
+    std::atomic<int> minFreeSpace;
+    std::atomic<int64> framesWritten, droppedSamples;
+
+    enum { writeBlockFrames = 32768 };
+
+    void run() override;
+    void writeFromFifo (int numFrames);
+    void reserveMoreFileSpace();
+
+    void writeExtraState (XmlElement&) const override;
+    void readExtraState (const XmlElement&) override;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (RecorderProcessor)
+};
+
+
+#endif   // __RECORDERPROCESSOR_JUCEHEADER__
@@ -0,0 +1,397 @@
+/*
+  ==============================================================================
+
+    SampleRateBridgeProcessor.cpp
+    Middle
+
+  ==============================================================================
+*/
+
+#include "../JuceLibraryCode/JuceHeader.h"
+#include "SampleRateBridgeProcessor.h"
+
+
+//==============================================================================
+const char* const SampleRateBridgeProcessor::bridgeName = "Rate Bridge";
+
+static const double innerRates[] = { 22050.0, 32000.0, 44100.0, 48000.0, 88200.0, 96000.0 };
+
+//==============================================================================
+/**
+    A streaming windowed-sinc resampler for any ratio, shared by all channels.
+
+    The kernel is tabulated once and linearly interpolated, and its cutoff
+    follows the lower of the two rates, so it band-limits when going down and
+    interpolates cleanly when going up. Each output sample is delayed by a fixed
+    amount of input time, so the resampler's latency is known up front.
+*/
+class StreamingResampler
+{
+public:
+    StreamingResampler (int numChannelsToUse, double inputRate, double outputRate,
+                        int maxInputSamples, double extraDelay)
+        : numChannels (numChannelsToUse),
+          ratio (inputRate / outputRate),
+          halfWidth (getHalfWidth (inputRate, outputRate)),
+          delay (halfWidth + extraDelay),
+          table ((size_t) (halfWidth * tableResolution + 2)),
+          weights ((size_t) (2 * halfWidth)),
+          history (numChannelsToUse, 3 * halfWidth + (int) std::ceil (delay) + (int) std::ceil (ratio) + maxInputSamples + 4)
+    {
+        const double bandwidth = getBandwidth (inputRate, outputRate);
+        const double beta = 9.0;
+
+        for (int i = 0; i <= halfWidth * tableResolution + 1; ++i)
+        {
+            const double u = i / (double) tableResolution;
+            const double r = jmin (1.0, u / halfWidth);
+            const double x = double_Pi * bandwidth * u;
+            const double sinc = (i == 0) ? 1.0 : std::sin (x) / x;
+
+            table[i] = (float) (bandwidth * sinc * besselI0 (beta * std::sqrt (1.0 - r * r)) / besselI0 (beta));
+        }
+
+        history.clear();
+
+        // Silence before the first input sample, so output starts straight away.
+        numBuffered = (int) std::ceil (delay) + halfWidth;
+        position = numBuffered - delay;
+    }
+
+    /** How many input samples each side of an output sample the kernel reaches. */
+    static int getHalfWidth (double inputRate, double outputRate) noexcept
+    {
+        return (int) std::ceil (zeroCrossings / getBandwidth (inputRate, outputRate));
+    }
+
+    /** The fixed delay through the resampler, in input samples. */
+    double getDelay() const noexcept                                     { return delay; }
+
+    /** The most samples that a call to process() can produce for this many input samples. */
+    int getMaxOutputSamples (int numInputSamples) const noexcept         { return (int) std::ceil (numInputSamples / ratio) + 1; }
+
+    /** Consumes numSamples from the source, and returns how many it wrote to the destination. */
+    int process (const AudioBuffer<float>& source, int sourceStart, int numSamples,
+                 AudioBuffer<float>& dest, int destStart) noexcept
+    {
+        jassert (numBuffered + numSamples <= history.getNumSamples());
+
+        for (int ch = 0; ch < numChannels; ++ch)
+        {
+            if (ch < source.getNumChannels())
+                history.copyFrom (ch, numBuffered, source, ch, sourceStart, numSamples);
+            else
+                history.clear (ch, numBuffered, numSamples);
+        }
+
+        numBuffered += numSamples;
+
+        const int numDestChannels = jmin (numChannels, dest.getNumChannels());
+        int numProduced = 0;
+
+        for (;;)
+        {
+            const int centre = (int) position;
+
+            if (centre + halfWidth >= numBuffered)
+                break;
+
+            const double frac = position - centre;
+            const int first = centre - halfWidth + 1;
+
+            for (int i = 0; i < 2 * halfWidth; ++i)
+                weights[i] = lookUp (std::abs (i - halfWidth + 1 - frac));
+
+            for (int ch = 0; ch < numDestChannels; ++ch)
+            {
+                const float* const in = history.getReadPointer (ch, first);
+                float sum = 0.0f;
+
+                for (int i = 0; i < 2 * halfWidth; ++i)
+                    sum += in[i] * weights[i];
+
+                dest.setSample (ch, destStart + numProduced, sum);
+            }
+
+            ++numProduced;
+            position += ratio;
+        }
+
+        // Drop whatever the next output sample won't reach back to.
+        const int numToDrop = (int) position - halfWidth + 1;
+
+        if (numToDrop > 0)
+        {
+            for (int ch = 0; ch < numChannels; ++ch)
+            {
+                float* const data = history.getWritePointer (ch);
+                memmove (data, data + numToDrop, sizeof (float) * (size_t) (numBuffered - numToDrop));
+            }
+
+            numBuffered -= numToDrop;
+            position -= numToDrop;
+        }
+
+        return numProduced;
+    }
+
+private:
+    enum { zeroCrossings = 16, tableResolution = 512 };
+
+    const int numChannels;
+    const double ratio;
+    const int halfWidth;
+    const double delay;
+    HeapBlock<float> table, weights;
+    AudioBuffer<float> history;
+    int numBuffered;
+    double position;
+
+    /** The cutoff as a fraction of the input's Nyquist, with a little room for the transition band. */
+    static double getBandwidth (double inputRate, double outputRate) noexcept
+    {
+        return 0.92 * jmin (1.0, outputRate / inputRate);
+    }
+
+    float lookUp (double u) const noexcept
+    {
+        const double x = u * tableResolution;
+        const int i = (int) x;
+        const float f = (float) (x - i);
+
+        return table[i] + f * (table[i + 1] - table[i]);
+    }
+
+    static double besselI0 (double x) noexcept
+    {
+        double sum = 1.0, term = 1.0;
+
+        for (int k = 1; k < 32; ++k)
+        {
+            const double t = x / (2.0 * k);
+            term *= t * t;
+            sum += term;
+        }
+
+        return sum;
+    }
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (StreamingResampler)
+};
+
+//==============================================================================
+class BridgeRateSelector   : public ComboBox,
+                             private ComboBox::Listener
+{
+public:
+    BridgeRateSelector (SampleRateBridgeProcessor& p)
+        : bridge (p)
+    {
+        for (int i = 0; i < numElementsInArray (innerRates); ++i)
+        {
+            addItem ("Inner rate " + String (innerRates[i] / 1000.0) + " kHz", i + 1);
+
+            if (innerRates[i] == p.getInnerSampleRate())
+                setSelectedId (i + 1, dontSendNotification);
+        }
+
+        addListener (this);
+        setSize (170, 24);
+    }
+
+private:
+    SampleRateBridgeProcessor& bridge;
+
+    void comboBoxChanged (ComboBox*) override
+    {
+        if (getSelectedId() > 0)
+            bridge.setInnerSampleRate (innerRates[getSelectedId() - 1]);
+    }
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (BridgeRateSelector)
+};
+
+//==============================================================================
+SampleRateBridgeProcessor::SampleRateBridgeProcessor (AudioPluginFormatManager& formatManager)
+    : RackProcessor (bridgeName, formatManager),
+      numInFifo (0),
+      innerSampleRate (44100.0),
+      outerSampleRate (44100.0),
+      outerBlockSize (512),
+      resamplingLatency (0),
+      isPrepared (false)
+{
+}
+
+SampleRateBridgeProcessor::~SampleRateBridgeProcessor()
+{
+}
+
+AudioProcessorEditor* SampleRateBridgeProcessor::createEditor()
+{
+    return new RackEditor (*this, new BridgeRateSelector (*this));
+}
+
+//==============================================================================
+void SampleRateBridgeProcessor::prepareToPlay (double sampleRate, int maximumExpectedSamplesPerBlock)
+{
+    outerSampleRate = sampleRate;
+    outerBlockSize = maximumExpectedSamplesPerBlock;
+
+    prepareBridge();
+
+    isPrepared = true;
+    updateLatency();
+}
+
+void SampleRateBridgeProcessor::releaseResources()
+{
+    RackProcessor::releaseResources();
+    isPrepared = false;
+}
+
+void SampleRateBridgeProcessor::prepareBridge()
+{
+    if (! isResampling())
+    {
+        inputResampler = nullptr;
+        outputResampler = nullptr;
+        resamplingLatency = 0;
+
+        RackProcessor::prepareToPlay (outerSampleRate, outerBlockSize);
+        return;
+    }
+
+    const int numIns  = getTotalNumInputChannels();
+    const int numOuts = getTotalNumOutputChannels();
+    const int maxInnerBlockSize = (int) std::ceil (outerBlockSize * innerSampleRate / outerSampleRate) + 1;
+
+    AudioProcessorGraph& graph = innerGraph.getGraph();
+    graph.setPlayConfigDetails (numIns, numOuts, innerSampleRate, maxInnerBlockSize);
+    graph.prepareToPlay (innerSampleRate, maxInnerBlockSize);
+
+    inputResampler = new StreamingResampler (jmax (1, numIns), outerSampleRate, innerSampleRate, outerBlockSize, 0.0);
+    jassert (inputResampler->getMaxOutputSamples (outerBlockSize) <= maxInnerBlockSize);
+
+    // Each side can come out a sample short on any block; this much in the fifo covers it.
+    const int fifoPrefill = 4 + 2 * (int) std::ceil (outerSampleRate / innerSampleRate);
+
+    // Pad the output resampler's delay so the whole trip is a whole number of samples.
+    const double outputDelay = StreamingResampler::getHalfWidth (innerSampleRate, outerSampleRate)
+                                  * outerSampleRate / innerSampleRate;
+    const double totalDelay = inputResampler->getDelay() + outputDelay + fifoPrefill;
+
+    resamplingLatency = (int) std::ceil (totalDelay);
+
+    outputResampler = new StreamingResampler (jmax (1, numOuts), innerSampleRate, outerSampleRate, maxInnerBlockSize,
+                                              (resamplingLatency - totalDelay) * innerSampleRate / outerSampleRate);
+
+    innerBuffer.setSize (jmax (1, numIns, numOuts), maxInnerBlockSize);
+    innerMidi.ensureSize (2048);
+
+    outputFifo.setSize (jmax (1, numOuts), fifoPrefill + outputResampler->getMaxOutputSamples (maxInnerBlockSize) + outerBlockSize);
+    outputFifo.clear();
+    numInFifo = fifoPrefill;
+}
+
+void SampleRateBridgeProcessor::updateLatency()
+{
+    const int graphLatency = roundToInt (innerGraph.getGraph().getLatencySamples() * outerSampleRate / innerSampleRate);
+
+    setLatencySamples (resamplingLatency + graphLatency);
+}
+
+//==============================================================================
+void SampleRateBridgeProcessor::renderBlock (AudioBuffer<float>& buffer, MidiBuffer& midiMessages)
+{
+    if (inputResampler == nullptr)
+    {
+        RackProcessor::renderBlock (buffer, midiMessages);
+        return;
+    }
+
+    const int numSamples = buffer.getNumSamples();
+
+    for (int start = 0; start < numSamples; start += outerBlockSize)
+        processChunk (buffer, midiMessages, start, jmin (outerBlockSize, numSamples - start));
+}
+
+void SampleRateBridgeProcessor::processChunk (AudioBuffer<float>& buffer, MidiBuffer& midiMessages,
+                                              int startSample, int numSamples)
+{
+    const int numIns  = getTotalNumInputChannels();
+    const int numOuts = jmin (getTotalNumOutputChannels(), buffer.getNumChannels(), outputFifo.getNumChannels());
+
+    const int numInner = inputResampler->process (buffer, startSample, numSamples, innerBuffer, 0);
+
+    for (int ch = numIns; ch < innerBuffer.getNumChannels(); ++ch)
+        innerBuffer.clear (ch, 0, numInner);
+
+    innerMidi.clear();
+
+    MidiBuffer::Iterator iter (midiMessages);
+    MidiMessage message;
+    int position;
+
+    while (iter.getNextEvent (message, position))
+        if (position >= startSample && position < startSample + numSamples && numInner > 0)
+            innerMidi.addEvent (message, jmin (numInner - 1, (position - startSample) * numInner / numSamples));
+
+    if (numInner > 0)
+    {
+        AudioBuffer<float> inner (innerBuffer.getArrayOfWritePointers(), innerBuffer.getNumChannels(), numInner);
+        measureInnerInput (inner, innerMidi);
+        processInnerGraph (inner, innerMidi);
+
+        numInFifo += outputResampler->process (inner, 0, numInner, outputFifo, numInFifo);
+    }
+
+    const int numToRead = jmin (numSamples, numInFifo);
+
+    for (int ch = 0; ch < numOuts; ++ch)
+    {
+        buffer.copyFrom (ch, startSample, outputFifo, ch, 0, numToRead);
+
+        if (numToRead < numSamples)
+            buffer.clear (ch, startSample + numToRead, numSamples - numToRead);
+
+        float* const data = outputFifo.getWritePointer (ch);
+        memmove (data, data + numToRead, sizeof (float) * (size_t) (numInFifo - numToRead));
+    }
+
+    numInFifo -= numToRead;
+}
+
+//==============================================================================
+void SampleRateBridgeProcessor::setInnerSampleRate (double newRate)
+{
+    if (newRate == innerSampleRate || newRate <= 0.0)
+        return;
+
+    suspendProcessing (true);
+    innerSampleRate = newRate;
+
+    if (isPrepared)
+    {
+        innerGraph.getGraph().releaseResources();
+        prepareBridge();
+    }
+
+    suspendProcessing (false);
+
+    updateLatency();
+    updateHostDisplay();
+}
+
+XmlElement* SampleRateBridgeProcessor::createGraphXml() const
+{
+    XmlElement* const xml = RackProcessor::createGraphXml();
+    xml->setAttribute ("sampleRate", innerSampleRate);
+    return xml;
+}
+
+void SampleRateBridgeProcessor::restoreGraphFromXml (const XmlElement& xml)
+{
+    setInnerSampleRate (xml.getDoubleAttribute ("sampleRate", innerSampleRate));
+    RackProcessor::restoreGraphFromXml (xml);
+}
@@ -0,0 +1,75 @@
+/*
+  ==============================================================================
+
+    SampleRateBridgeProcessor.h
+    Middle
+
+  ==============================================================================
+*/
+
+#ifndef __SAMPLERATEBRIDGEPROCESSOR_JUCEHEADER__
+#define __SAMPLERATEBRIDGEPROCESSOR_JUCEHEADER__
+
+#include "RackProcessor.h"
+
+class StreamingResampler;
+
+
+//==============================================================================
+/**
+    A rack whose inner graph runs at a fixed sample rate of its own.
+
+    Audio is resampled into the inner rate with a windowed-sinc resampler, run
+    through the inner graph in whatever block size that produces, and resampled
+    back out. A short fifo on the way out absorbs the one-sample jitter in how
+    many samples each side produces per block. The total delay is fixed and
+    rounded up to a whole number of samples, and it's reported as latency.
+
+    This lets plugins that only behave at one rate run inside a graph at another,
+    and lets expensive processing run at a lower rate than the rest of the graph.
+*/
+class SampleRateBridgeProcessor   : public RackProcessor
+{
+public:
+    SampleRateBridgeProcessor (AudioPluginFormatManager&);
+    ~SampleRateBridgeProcessor();
+
+    static const char* const bridgeName;
+
+    //==============================================================================
+    void prepareToPlay (double sampleRate, int maximumExpectedSamplesPerBlock) override;
+    void releaseResources() override;
+    void renderBlock (AudioBuffer<float>&, MidiBuffer&) override;
+
+    AudioProcessorEditor* createEditor() override;
+
+    //==============================================================================
+    /** Changes the rate the inner graph runs at. Call on the message thread. */
+    void setInnerSampleRate (double newRate);
+    double getInnerSampleRate() const noexcept                           { return innerSampleRate; }
+
+    XmlElement* createGraphXml() const override;
+    void restoreGraphFromXml (const XmlElement&) override;
+
+private:
+    //==============================================================================
+    ScopedPointer<StreamingResampler> inputResampler, outputResampler;
+    AudioBuffer<float> innerBuffer, outputFifo;
+    MidiBuffer innerMidi;
+    int numInFifo;
+
+    double innerSampleRate, outerSampleRate;
+    int outerBlockSize, resamplingLatency;
+    bool isPrepared;
+
+    bool isResampling() const noexcept                                   { return innerSampleRate != outerSampleRate; }
+
+    void prepareBridge();
+    void processChunk (AudioBuffer<float>&, MidiBuffer&, int startSample, int numSamples);
+    void updateLatency() override;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (SampleRateBridgeProcessor)
+};
+
+
+#endif   // __SAMPLERATEBRIDGEPROCESSOR_JUCEHEADER__
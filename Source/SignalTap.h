@@ -0,0 +1,112 @@
+/*
+  ==============================================================================
+
+    SignalTap.h
+    Middle
+
+  ==============================================================================
+*/
+
+#ifndef __SIGNALTAP_JUCEHEADER__
+#define __SIGNALTAP_JUCEHEADER__
+
+#include <atomic>
+
+
+//==============================================================================
+/**
+    The level of each channel of a node's latest block, and a running count of
+    the midi events it has passed on, for the graph editor to show on its wires.
+
+    The audio thread measures buffers where they already are and only ever
+    stores a few atomics, so nothing is copied or locked. Readers just look at
+    the latest values, so any number of wires can share one tap; they can tell
+    whether anything has been measured since they last looked from the block
+    count.
+*/
+class SignalTap
+{
+public:
+    enum { maxChannels = 32 };
+
+    SignalTap() noexcept  : numBlocks (0), numMidiEvents (0)
+    {
+        for (int i = 0; i < maxChannels; ++i)
+        {
+            rmsLevels[i] = 0.0f;
+            numClips[i] = 0;
+        }
+    }
+
+    //==============================================================================
+    /** Measures the first numChannels channels of a block. Call from the audio thread. */
+    void measure (const AudioBuffer<float>& buffer, int numChannels) noexcept
+    {
+        measure (buffer.getArrayOfReadPointers(), jmin (numChannels, buffer.getNumChannels()), buffer.getNumSamples());
+    }
+
+    void measure (const float* const* channels, int numChannels, int numSamples) noexcept
+    {
+        numChannels = jmin (numChannels, (int) maxChannels);
+
+        if (numSamples > 0)
+        {
+            for (int ch = 0; ch < numChannels; ++ch)
+            {
+                const float* const data = channels[ch];
+
+                if (data == nullptr)
+                    continue;
+
+                float sum = 0.0f;
+
+                for (int i = 0; i < numSamples; ++i)
+                    sum += data[i] * data[i];
+
+                rmsLevels[ch] = std::sqrt (sum / numSamples);
+
+                const Range<float> range (FloatVectorOperations::findMinAndMax (data, numSamples));
+
+                if (jmax (-range.getStart(), range.getEnd()) >= 1.0f)
+                    ++numClips[ch];
+            }
+        }
+
+        ++numBlocks;
+    }
+
+    /** Adds a block's midi events to the running count. Call from the audio thread. */
+    void countMidi (const MidiBuffer& midi) noexcept
+    {
+        if (! midi.isEmpty())
+            numMidiEvents += (uint32) midi.getNumEvents();
+    }
+
+    void countMidi (uint32 numEvents) noexcept                           { numMidiEvents += numEvents; }
+
+    //==============================================================================
+    /** The RMS level of a channel's latest block. */
+    float getRmsLevel (int channel) const noexcept
+    {
+        return isPositiveAndBelow (channel, (int) maxChannels) ? rmsLevels[channel].load() : 0.0f;
+    }
+
+    /** How many blocks of a channel have reached full scale. */
+    uint32 getNumClips (int channel) const noexcept
+    {
+        return isPositiveAndBelow (channel, (int) maxChannels) ? numClips[channel].load() : 0;
+    }
+
+    uint32 getNumBlocks() const noexcept                                 { return numBlocks.load(); }
+    uint32 getNumMidiEvents() const noexcept                             { return numMidiEvents.load(); }
+
+private:
+    std::atomic<float> rmsLevels[maxChannels];
+    std::atomic<uint32> numClips[maxChannels];
+    std::atomic<uint32> numBlocks, numMidiEvents;
+
+    JUCE_DECLARE_NON_COPYABLE (SignalTap)
+};
+
+
+#endif   // __SIGNALTAP_JUCEHEADER__
@@ -0,0 +1,176 @@
+/*
+  ==============================================================================
+
+    SpatialGrid.h
+    Middle
+
+  ==============================================================================
+*/
+
+#ifndef __SPATIALGRID_JUCEHEADER__
+#define __SPATIALGRID_JUCEHEADER__
+
+
+//==============================================================================
+/**
+    Files items under each square cell of a grid that their bounds overlap, so
+    finding what's under a point, or inside an area, only has to look at the few
+    items nearby instead of all of them.
+
+    The grid is sparse and has no edges: a cell is only created when something
+    lands in it, and coordinates can be negative. An item must be removed using
+    the same bounds it was added with, so callers keep hold of those.
+*/
+template <typename ItemType>
+class SpatialGrid
+{
+public:
+    explicit SpatialGrid (int cellSizeToUse) noexcept   : cellSize (cellSizeToUse) {}
+
+    //==============================================================================
+    void add (ItemType item, const Rectangle<int>& bounds)
+    {
+        const Rectangle<int> range (getCellRange (bounds));
+
+        for (int y = range.getY(); y < range.getBottom(); ++y)
+            for (int x = range.getX(); x < range.getRight(); ++x)
+                getOrCreateCell (x, y).items.add (item);
+    }
+
+    void remove (ItemType item, const Rectangle<int>& bounds)
+    {
+        const Rectangle<int> range (getCellRange (bounds));
+
+        for (int y = range.getY(); y < range.getBottom(); ++y)
+            for (int x = range.getX(); x < range.getRight(); ++x)
+                removeFromCell (item, x, y);
+    }
+
+    void clear()
+    {
+        cellsByKey.clear();
+        cells.clear();
+    }
+
+    //==============================================================================
+    /** Returns everything filed in the cell that contains this point, or nullptr. */
+    const Array<ItemType>* getItemsNear (Point<int> position) const
+    {
+        if (const Cell* const cell = cellsByKey [getKey (getCellIndex (position.x), getCellIndex (position.y))])
+            return &cell->items;
+
+        return nullptr;
+    }
+
+    /** Calls visitor (item) for everything filed in a cell that overlaps the area.
+        An item that spans several of those cells is visited once for each of them.
+    */
+    template <typename Visitor>
+    void visitItemsIn (const Rectangle<int>& area, Visitor visitor) const
+    {
+        const Rectangle<int> range (getCellRange (area));
+
+        // For a big area it's quicker to go through the cells that actually exist.
+        if ((int64) range.getWidth() * range.getHeight() > cells.size())
+        {
+            for (int i = 0; i < cells.size(); ++i)
+            {
+                const Cell& cell = *cells.getUnchecked (i);
+
+                if (range.contains (cell.x, cell.y))
+                    for (int j = 0; j < cell.items.size(); ++j)
+                        visitor (cell.items.getUnchecked (j));
+            }
+        }
+        else
+        {
+            for (int y = range.getY(); y < range.getBottom(); ++y)
+                for (int x = range.getX(); x < range.getRight(); ++x)
+                    if (const Cell* const cell = cellsByKey [getKey (x, y)])
+                        for (int j = 0; j < cell->items.size(); ++j)
+                            visitor (cell->items.getUnchecked (j));
+        }
+    }
+
+private:
+    //==============================================================================
+    struct Cell
+    {
+        Cell (int cellX, int cellY) noexcept  : x (cellX), y (cellY) {}
+
+        const int x, y;
+        Array<ItemType> items;
+    };
+
+    /** DefaultHashFunctions only looks at the low 32 bits of an int64, which would
+        put every cell in a column in the same slot, so this mixes in both halves.
+    */
+    struct CellKeyHash
+    {
+        static int generateHash (int64 key, int upperLimit) noexcept
+        {
+            const uint32 mixed = (uint32) (key ^ (key >> 32)) * 2654435761u;
+            return (int) (mixed % (uint32) upperLimit);
+        }
+    };
+
+    const int cellSize;
+    OwnedArray<Cell> cells;
+    HashMap<int64, Cell*, CellKeyHash> cellsByKey;
+
+    static int64 getKey (int x, int y) noexcept
+    {
+        return (((int64) y) << 32) | (int64) (uint32) x;
+    }
+
+    int getCellIndex (int coordinate) const noexcept
+    {
+        // Rounds down, so that negative coordinates land in the right cell.
+        return coordinate >= 0 ? coordinate / cellSize
+                               : -((cellSize - 1 - coordinate) / cellSize);
+    }
+
+    Rectangle<int> getCellRange (const Rectangle<int>& area) const noexcept
+    {
+        const int x1 = getCellIndex (area.getX());
+        const int y1 = getCellIndex (area.getY());
+        const int x2 = getCellIndex (area.getRight() - 1) + 1;
+        const int y2 = getCellIndex (area.getBottom() - 1) + 1;
+
+        return Rectangle<int> (x1, y1, jmax (1, x2 - x1), jmax (1, y2 - y1));
+    }
+
+    Cell& getOrCreateCell (int x, int y)
+    {
+        const int64 key = getKey (x, y);
+
+        if (Cell* const cell = cellsByKey [key])
+            return *cell;
+
+        Cell* const cell = cells.add (new Cell (x, y));
+        cellsByKey.set (key, cell);
+        return *cell;
+    }
+
+    /** Empty cells are thrown away, so the grid doesn't keep growing as items move. */
+    void removeFromCell (ItemType item, int x, int y)
+    {
+        const int64 key = getKey (x, y);
+
+        if (Cell* const cell = cellsByKey [key])
+        {
+            cell->items.removeFirstMatchingValue (item);
+
+            if (cell->items.size() == 0)
+            {
+                cellsByKey.remove (key);
+                cells.removeObject (cell);
+            }
+        }
+    }
+
+    JUCE_DECLARE_NON_COPYABLE (SpatialGrid)
+};
+
+
+#endif   // __SPATIALGRID_JUCEHEADER__
@@ -0,0 +1,274 @@
+/*
+  ==============================================================================
+
+    StallMonitor.cpp
+    Middle
+
+  ==============================================================================
+*/
+
+#include "../JuceLibraryCode/JuceHeader.h"
+#include "StallMonitor.h"
+
+
+//==============================================================================
+static const int bucketLimitsMs[] = { 5, 10, 25, 50, 100, 250, 500, 1000, 5000 };
+static_assert (sizeof (bucketLimitsMs) / sizeof (bucketLimitsMs[0]) == StallMonitor::numBuckets - 1,
+               "every bucket but the last needs an upper limit");
+
+SpinLock StallMonitor::activityLock;
+StallMonitor::ScopedActivity* StallMonitor::currentActivity = nullptr;
+
+//==============================================================================
+StallMonitor::ScopedActivity::ScopedActivity (const String& d)
+    : description (d), outer (currentActivity)
+{
+    // Only the message thread's activities mean anything to the watchdog.
+    jassert (MessageManager::getInstance()->isThisTheMessageThread());
+
+    const SpinLock::ScopedLockType sl (activityLock);
+    currentActivity = this;
+}
+
+StallMonitor::ScopedActivity::~ScopedActivity()
+{
+    const SpinLock::ScopedLockType sl (activityLock);
+    currentActivity = outer;
+}
+
+//==============================================================================
+/** Posted by the watchdog; the time it's delivered is the message loop's latency. */
+class StallMonitor::Probe   : public CallbackMessage
+{
+public:
+    Probe (StallMonitor* m)  : monitor (m) {}
+
+    void messageCallback() override
+    {
+        if (StallMonitor* const m = monitor)
+            m->probeAnswered();
+    }
+
+private:
+    WeakReference<StallMonitor> monitor;
+
+    JUCE_DECLARE_NON_COPYABLE (Probe)
+};
+
+//==============================================================================
+juce_ImplementSingleton_SingleThreaded (StallMonitor)
+
+StallMonitor::StallMonitor()
+    : Thread ("Stall Monitor"), numStalls (0), answerTime (0.0)
+{
+    zeromem (histogram, sizeof (histogram));
+
+    // Sets up the weak reference's shared pointer here, so the watchdog only ever copies it.
+    const WeakReference<StallMonitor> self (this);
+
+    startThread (3);
+}
+
+StallMonitor::~StallMonitor()
+{
+    stopThread (2000);
+    masterReference.clear();
+    clearSingletonInstance();
+}
+
+//==============================================================================
+int StallMonitor::getBucketFor (const double milliseconds) noexcept
+{
+    for (int i = 0; i < numBuckets - 1; ++i)
+        if (milliseconds < bucketLimitsMs[i])
+            return i;
+
+    return numBuckets - 1;
+}
+
+String StallMonitor::getBucketName (const int bucket)
+{
+    if (bucket <= 0)
+        return "< " + String (bucketLimitsMs[0]) + " ms";
+
+    if (bucket >= numBuckets - 1)
+        return "> " + String (bucketLimitsMs[numBuckets - 2]) + " ms";
+
+    return String (bucketLimitsMs[bucket - 1]) + " - " + String (bucketLimitsMs[bucket]) + " ms";
+}
+
+Array<int> StallMonitor::getHistogram() const
+{
+    const ScopedLock sl (statsLock);
+    return Array<int> (histogram, numBuckets);
+}
+
+Array<StallMonitor::Stall> StallMonitor::getStalls() const
+{
+    const ScopedLock sl (statsLock);
+    return stalls;
+}
+
+void StallMonitor::reset()
+{
+    {
+        const ScopedLock sl (statsLock);
+        zeromem (histogram, sizeof (histogram));
+        stalls.clear();
+        numStalls = 0;
+    }
+
+    sendChangeMessage();
+}
+
+bool StallMonitor::exportReport (const File& file) const
+{
+    const Array<int> counts (getHistogram());
+    const Array<Stall> log (getStalls());
+
+    String report;
+    report << "Message thread latency, " << Time::getCurrentTime().toString (true, true) << newLine
+           << "Probes taking over " << (int) stallThresholdMs << " ms are logged as stalls" << newLine
+           << newLine
+           << "Latency histogram" << newLine;
+
+    for (int i = 0; i < counts.size(); ++i)
+        report << "  " << getBucketName (i).paddedRight (' ', 16) << counts[i] << newLine;
+
+    report << newLine
+           << "Stalls (" << log.size() << ")" << newLine;
+
+    for (int i = 0; i < log.size(); ++i)
+    {
+        const Stall& s = log.getReference (i);
+
+        report << "  " << s.time.formatted ("%Y-%m-%d %H:%M:%S")
+               << "  " << String (roundToInt (s.milliseconds)).paddedLeft (' ', 6) << " ms"
+               << "  " << s.activity << newLine;
+    }
+
+    return file.replaceWithText (report);
+}
+
+//==============================================================================
+void StallMonitor::run()
+{
+    while (! threadShouldExit())
+    {
+        const double sent = Time::getMillisecondCounterHiRes();
+        answerTime = 0.0;
+        (new Probe (this))->post();
+
+        String activity;
+        bool isStalled = false;
+
+        while (answerTime.load() == 0.0)
+        {
+            if (threadShouldExit())
+                return;
+
+            wait (10);
+
+            // While it's still stuck, whatever the message thread says it's doing is to blame.
+            if (! isStalled && Time::getMillisecondCounterHiRes() - sent > stallThresholdMs)
+            {
+                activity = describeActivity();
+                isStalled = true;
+            }
+        }
+
+        const double latency = jmax (0.0, answerTime.load() - sent);
+        isStalled = isStalled && latency > stallThresholdMs;
+
+        {
+            const ScopedLock sl (statsLock);
+            ++histogram [getBucketFor (latency)];
+
+            if (isStalled)
+            {
+                Stall s;
+                s.time = Time (Time::currentTimeMillis() - (int64) latency);
+                s.milliseconds = latency;
+                s.activity = activity;
+
+                stalls.add (s);
+
+                if (stalls.size() > maxStallsKept)
+                    stalls.remove (0);
+
+                ++numStalls;
+            }
+        }
+
+        if (isStalled)
+            sendChangeMessage();
+
+        wait (probeIntervalMs);
+    }
+}
+
+void StallMonitor::probeAnswered()
+{
+    // Note what the user's working in while the loop is still responsive, so a
+    // stall that follows a click can be blamed on where they clicked.
+    Component* c = Desktop::getInstance().getMainMouseSource().getComponentUnderMouse();
+
+    if (c == nullptr)
+        c = Component::getCurrentlyFocusedComponent();
+
+    const String context (describeComponent (c));
+
+    if (context != lastContext)
+    {
+        const SpinLock::ScopedLockType sl (activityLock);
+        lastContext = context;
+    }
+
+    answerTime = Time::getMillisecondCounterHiRes();
+}
+
+String StallMonitor::describeActivity() const
+{
+    String description;
+
+    {
+        const SpinLock::ScopedLockType sl (activityLock);
+
+        if (currentActivity != nullptr)
+            description = currentActivity->description;
+
+        if (lastContext.isNotEmpty())
+            description << (description.isEmpty() ? "" : ", ") << "last in " << lastContext;
+    }
+
+    return description.isNotEmpty() ? description : "Unknown";
+}
+
+String StallMonitor::describeComponent (Component* c)
+{
+    if (c == nullptr)
+        return String();
+
+    AudioProcessorEditor* editor = dynamic_cast<AudioProcessorEditor*> (c);
+
+    if (editor == nullptr)
+        editor = c->findParentComponentOfClass<AudioProcessorEditor>();
+
+    if (editor != nullptr)
+        return "the editor of " + editor->processor.getName();
+
+    String name;
+
+    for (Component* p = c; p != nullptr && name.isEmpty(); p = p->getParentComponent())
+        name = p->getName();
+
+    const String windowName (c->getTopLevelComponent()->getName());
+
+    if (name.isEmpty())
+        return windowName;
+
+    if (windowName.isNotEmpty() && windowName != name)
+        return name + " in " + windowName;
+
+    return name;
+}
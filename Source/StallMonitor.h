@@ -0,0 +1,121 @@
+/*
+  ==============================================================================
+
+    StallMonitor.h
+    Middle
+
+  ==============================================================================
+*/
+
+#ifndef __STALLMONITOR_JUCEHEADER__
+#define __STALLMONITOR_JUCEHEADER__
+
+#include <atomic>
+
+
+//==============================================================================
+/**
+    A watchdog that measures how long the message loop takes to get round to
+    things, so that the plugin editors and UI code that hold it up can be found.
+
+    Its thread posts a timestamped probe message every 100ms and waits for the
+    message thread to answer it. Every answer goes into a histogram of latencies,
+    and any probe that takes longer than the stall threshold is logged, along
+    with what the message thread was busy with: the innermost ScopedActivity at
+    the time, and the component or plugin editor the user was last working in.
+
+    Create it with getInstance() on the message thread; the thread starts
+    straight away. A change message is sent whenever a stall is logged.
+*/
+class StallMonitor   : public DeletedAtShutdown,
+                       public ChangeBroadcaster,
+                       private Thread
+{
+public:
+    //==============================================================================
+    /**
+        Marks what the message thread is doing for as long as it's in scope, so a
+        stall can be blamed on it. These nest, and cost a lock and a String copy,
+        so they're fine around anything that might take a while.
+    */
+    class ScopedActivity
+    {
+    public:
+        ScopedActivity (const String& description);
+        ~ScopedActivity();
+
+    private:
+        friend class StallMonitor;
+        const String description;
+        ScopedActivity* const outer;
+
+        JUCE_DECLARE_NON_COPYABLE (ScopedActivity)
+    };
+
+    //==============================================================================
+    struct Stall
+    {
+        Time time;
+        double milliseconds;
+        String activity;
+    };
+
+    enum { numBuckets = 10 };
+
+    /** The bucket that a latency falls into, and a label like "50 - 100 ms" for each. */
+    static int getBucketFor (double milliseconds) noexcept;
+    static String getBucketName (int bucket);
+
+    /** How many probes have landed in each bucket. */
+    Array<int> getHistogram() const;
+
+    /** The most recent stalls, oldest first. */
+    Array<Stall> getStalls() const;
+    int getNumStalls() const noexcept                                    { return numStalls.load(); }
+
+    /** Probes that take longer than this are logged as stalls. */
+    enum { stallThresholdMs = 100 };
+
+    void reset();
+
+    /** Writes the histogram and the stall log to a text file. */
+    bool exportReport (const File&) const;
+
+    //==============================================================================
+    juce_DeclareSingleton_SingleThreaded_Minimal (StallMonitor)
+
+private:
+    //==============================================================================
+    class Probe;
+    enum { probeIntervalMs = 100, maxStallsKept = 500 };
+
+    CriticalSection statsLock;
+    int histogram [numBuckets];
+    Array<Stall> stalls;
+
+    std::atomic<int> numStalls;
+    std::atomic<double> answerTime;
+
+    // What the user last touched, noted by each probe as it's answered.
+    String lastContext;
+
+    static SpinLock activityLock;
+    static ScopedActivity* currentActivity;
+
+    StallMonitor();
+    ~StallMonitor();
+
+    void run() override;
+    void probeAnswered();
+    String describeActivity() const;
+    static String describeComponent (Component*);
+
+    // Probes that are still queued when this is deleted find out through this.
+    WeakReference<StallMonitor>::Master masterReference;
+    friend class WeakReference<StallMonitor>;
+
+    JUCE_DECLARE_NON_COPYABLE (StallMonitor)
+};
+
+
+#endif   // __STALLMONITOR_JUCEHEADER__
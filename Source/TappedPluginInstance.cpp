@@ -0,0 +1,127 @@
+/*
+  ==============================================================================
+
+    TappedPluginInstance.cpp
+    Middle
+
+  ==============================================================================
+*/
+
+#include "../JuceLibraryCode/JuceHeader.h"
+#include "TappedPluginInstance.h"
+
+
+//==============================================================================
+TappedPluginInstance::TappedPluginInstance (AudioPluginInstance* const pluginToWrap)
+    : AudioPluginInstance (getBusesPropertiesOf (*pluginToWrap)),
+      plugin (pluginToWrap)
+{
+    // The buses start out with their default layouts, so pick up the ones in use.
+    setBusesLayout (plugin->getBusesLayout());
+    setLatencySamples (plugin->getLatencySamples());
+
+    plugin->addListener (this);
+}
+
+TappedPluginInstance::~TappedPluginInstance()
+{
+    plugin->removeListener (this);
+}
+
+AudioProcessor::BusesProperties TappedPluginInstance::getBusesPropertiesOf (const AudioProcessor& p)
+{
+    BusesProperties properties;
+
+    for (bool isInput : { true, false })
+        for (int i = 0; i < p.getBusCount (isInput); ++i)
+            if (const Bus* const bus = p.getBus (isInput, i))
+                properties.addBus (isInput, bus->getName(), bus->getDefaultLayout(), bus->isEnabled());
+
+    return properties;
+}
+
+void TappedPluginInstance::fillInPluginDescription (PluginDescription& d) const
+{
+    plugin->fillInPluginDescription (d);
+}
+
+//==============================================================================
+void TappedPluginInstance::prepareToPlay (double sampleRate, int maximumExpectedSamplesPerBlock)
+{
+    plugin->setRateAndBufferSizeDetails (sampleRate, maximumExpectedSamplesPerBlock);
+    plugin->prepareToPlay (sampleRate, maximumExpectedSamplesPerBlock);
+}
+
+void TappedPluginInstance::releaseResources()
+{
+    plugin->releaseResources();
+}
+
+void TappedPluginInstance::processBlock (AudioBuffer<float>& buffer, MidiBuffer& midiMessages)
+{
+    plugin->processBlock (buffer, midiMessages);
+
+    outputTap.measure (buffer, getTotalNumOutputChannels());
+    outputTap.countMidi (midiMessages);
+}
+
+void TappedPluginInstance::reset()
+{
+    plugin->reset();
+}
+
+void TappedPluginInstance::setNonRealtime (bool isNonRealtime) noexcept
+{
+    AudioPluginInstance::setNonRealtime (isNonRealtime);
+    plugin->setNonRealtime (isNonRealtime);
+}
+
+//==============================================================================
+bool TappedPluginInstance::isBusesLayoutSupported (const BusesLayout& layouts) const
+{
+    return plugin->checkBusesLayoutSupported (layouts);
+}
+
+bool TappedPluginInstance::canApplyBusesLayout (const BusesLayout& layouts) const
+{
+    // Our own buses only take a layout once the plugin has.
+    return plugin->setBusesLayout (layouts);
+}
+
+bool TappedPluginInstance::canApplyBusCountChange (bool isInput, bool isAddingBuses, BusProperties& outNewBusProperties)
+{
+    if (! isAddingBuses)
+        return plugin->removeBus (isInput);
+
+    if (! plugin->addBus (isInput))
+        return false;
+
+    const Bus* const bus = plugin->getBus (isInput, plugin->getBusCount (isInput) - 1);
+
+    outNewBusProperties.busName = bus->getName();
+    outNewBusProperties.defaultLayout = bus->getDefaultLayout();
+    outNewBusProperties.isActivatedByDefault = bus->isEnabled();
+    return true;
+}
+
+//==============================================================================
+void TappedPluginInstance::audioProcessorParameterChanged (AudioProcessor*, int parameterIndex, float newValue)
+{
+    sendParamChangeMessageToListeners (parameterIndex, newValue);
+}
+
+void TappedPluginInstance::audioProcessorChanged (AudioProcessor*)
+{
+    setLatencySamples (plugin->getLatencySamples());
+    updateHostDisplay();
+}
+
+void TappedPluginInstance::audioProcessorParameterChangeGestureBegin (AudioProcessor*, int parameterIndex)
+{
+    beginParameterChangeGesture (parameterIndex);
+}
+
+void TappedPluginInstance::audioProcessorParameterChangeGestureEnd (AudioProcessor*, int parameterIndex)
+{
+    endParameterChangeGesture (parameterIndex);
+}
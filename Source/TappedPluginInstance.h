@@ -0,0 +1,112 @@
+/*
+  ==============================================================================
+
+    TappedPluginInstance.h
+    Middle
+
+  ==============================================================================
+*/
+
+#ifndef __TAPPEDPLUGININSTANCE_JUCEHEADER__
+#define __TAPPEDPLUGININSTANCE_JUCEHEADER__
+
+#include "SignalTap.h"
+
+
+//==============================================================================
+/**
+    Wraps a hosted plugin so that what leaves it can be measured, just like the
+    internal processors measure themselves.
+
+    Everything is passed straight through to the plugin: its description and
+    state, so saved projects look just the same, its programs and parameters,
+    its editor, and its buses, which are kept in step with the plugin's own by
+    applying every layout and bus count change to the plugin first.
+
+    FilterGraph wraps each plugin it creates that isn't one of its own internal
+    types or I/O nodes.
+*/
+class TappedPluginInstance   : public AudioPluginInstance,
+                               private AudioProcessorListener
+{
+public:
+    /** Takes ownership of the plugin. */
+    TappedPluginInstance (AudioPluginInstance* pluginToWrap);
+    ~TappedPluginInstance();
+
+    //==============================================================================
+    AudioPluginInstance& getPlugin() const noexcept                      { return *plugin; }
+
+    /** What the plugin last sent out of each output channel and its midi output. */
+    const SignalTap& getOutputTap() const noexcept                       { return outputTap; }
+
+    //==============================================================================
+    void fillInPluginDescription (PluginDescription&) const override;
+    void* getPlatformSpecificData() override                             { return plugin->getPlatformSpecificData(); }
+
+    const String getName() const override                                { return plugin->getName(); }
+
+    void prepareToPlay (double sampleRate, int maximumExpectedSamplesPerBlock) override;
+    void releaseResources() override;
+    void processBlock (AudioBuffer<float>&, MidiBuffer&) override;
+    void reset() override;
+    void setNonRealtime (bool isNonRealtime) noexcept override;
+
+    double getTailLengthSeconds() const override                         { return plugin->getTailLengthSeconds(); }
+    bool acceptsMidi() const override                                    { return plugin->acceptsMidi(); }
+    bool producesMidi() const override                                   { return plugin->producesMidi(); }
+
+    bool hasEditor() const override                                      { return plugin->hasEditor(); }
+    AudioProcessorEditor* createEditor() override                        { return plugin->createEditorIfNeeded(); }
+
+    //==============================================================================
+    int getNumPrograms() override                                        { return plugin->getNumPrograms(); }
+    int getCurrentProgram() override                                     { return plugin->getCurrentProgram(); }
+    void setCurrentProgram (int index) override                          { plugin->setCurrentProgram (index); }
+    const String getProgramName (int index) override                     { return plugin->getProgramName (index); }
+    void changeProgramName (int index, const String& newName) override   { plugin->changeProgramName (index, newName); }
+
+    void getStateInformation (MemoryBlock& destData) override                   { plugin->getStateInformation (destData); }
+    void setStateInformation (const void* data, int sizeInBytes) override       { plugin->setStateInformation (data, sizeInBytes); }
+    void getCurrentProgramStateInformation (MemoryBlock& destData) override     { plugin->getCurrentProgramStateInformation (destData); }
+    void setCurrentProgramStateInformation (const void* data, int sizeInBytes) override
+                                                                                { plugin->setCurrentProgramStateInformation (data, sizeInBytes); }
+
+    //==============================================================================
+    int getNumParameters() override                                      { return plugin->getNumParameters(); }
+    const String getParameterName (int index) override                   { return plugin->getParameterName (index); }
+    float getParameter (int index) override                              { return plugin->getParameter (index); }
+    void setParameter (int index, float newValue) override               { plugin->setParameter (index, newValue); }
+    const String getParameterText (int index) override                   { return plugin->getParameterText (index); }
+    int getParameterNumSteps (int index) override                        { return plugin->getParameterNumSteps (index); }
+    float getParameterDefaultValue (int index) override                  { return plugin->getParameterDefaultValue (index); }
+    String getParameterLabel (int index) const override                  { return plugin->getParameterLabel (index); }
+    bool isParameterAutomatable (int index) const override               { return plugin->isParameterAutomatable (index); }
+
+    //==============================================================================
+    bool canAddBus (bool isInput) const override                         { return plugin->canAddBus (isInput); }
+    bool canRemoveBus (bool isInput) const override                      { return plugin->canRemoveBus (isInput); }
+
+protected:
+    //==============================================================================
+    bool isBusesLayoutSupported (const BusesLayout&) const override;
+    bool canApplyBusesLayout (const BusesLayout&) const override;
+    bool canApplyBusCountChange (bool isInput, bool isAddingBuses, BusProperties& outNewBusProperties) override;
+
+private:
+    //==============================================================================
+    ScopedPointer<AudioPluginInstance> plugin;
+    SignalTap outputTap;
+
+    static BusesProperties getBusesPropertiesOf (const AudioProcessor&);
+
+    void audioProcessorParameterChanged (AudioProcessor*, int parameterIndex, float newValue) override;
+    void audioProcessorChanged (AudioProcessor*) override;
+    void audioProcessorParameterChangeGestureBegin (AudioProcessor*, int parameterIndex) override;
+    void audioProcessorParameterChangeGestureEnd (AudioProcessor*, int parameterIndex) override;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (TappedPluginInstance)
+};
+
+
+#endif   // __TAPPEDPLUGININSTANCE_JUCEHEADER__